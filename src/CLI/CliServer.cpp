@@ -663,11 +663,13 @@ BaseLib::PVariable CliServer::generalCommand(std::string& command)
 			stringStream << "List of commands (shortcut in brackets):" << std::endl << std::endl;
 			stringStream << "For more information about the individual command type: COMMAND help" << std::endl
 						 << std::endl;
+			stringStream << "databasestats (dbs)  Prints statistics of the database write queue" << std::endl;
 			stringStream << "debuglevel (dl)      Changes the debug level" << std::endl;
 			stringStream << "events (ev)          Prints variable updates to the standard output" << std::endl;
 			stringStream << "lifetick (lt)        Checks the lifeticks of all components." << std::endl;
 			stringStream << "rpcservers (rpc)     Lists all active RPC servers" << std::endl;
 			stringStream << "rpcclients (rcl)     Lists all active RPC clients" << std::endl;
+			stringStream << "rpcstats (rps)       Prints statistics of the RPC servers" << std::endl;
             stringStream << "reloadroles (rrl)    Delete all roles and recreate them from \"defaultRoles.json\"." << std::endl;
 			stringStream << "threads              Prints current thread count" << std::endl;
 #ifndef NO_SCRIPTENGINE
@@ -1105,6 +1107,93 @@ BaseLib::PVariable CliServer::generalCommand(std::string& command)
 			}
 			return std::make_shared<BaseLib::Variable>(stringStream.str());
 		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "databasestats", "dbs", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command prints statistics of the database write queue, group commits, the"
+							 << std::endl;
+				stringStream << "             prepared statement cache, lock contention and the variable history. Times are in" << std::endl;
+				stringStream << "             microseconds." << std::endl;
+				stringStream << "Usage: databasestats" << std::endl << std::endl;
+				return std::make_shared<BaseLib::Variable>(stringStream.str());
+			}
+
+			auto databaseController = dynamic_cast<DatabaseController*>(GD::bl->db.get());
+			if(!databaseController) return std::make_shared<BaseLib::Variable>(std::string("Database controller is not available.\n"));
+
+			auto metrics = databaseController->getMetrics();
+			stringStream << std::left << std::setfill(' ');
+			for(auto& metric : *metrics->structValue)
+			{
+				stringStream << std::setw(30) << metric.first << metric.second->toString() << std::endl;
+			}
+			if(GD::variableHistory && GD::variableHistory->enabled())
+			{
+				metrics = GD::variableHistory->getMetrics();
+				for(auto& metric : *metrics->structValue)
+				{
+					stringStream << std::setw(30) << metric.first << metric.second->toString() << std::endl;
+				}
+			}
+			return std::make_shared<BaseLib::Variable>(stringStream.str());
+		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "rpcstats", "rps", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command prints statistics of the RPC servers, the metadata response cache and" << std::endl;
+				stringStream << "             the calls per method and client. Times are in microseconds." << std::endl;
+				stringStream << "Usage: rpcstats" << std::endl << std::endl;
+				return std::make_shared<BaseLib::Variable>(stringStream.str());
+			}
+
+			auto metrics = Rpc::RPCSystemMulticall::getMetrics();
+			stringStream << std::left << std::setfill(' ');
+			for(auto& metric : *metrics->structValue)
+			{
+				stringStream << std::setw(30) << metric.first << metric.second->toString() << std::endl;
+			}
+			metrics = GD::rpcResponseCache.getMetrics();
+			for(auto& metric : *metrics->structValue)
+			{
+				stringStream << std::setw(30) << metric.first << metric.second->toString() << std::endl;
+			}
+			metrics = GD::aclCache.getMetrics();
+			for(auto& metric : *metrics->structValue)
+			{
+				stringStream << std::setw(30) << metric.first << metric.second->toString() << std::endl;
+			}
+			metrics = Rpc::WebSocketDeflate::getMetrics();
+			for(auto& metric : *metrics->structValue)
+			{
+				stringStream << std::setw(30) << metric.first << metric.second->toString() << std::endl;
+			}
+			metrics = Rpc::RemoteRpcServer::getEventBatchingMetrics();
+			for(auto& metric : *metrics->structValue)
+			{
+				stringStream << std::setw(30) << metric.first << metric.second->toString() << std::endl;
+			}
+			metrics = GD::rpcMetrics.getMetrics();
+			if(!metrics->errorStruct)
+			{
+				stringStream << std::setw(30) << "averageRecordOverheadNs" << metrics->structValue->at("averageRecordOverheadNs")->toString() << std::endl;
+				for(auto& group : {std::string("methods"), std::string("clients")})
+				{
+					stringStream << std::endl << std::setw(40) << (group == "methods" ? "Method" : "Client") << std::setw(12) << "Calls" << std::setw(12) << "Errors" << std::setw(12) << "Throttled" << std::setw(12) << "Avg" << std::setw(12) << "Max" << std::endl;
+					for(auto& series : *metrics->structValue->at(group)->structValue)
+					{
+						stringStream << std::setw(40) << series.first;
+						for(auto& field : {std::string("calls"), std::string("errors"), std::string("throttled"), std::string("averageLatency"), std::string("maxLatency")})
+						{
+							stringStream << std::setw(12) << series.second->structValue->at(field)->integerValue64;
+						}
+						stringStream << std::endl;
+					}
+				}
+			}
+			return std::make_shared<BaseLib::Variable>(stringStream.str());
+		}
 		else if(command.compare(0, 7, "threads") == 0)
 		{
 			stringStream << GD::bl->threadManager.getCurrentThreadCount() << " of "
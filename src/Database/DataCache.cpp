@@ -0,0 +1,153 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "DataCache.h"
+
+namespace Homegear
+{
+
+DataCache::DataCache(const std::atomic<uint64_t>& committedWrites) : _committedWrites(committedWrites)
+{
+}
+
+void DataCache::setMaxSize(uint64_t maxSize)
+{
+    _maxSize = maxSize;
+    evict();
+}
+
+bool DataCache::get(const std::string& component, const std::string& key, BaseLib::PVariable& value)
+{
+    auto componentIterator = _components.find(component);
+    if(componentIterator != _components.end())
+    {
+        auto entryIterator = componentIterator->second.find(key);
+        if(entryIterator != componentIterator->second.end())
+        {
+            _lru.splice(_lru.begin(), _lru, entryIterator->second.lruIterator);
+            value = entryIterator->second.value;
+            _hits++;
+            return true;
+        }
+    }
+    _misses++;
+    return false;
+}
+
+bool DataCache::contains(const std::string& component, const std::string& key)
+{
+    auto componentIterator = _components.find(component);
+    if(componentIterator == _components.end()) return false;
+    return componentIterator->second.find(key) != componentIterator->second.end();
+}
+
+void DataCache::set(const std::string& component, const std::string& key, const BaseLib::PVariable& value, size_t size, uint64_t writeSequence)
+{
+    size += component.size() + key.size() + _entryOverhead;
+
+    auto componentIterator = _components.find(component);
+    if(componentIterator == _components.end()) componentIterator = _components.emplace(component, std::unordered_map<std::string, Entry>()).first;
+    auto entryIterator = componentIterator->second.find(key);
+    if(entryIterator == componentIterator->second.end())
+    {
+        entryIterator = componentIterator->second.emplace(key, Entry()).first;
+        //Keys of unordered_map nodes don't move, so the LRU list can point to them.
+        _lru.emplace_front(&componentIterator->first, &entryIterator->first);
+        entryIterator->second.lruIterator = _lru.begin();
+    }
+    else
+    {
+        _size -= entryIterator->second.size;
+        _lru.splice(_lru.begin(), _lru, entryIterator->second.lruIterator);
+    }
+
+    Entry& entry = entryIterator->second;
+    entry.value = value;
+    entry.size = size;
+    if(writeSequence > entry.writeSequence) entry.writeSequence = writeSequence;
+    _size += size;
+
+    evict();
+}
+
+void DataCache::erase(const std::string& component, const std::string& key)
+{
+    auto componentIterator = _components.find(component);
+    if(componentIterator == _components.end()) return;
+    auto entryIterator = componentIterator->second.find(key);
+    if(entryIterator == componentIterator->second.end()) return;
+    _size -= entryIterator->second.size;
+    _lru.erase(entryIterator->second.lruIterator);
+    componentIterator->second.erase(entryIterator);
+    if(componentIterator->second.empty()) _components.erase(componentIterator);
+}
+
+void DataCache::erase(const std::string& component)
+{
+    auto componentIterator = _components.find(component);
+    if(componentIterator == _components.end()) return;
+    for(auto& entry : componentIterator->second)
+    {
+        _size -= entry.second.size;
+        _lru.erase(entry.second.lruIterator);
+    }
+    _components.erase(componentIterator);
+}
+
+void DataCache::evict()
+{
+    if(_maxSize == 0) return;
+
+    uint64_t committedWrites = _committedWrites;
+    auto lruIterator = _lru.end();
+    size_t checkedEntries = 0;
+    size_t entryCount = _lru.size();
+    while(_size > _maxSize && lruIterator != _lru.begin() && checkedEntries < entryCount)
+    {
+        --lruIterator;
+        checkedEntries++;
+
+        auto componentIterator = _components.find(*lruIterator->first);
+        if(componentIterator == _components.end()) continue;
+        auto entryIterator = componentIterator->second.find(*lruIterator->second);
+        if(entryIterator == componentIterator->second.end()) continue;
+
+        //The value can't be read from the database yet.
+        if(entryIterator->second.writeSequence > committedWrites) continue;
+
+        _size -= entryIterator->second.size;
+        _evictions++;
+        lruIterator = _lru.erase(lruIterator);
+        componentIterator->second.erase(entryIterator);
+        if(componentIterator->second.empty()) _components.erase(componentIterator);
+    }
+}
+
+}
@@ -0,0 +1,129 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef DATACACHE_H_
+#define DATACACHE_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <atomic>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+namespace Homegear
+{
+
+/**
+ * Caches values stored in the database by component and key. When the cache grows beyond its size limit, the least
+ * recently used values are evicted. Values with writes, that are still queued or not committed yet, are not evicted, so a
+ * cache miss can always be answered from the database. The class is not thread safe.
+ */
+class DataCache
+{
+public:
+    /**
+     * @param committedWrites The number of writes executed and committed by the database queue. Used to check if the
+     * write of a value is still pending.
+     */
+    explicit DataCache(const std::atomic<uint64_t>& committedWrites);
+
+    virtual ~DataCache() = default;
+
+    /**
+     * Sets the size limit in bytes. 0 disables the limit.
+     */
+    void setMaxSize(uint64_t maxSize);
+
+    /**
+     * Looks up a value and marks it as recently used.
+     *
+     * @return true when the value is cached.
+     */
+    bool get(const std::string& component, const std::string& key, BaseLib::PVariable& value);
+
+    bool contains(const std::string& component, const std::string& key);
+
+    /**
+     * Inserts or replaces a value.
+     *
+     * @param size The size of the encoded value in bytes.
+     * @param writeSequence The sequence number of the queued write storing the value or 0 when the value is already
+     * stored in the database.
+     */
+    void set(const std::string& component, const std::string& key, const BaseLib::PVariable& value, size_t size, uint64_t writeSequence);
+
+    void erase(const std::string& component, const std::string& key);
+
+    /**
+     * Removes all values of a component.
+     */
+    void erase(const std::string& component);
+
+    // {{{ Metrics
+    uint64_t size() { return _size; }
+    uint64_t entries() { return _lru.size(); }
+    uint64_t hits() { return _hits; }
+    uint64_t misses() { return _misses; }
+    uint64_t evictions() { return _evictions; }
+    // }}}
+private:
+    struct Entry
+    {
+        BaseLib::PVariable value;
+        size_t size = 0;
+        uint64_t writeSequence = 0;
+        std::list<std::pair<const std::string*, const std::string*>>::iterator lruIterator;
+    };
+
+    /**
+     * The memory used by the containers for every entry in addition to the encoded value, component and key.
+     */
+    static const size_t _entryOverhead = 160;
+
+    const std::atomic<uint64_t>& _committedWrites;
+    uint64_t _maxSize = 0;
+    uint64_t _size = 0;
+    uint64_t _hits = 0;
+    uint64_t _misses = 0;
+    uint64_t _evictions = 0;
+    std::unordered_map<std::string, std::unordered_map<std::string, Entry>> _components;
+
+    /**
+     * Points to component and key of every entry. The most recently used entry is at the front.
+     */
+    std::list<std::pair<const std::string*, const std::string*>> _lru;
+
+    void evict();
+};
+
+}
+
+#endif
@@ -0,0 +1,568 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "../GD/GD.h"
+#include "SQLite3.h"
+
+#include <iomanip>
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <sys/stat.h>
+
+/*
+ * Standalone benchmark for the SQLite3 layer. It creates a synthetic peer database with the schema of
+ * DatabaseController and measures the operations that dominate Homegear's database load. Every phase is run
+ * "repetitions" times after one warm up run. Throughput is the median of all repetitions, latency percentiles are
+ * calculated over all operations of all repetitions.
+ *
+ * Build with "make homegear-database-benchmark" in "src".
+ */
+
+namespace Homegear
+{
+
+// {{{ SQLite3.cpp only needs these two members of GD.
+std::unique_ptr<BaseLib::SharedObjects> GD::bl;
+BaseLib::Output GD::out;
+// }}}
+
+struct BenchmarkSettings
+{
+    std::string databasePath = "/tmp/homegear-database-benchmark/";
+    int32_t peers = 2000;
+    int32_t variablesPerPeer = 40;
+    int32_t parametersPerPeer = 20;
+    int32_t systemVariables = 1000;
+    int32_t saves = 2000;
+    int32_t repetitions = 5;
+    int32_t readConnections = 2;
+    std::string synchronousMode = "normal";
+    int32_t groupCommitMaxEntries = 1000;
+    int32_t groupCommitMaxDuration = 100;
+    std::string outputFile;
+    std::string baselineFile;
+    double maxRegression = 10.0;
+};
+
+struct BenchmarkResult
+{
+    std::string name;
+    uint64_t operations = 0;
+    double operationsPerSecond = 0;
+    std::vector<int64_t> latencies;
+};
+
+/**
+ * Mirrors the group commit of DatabaseController::processQueueEntry(), so queued saves are measured the way Homegear
+ * executes them.
+ */
+class BenchmarkQueue : public BaseLib::IQueue
+{
+public:
+    class SaveEntry : public BaseLib::IQueueEntry
+    {
+    public:
+        SaveEntry(std::string command, BaseLib::Database::DataRow& data) : command(std::move(command)), data(data), enqueueTime(BaseLib::HelperFunctions::getTimeMicroseconds()) {}
+        std::string command;
+        BaseLib::Database::DataRow data;
+        int64_t enqueueTime = 0;
+    };
+
+    BenchmarkQueue(SQLite3& db, int32_t maxEntries, int32_t maxDuration) : IQueue(GD::bl.get(), 1, 100000), _db(db), _maxEntries(maxEntries), _maxDuration(maxDuration)
+    {
+        startQueue(0, true, 1, 0, SCHED_OTHER);
+    }
+
+    ~BenchmarkQueue() override
+    {
+        stopQueue(0);
+    }
+
+    void save(std::string command, BaseLib::Database::DataRow& data)
+    {
+        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<SaveEntry>(std::move(command), data);
+        enqueue(0, entry, true);
+    }
+
+    /**
+     * Waits until all queued saves are committed and returns their latencies from enqueueing to commit.
+     */
+    std::vector<int64_t> waitForCommit(uint64_t count)
+    {
+        std::unique_lock<std::mutex> committedGuard(_committedMutex);
+        _committedConditionVariable.wait(committedGuard, [&] { return _latencies.size() >= count; });
+        std::vector<int64_t> latencies;
+        latencies.swap(_latencies);
+        return latencies;
+    }
+protected:
+    void processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueueEntry>& entry) override
+    {
+        auto saveEntry = std::dynamic_pointer_cast<SaveEntry>(entry);
+        if(!saveEntry) return;
+
+        if(!_transactionOpen && queueSize(0) > 0)
+        {
+            _db.beginGroupTransaction();
+            _transactionOpen = true;
+            _transactionStartTime = BaseLib::HelperFunctions::getTime();
+        }
+
+        _db.executeGroupedWriteCommand(std::make_shared<std::pair<std::string, BaseLib::Database::DataRow>>(saveEntry->command, saveEntry->data));
+        _uncommitted.push_back(saveEntry->enqueueTime);
+
+        if(!_transactionOpen || queueSize(0) == 0 || (int32_t)_uncommitted.size() >= _maxEntries || BaseLib::HelperFunctions::getTime() - _transactionStartTime >= _maxDuration)
+        {
+            if(_transactionOpen)
+            {
+                _db.commitGroupTransaction();
+                _transactionOpen = false;
+            }
+            int64_t time = BaseLib::HelperFunctions::getTimeMicroseconds();
+            std::lock_guard<std::mutex> committedGuard(_committedMutex);
+            for(auto enqueueTime : _uncommitted)
+            {
+                _latencies.push_back(time - enqueueTime);
+            }
+            _uncommitted.clear();
+            _committedConditionVariable.notify_all();
+        }
+    }
+private:
+    SQLite3& _db;
+    int32_t _maxEntries = 1000;
+    int32_t _maxDuration = 100;
+    bool _transactionOpen = false;
+    int64_t _transactionStartTime = 0;
+    std::vector<int64_t> _uncommitted;
+    std::mutex _committedMutex;
+    std::condition_variable _committedConditionVariable;
+    std::vector<int64_t> _latencies;
+};
+
+class DatabaseBenchmark
+{
+public:
+    explicit DatabaseBenchmark(BenchmarkSettings& settings) : _settings(settings), _random(1) {}
+
+    int32_t run()
+    {
+        if(BaseLib::Io::directoryExists(_settings.databasePath)) removeDatabaseFiles();
+        else if(!BaseLib::Io::createDirectory(_settings.databasePath, S_IRWXU | S_IRWXG))
+        {
+            std::cerr << "Could not create directory " << _settings.databasePath << std::endl;
+            return 1;
+        }
+
+        _db.setSynchronousMode(_settings.synchronousMode);
+        _db.setReadConnectionCount((uint32_t)_settings.readConnections);
+        _db.setBackupPacing(100, 0);
+        _db.init(_settings.databasePath, "db.sql", true, false, true, _settings.databasePath, "db.sql.bak");
+        if(!_db.isOpen())
+        {
+            std::cerr << "Could not open database in " << _settings.databasePath << std::endl;
+            return 1;
+        }
+
+        int64_t startTime = BaseLib::HelperFunctions::getTime();
+        createDatabase();
+        std::cout << "Created database with " << _settings.peers << " peers, " << (_settings.peers * _settings.variablesPerPeer) << " peer variables, " << (_settings.peers * _settings.parametersPerPeer) << " parameters and " << _settings.systemVariables << " system variables in " << (BaseLib::HelperFunctions::getTime() - startTime) << "ms." << std::endl << std::endl;
+
+        std::vector<BenchmarkResult> results;
+        results.push_back(measure("singleSave", [&](BenchmarkResult& result) { singleSaves(result); }));
+        results.push_back(measure("queuedSave", [&](BenchmarkResult& result) { queuedSaves(result); }));
+        results.push_back(measure("peerLoad", [&](BenchmarkResult& result) { peerLoads(result); }));
+        results.push_back(measure("systemVariableScan", [&](BenchmarkResult& result) { systemVariableScans(result, false); }));
+        results.push_back(measure("systemVariableCursor", [&](BenchmarkResult& result) { systemVariableScans(result, true); }));
+        results.push_back(measure("backup", [&](BenchmarkResult& result) { backups(result); }));
+
+        printResults(results);
+        if(!_settings.outputFile.empty()) writeResults(results);
+        _db.dispose();
+        removeDatabaseFiles();
+        if(!_settings.baselineFile.empty()) return compareWithBaseline(results) ? 0 : 2;
+        return 0;
+    }
+private:
+    BenchmarkSettings& _settings;
+    SQLite3 _db;
+    std::mt19937 _random;
+    uint64_t _variableCount = 0;
+
+    /**
+     * Deletes the database, its WAL files and its backups.
+     */
+    void removeDatabaseFiles()
+    {
+        auto files = GD::bl->io.getFiles(_settings.databasePath);
+        for(auto& file : files)
+        {
+            if(file.compare(0, 6, "db.sql") == 0) GD::bl->io.deleteFile(_settings.databasePath + file);
+        }
+    }
+
+    std::vector<char> randomBlob(size_t size)
+    {
+        std::vector<char> blob(size);
+        for(auto& byte : blob)
+        {
+            byte = (char)(_random() & 0xFF);
+        }
+        return blob;
+    }
+
+    void createDatabase()
+    {
+        _db.executeCommand("CREATE TABLE IF NOT EXISTS peers (peerID INTEGER PRIMARY KEY UNIQUE, parent INTEGER NOT NULL, address INTEGER NOT NULL, serialNumber TEXT NOT NULL, type INTEGER NOT NULL)");
+        _db.executeCommand("CREATE INDEX IF NOT EXISTS peersParentIndex ON peers (parent)");
+        _db.executeCommand("CREATE TABLE IF NOT EXISTS peerVariables (variableID INTEGER PRIMARY KEY UNIQUE, peerID INTEGER NOT NULL, variableIndex INTEGER NOT NULL, integerValue INTEGER, stringValue TEXT, binaryValue BLOB)");
+        _db.executeCommand("CREATE INDEX IF NOT EXISTS peerVariablesPeerIndex ON peerVariables (peerID, variableIndex)");
+        _db.executeCommand("CREATE TABLE IF NOT EXISTS parameters (parameterID INTEGER PRIMARY KEY UNIQUE, peerID INTEGER NOT NULL, parameterSetType INTEGER NOT NULL, peerChannel INTEGER NOT NULL, remotePeer INTEGER, remoteChannel INTEGER, parameterName TEXT, value BLOB, room INTEGER, categories TEXT, roles TEXT, specialType INTEGER, metadata BLOB)");
+        _db.executeCommand("CREATE INDEX IF NOT EXISTS parametersPeerIndex ON parameters (peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName)");
+        _db.executeCommand("CREATE TABLE IF NOT EXISTS systemVariables (variableID TEXT PRIMARY KEY UNIQUE NOT NULL, serializedObject BLOB, room INTEGER, categories TEXT, flags INTEGER, roles TEXT)");
+
+        BaseLib::Database::DataRow data;
+        _db.executeWriteCommand("BEGIN", data);
+        for(int32_t peerId = 1; peerId <= _settings.peers; peerId++)
+        {
+            data.clear();
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)peerId));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)(peerId % 4) + 1));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)peerId));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>("BENCH" + std::to_string(peerId)));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)0x1000));
+            _db.executeWriteCommand("INSERT INTO peers VALUES(?, ?, ?, ?, ?)", data);
+
+            for(int32_t i = 0; i < _settings.variablesPerPeer; i++)
+            {
+                data.clear();
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>());
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)peerId));
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)i));
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)_random()));
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>(""));
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>(randomBlob(32)));
+                _db.executeWriteCommand("INSERT INTO peerVariables VALUES(?, ?, ?, ?, ?, ?)", data);
+                _variableCount++;
+            }
+
+            for(int32_t i = 0; i < _settings.parametersPerPeer; i++)
+            {
+                data.clear();
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>());
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)peerId));
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)(i % 3)));
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)(i / 3)));
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)0));
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)-1));
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>("PARAMETER" + std::to_string(i)));
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>(randomBlob(16)));
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)0));
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>(""));
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>(""));
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)0));
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>(std::vector<char>()));
+                _db.executeWriteCommand("INSERT INTO parameters VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", data);
+            }
+        }
+
+        for(int32_t i = 0; i < _settings.systemVariables; i++)
+        {
+            data.clear();
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>("systemVariable" + std::to_string(i)));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>(randomBlob(64)));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)(i % 10)));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>("1,2"));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)0));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>(""));
+            _db.executeWriteCommand("INSERT INTO systemVariables VALUES(?, ?, ?, ?, ?, ?)", data);
+        }
+        data.clear();
+        _db.executeWriteCommand("COMMIT", data);
+    }
+
+    BenchmarkResult measure(const std::string& name, const std::function<void(BenchmarkResult& result)>& phase)
+    {
+        std::cout << "Running " << name << "..." << std::endl;
+        {
+            BenchmarkResult warmUp;
+            phase(warmUp);
+        }
+
+        BenchmarkResult result;
+        result.name = name;
+        std::vector<double> operationsPerSecond;
+        operationsPerSecond.reserve(_settings.repetitions);
+        for(int32_t i = 0; i < _settings.repetitions; i++)
+        {
+            BenchmarkResult repetition;
+            int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
+            phase(repetition);
+            int64_t duration = BaseLib::HelperFunctions::getTimeMicroseconds() - startTime;
+            operationsPerSecond.push_back(duration > 0 ? (double)repetition.operations * 1000000.0 / duration : 0);
+            result.operations += repetition.operations;
+            result.latencies.insert(result.latencies.end(), repetition.latencies.begin(), repetition.latencies.end());
+        }
+        std::sort(operationsPerSecond.begin(), operationsPerSecond.end());
+        if(!operationsPerSecond.empty()) result.operationsPerSecond = operationsPerSecond.at(operationsPerSecond.size() / 2);
+        std::sort(result.latencies.begin(), result.latencies.end());
+        return result;
+    }
+
+    BaseLib::Database::DataRow randomVariableUpdate()
+    {
+        BaseLib::Database::DataRow data;
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(randomBlob(32)));
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int64_t)(_random() % _variableCount) + 1));
+        return data;
+    }
+
+    void singleSaves(BenchmarkResult& result)
+    {
+        for(int32_t i = 0; i < _settings.saves; i++)
+        {
+            auto data = randomVariableUpdate();
+            int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
+            _db.executeWriteCommand("UPDATE peerVariables SET binaryValue=? WHERE variableID=?", data);
+            result.latencies.push_back(BaseLib::HelperFunctions::getTimeMicroseconds() - startTime);
+            result.operations++;
+        }
+    }
+
+    void queuedSaves(BenchmarkResult& result)
+    {
+        BenchmarkQueue queue(_db, _settings.groupCommitMaxEntries, _settings.groupCommitMaxDuration);
+        for(int32_t i = 0; i < _settings.saves; i++)
+        {
+            auto data = randomVariableUpdate();
+            queue.save("UPDATE peerVariables SET binaryValue=? WHERE variableID=?", data);
+        }
+        result.latencies = queue.waitForCommit((uint64_t)_settings.saves);
+        result.operations = (uint64_t)_settings.saves;
+    }
+
+    void peerLoads(BenchmarkResult& result)
+    {
+        for(int32_t peerId = 1; peerId <= _settings.peers; peerId++)
+        {
+            BaseLib::Database::DataRow data({std::make_shared<BaseLib::Database::DataColumn>((int64_t)peerId)});
+            int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
+            auto variables = _db.executeCommand("SELECT * FROM peerVariables WHERE peerID=?", data);
+            auto parameters = _db.executeCommand("SELECT * FROM parameters WHERE peerID=?", data);
+            result.latencies.push_back(BaseLib::HelperFunctions::getTimeMicroseconds() - startTime);
+            if((int32_t)variables->size() != _settings.variablesPerPeer || (int32_t)parameters->size() != _settings.parametersPerPeer) std::cerr << "Wrong row count for peer " << peerId << std::endl;
+            result.operations++;
+        }
+    }
+
+    void systemVariableScans(BenchmarkResult& result, bool cursor)
+    {
+        for(int32_t i = 0; i < 20; i++)
+        {
+            int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
+            uint64_t rowCount = 0;
+            if(cursor)
+            {
+                std::vector<char> blob;
+                _db.executeQuery("SELECT variableID, serializedObject, room, categories, roles, flags FROM systemVariables", [&](SQLite3::Row& row)
+                {
+                    row.getBlob(1, blob);
+                    rowCount++;
+                    return true;
+                });
+            }
+            else rowCount = _db.executeCommand("SELECT variableID, serializedObject, room, categories, roles, flags FROM systemVariables")->size();
+            result.latencies.push_back(BaseLib::HelperFunctions::getTimeMicroseconds() - startTime);
+            if((int32_t)rowCount != _settings.systemVariables) std::cerr << "Wrong system variable count: " << rowCount << std::endl;
+            result.operations++;
+        }
+    }
+
+    void backups(BenchmarkResult& result)
+    {
+        int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
+        _db.hotBackup();
+        result.latencies.push_back(BaseLib::HelperFunctions::getTimeMicroseconds() - startTime);
+        result.operations++;
+    }
+
+    static int64_t percentile(const std::vector<int64_t>& sortedLatencies, double percent)
+    {
+        if(sortedLatencies.empty()) return 0;
+        return sortedLatencies.at((size_t)(percent / 100.0 * (sortedLatencies.size() - 1)));
+    }
+
+    void printResults(std::vector<BenchmarkResult>& results)
+    {
+        std::cout << std::endl << "Latencies are in microseconds." << std::endl;
+        std::cout << std::left << std::setw(24) << "Benchmark" << std::right << std::setw(12) << "Operations" << std::setw(14) << "Ops/s" << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(12) << "max" << std::endl;
+        for(auto& result : results)
+        {
+            std::cout << std::left << std::setw(24) << result.name << std::right << std::setw(12) << result.operations << std::setw(14) << std::fixed << std::setprecision(1) << result.operationsPerSecond
+                      << std::setw(10) << percentile(result.latencies, 50) << std::setw(10) << percentile(result.latencies, 90) << std::setw(10) << percentile(result.latencies, 99)
+                      << std::setw(12) << (result.latencies.empty() ? 0 : result.latencies.back()) << std::endl;
+        }
+    }
+
+    void writeResults(std::vector<BenchmarkResult>& results)
+    {
+        std::ofstream outputFile(_settings.outputFile, std::ios::out | std::ios::trunc);
+        if(!outputFile)
+        {
+            std::cerr << "Could not open " << _settings.outputFile << std::endl;
+            return;
+        }
+        outputFile << "benchmark,operations,operationsPerSecond,p50,p90,p99,max" << std::endl;
+        for(auto& result : results)
+        {
+            outputFile << result.name << "," << result.operations << "," << std::fixed << std::setprecision(1) << result.operationsPerSecond << "," << percentile(result.latencies, 50) << "," << percentile(result.latencies, 90) << "," << percentile(result.latencies, 99) << "," << (result.latencies.empty() ? 0 : result.latencies.back()) << std::endl;
+        }
+    }
+
+    /**
+     * Compares the throughput with a file written by "-o".
+     *
+     * @return false when one benchmark is slower than the baseline by more than "maxRegression" percent.
+     */
+    bool compareWithBaseline(std::vector<BenchmarkResult>& results)
+    {
+        std::ifstream baselineFile(_settings.baselineFile);
+        if(!baselineFile)
+        {
+            std::cerr << "Could not open " << _settings.baselineFile << std::endl;
+            return false;
+        }
+
+        std::map<std::string, double> baseline;
+        std::string line;
+        std::getline(baselineFile, line); //Header
+        while(std::getline(baselineFile, line))
+        {
+            auto fields = BaseLib::HelperFunctions::splitAll(line, ',');
+            if(fields.size() < 3) continue;
+            baseline[fields.at(0)] = BaseLib::Math::getDouble(fields.at(2));
+        }
+
+        bool success = true;
+        std::cout << std::endl;
+        for(auto& result : results)
+        {
+            auto baselineIterator = baseline.find(result.name);
+            if(baselineIterator == baseline.end() || baselineIterator->second <= 0) continue;
+            double change = (result.operationsPerSecond - baselineIterator->second) / baselineIterator->second * 100.0;
+            bool regression = change < -_settings.maxRegression;
+            if(regression) success = false;
+            std::cout << std::left << std::setw(24) << result.name << std::right << std::setw(10) << std::fixed << std::setprecision(1) << change << "%" << (regression ? "  REGRESSION" : "") << std::endl;
+        }
+        return success;
+    }
+};
+
+}
+
+using namespace Homegear;
+
+void printHelp()
+{
+    std::cout << "Usage: homegear-database-benchmark [OPTIONS]" << std::endl << std::endl;
+    std::cout << "Option              Meaning" << std::endl;
+    std::cout << "-h                  Show this help" << std::endl;
+    std::cout << "-d <path>           Directory to create the database in (default: /tmp/homegear-database-benchmark/)" << std::endl;
+    std::cout << "-p <peers>          Number of peers (default: 2000)" << std::endl;
+    std::cout << "-v <variables>      Number of variables per peer (default: 40)" << std::endl;
+    std::cout << "-s <saves>          Number of saves per repetition (default: 2000)" << std::endl;
+    std::cout << "-r <repetitions>    Number of repetitions of every benchmark (default: 5)" << std::endl;
+    std::cout << "-c <connections>    Number of read connections (default: 2)" << std::endl;
+    std::cout << "-m <mode>           SQLite synchronous mode: off, normal, full or extra (default: normal)" << std::endl;
+    std::cout << "-o <file>           Write the results as CSV to <file>" << std::endl;
+    std::cout << "-b <file>           Compare the throughput with a result file written by \"-o\"" << std::endl;
+    std::cout << "-t <percent>        Maximum allowed throughput regression compared to \"-b\" (default: 10)" << std::endl;
+    std::cout << std::endl << "The exit code is 2 when a benchmark regressed compared to \"-b\"." << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        GD::bl.reset(new BaseLib::SharedObjects());
+        GD::out.init(GD::bl.get());
+        GD::bl->debugLevel = 3; //Only output warnings.
+
+        BenchmarkSettings settings;
+        for(int32_t i = 1; i < argc; i++)
+        {
+            std::string arg(argv[i]);
+            if(arg == "-h" || arg == "--help")
+            {
+                printHelp();
+                return 0;
+            }
+            if(i + 1 >= argc)
+            {
+                printHelp();
+                return 1;
+            }
+            std::string value(argv[++i]);
+            if(arg == "-d")
+            {
+                settings.databasePath = value;
+                if(settings.databasePath.back() != '/') settings.databasePath.push_back('/');
+            }
+            else if(arg == "-p") settings.peers = BaseLib::Math::getNumber(value);
+            else if(arg == "-v") settings.variablesPerPeer = BaseLib::Math::getNumber(value);
+            else if(arg == "-s") settings.saves = BaseLib::Math::getNumber(value);
+            else if(arg == "-r") settings.repetitions = BaseLib::Math::getNumber(value);
+            else if(arg == "-c") settings.readConnections = BaseLib::Math::getNumber(value);
+            else if(arg == "-m") settings.synchronousMode = value;
+            else if(arg == "-o") settings.outputFile = value;
+            else if(arg == "-b") settings.baselineFile = value;
+            else if(arg == "-t") settings.maxRegression = BaseLib::Math::getDouble(value);
+            else
+            {
+                printHelp();
+                return 1;
+            }
+        }
+        if(settings.peers < 1 || settings.variablesPerPeer < 1 || settings.saves < 1 || settings.repetitions < 1 || settings.readConnections < 0)
+        {
+            std::cerr << "Invalid arguments." << std::endl;
+            return 1;
+        }
+
+        DatabaseBenchmark benchmark(settings);
+        return benchmark.run();
+    }
+    catch(const std::exception& ex)
+    {
+        std::cerr << "Error: " << ex.what() << std::endl;
+    }
+    return 1;
+}
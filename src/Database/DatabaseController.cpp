@@ -51,6 +51,10 @@ void DatabaseController::dispose()
     if(_disposing) return;
     _disposing = true;
     stopQueue(0);
+    {
+        std::lock_guard<std::mutex> transactionGuard(_transactionMutex);
+        commitTransaction();
+    }
     _db.dispose();
     _metadata.clear();
 }
@@ -66,12 +70,23 @@ void DatabaseController::init()
     _rpcDecoder = std::unique_ptr<BaseLib::Rpc::RpcDecoder>(new BaseLib::Rpc::RpcDecoder(GD::bl.get(), false, false));
     _rpcEncoder = std::unique_ptr<BaseLib::Rpc::RpcEncoder>(new BaseLib::Rpc::RpcEncoder(GD::bl.get(), false, true));
 
+    _settings.load(GD::configPath + "database.conf");
+    _data.setMaxSize((uint64_t)_settings.dataCacheSize() * 1024);
+    _nodeData.setMaxSize((uint64_t)_settings.nodeDataCacheSize() * 1024);
+    _userData.setMaxSize((uint64_t)_settings.userDataCacheSize() * 1024);
+
     startQueue(0, true, 1, 0, SCHED_OTHER);
 }
 
 //General
 void DatabaseController::open(std::string databasePath, std::string databaseFilename, bool databaseSynchronous, bool databaseMemoryJournal, bool databaseWALJournal, std::string backupPath, std::string backupFilename)
 {
+    _db.setSynchronousMode(_settings.synchronousMode());
+    _db.setReadConnectionCount(_settings.readConnections());
+    _db.setBackupPacing(_settings.backupPagesPerStep(), _settings.backupStepInterval());
+    std::string volatileDatabaseFilename = databaseFilename + ".volatile";
+    if(_settings.volatileDatabase()) _db.setVolatileDatabase(volatileDatabaseFilename, _settings.volatileSynchronousMode(), _settings.volatileBackups() ? volatileDatabaseFilename + ".bak" : "");
+    else if(BaseLib::Io::fileExists(databasePath + volatileDatabaseFilename)) _db.setVolatileDatabase(volatileDatabaseFilename, "", ""); //Attached, so initializeDatabase() can move the tables back.
     _db.init(databasePath, databaseFilename, databaseSynchronous, databaseMemoryJournal, databaseWALJournal, backupPath, backupFilename);
 }
 
@@ -80,22 +95,139 @@ void DatabaseController::hotBackup()
     _db.hotBackup();
 }
 
+std::string DatabaseController::qualifyCreateStatement(const std::string& statement, const std::string& schema)
+{
+    //sqlite_master stores normalized statements, so the name always directly follows these prefixes.
+    for(const std::string prefix : {"CREATE TABLE ", "CREATE INDEX ", "CREATE UNIQUE INDEX "})
+    {
+        if(statement.compare(0, prefix.size(), prefix) == 0) return prefix + schema + '.' + statement.substr(prefix.size());
+    }
+    return "";
+}
+
+std::string DatabaseController::getTableSchema(const std::string& table)
+{
+    try
+    {
+        if(!_db.hasVolatileDatabase()) return "";
+        BaseLib::Database::DataRow data;
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(table));
+        //Unqualified table names resolve to "main" first.
+        if(!_db.executeCommand("SELECT 1 FROM main.sqlite_master WHERE type='table' AND name=?", data)->empty()) return "";
+        if(!_db.executeCommand("SELECT 1 FROM volatile.sqlite_master WHERE type='table' AND name=?", data)->empty()) return "volatile.";
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return "";
+}
+
+bool DatabaseController::moveTable(const std::string& table, const std::string& sourceSchema, const std::string& targetSchema)
+{
+    try
+    {
+        BaseLib::Database::DataRow data;
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(table));
+        std::shared_ptr<BaseLib::Database::DataTable> sourceRows = _db.executeCommand("SELECT sql FROM " + sourceSchema + ".sqlite_master WHERE type='table' AND name=?", data);
+        if(sourceRows->empty() || sourceRows->at(0).empty()) return true;
+        bool targetExists = !_db.executeCommand("SELECT 1 FROM " + targetSchema + ".sqlite_master WHERE type='table' AND name=?", data)->empty();
+        if(targetExists && targetSchema == "main")
+        {
+            GD::out.printWarning("Warning: Table " + table + " exists in both database files. Deleting the unused one in schema " + sourceSchema + ".");
+            _db.executeCommand("DROP TABLE " + sourceSchema + "." + table);
+            return true;
+        }
+
+        std::string createTable = qualifyCreateStatement(sourceRows->at(0).at(0)->textValue, targetSchema);
+        if(createTable.empty())
+        {
+            GD::out.printError("Error: Could not move table " + table + ". Unexpected table definition: " + sourceRows->at(0).at(0)->textValue);
+            return false;
+        }
+        std::vector<std::string> createIndexes;
+        std::shared_ptr<BaseLib::Database::DataTable> indexRows = _db.executeCommand("SELECT sql FROM " + sourceSchema + ".sqlite_master WHERE type='index' AND tbl_name=? AND sql IS NOT NULL", data);
+        for(auto& row : *indexRows)
+        {
+            if(row.second.empty()) continue;
+            std::string createIndex = qualifyCreateStatement(row.second.at(0)->textValue, targetSchema);
+            if(!createIndex.empty()) createIndexes.push_back(createIndex);
+        }
+
+        GD::out.printInfo("Info: Moving table " + table + " from schema " + sourceSchema + " to schema " + targetSchema + "...");
+        int64_t startTime = BaseLib::HelperFunctions::getTime();
+        std::lock_guard<std::mutex> transactionGuard(_transactionMutex);
+        commitTransaction();
+        _db.executeCommand("BEGIN");
+        if(targetExists) _db.executeCommand("DROP TABLE " + targetSchema + "." + table); //Left over from an interrupted move
+        _db.executeCommand(createTable);
+        _db.executeCommand("INSERT INTO " + targetSchema + "." + table + " SELECT * FROM " + sourceSchema + "." + table);
+
+        std::shared_ptr<BaseLib::Database::DataTable> sourceCount = _db.executeCommand("SELECT COUNT(*) FROM " + sourceSchema + "." + table);
+        std::shared_ptr<BaseLib::Database::DataTable> targetCount = _db.executeCommand("SELECT COUNT(*) FROM " + targetSchema + "." + table);
+        if(sourceCount->empty() || targetCount->empty() || sourceCount->at(0).empty() || targetCount->at(0).empty() || sourceCount->at(0).at(0)->intValue != targetCount->at(0).at(0)->intValue)
+        {
+            GD::out.printError("Error: Could not move table " + table + ". Keeping it in schema " + sourceSchema + ".");
+            _db.executeCommand("ROLLBACK");
+            return false;
+        }
+
+        for(auto& createIndex : createIndexes)
+        {
+            _db.executeCommand(createIndex);
+        }
+        _db.executeCommand("DROP TABLE " + sourceSchema + "." + table);
+        _db.executeCommand("COMMIT");
+        GD::out.printInfo("Info: Moved " + std::to_string(targetCount->at(0).at(0)->intValue) + " rows of table " + table + " in " + std::to_string(BaseLib::HelperFunctions::getTime() - startTime) + "ms.");
+        return true;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return false;
+}
+
 void DatabaseController::initializeDatabase()
 {
     try
     {
+        //Move the high-churn tables before creating them, as CREATE TABLE IF NOT EXISTS only looks at the given schema.
+        std::string volatileSchema;
+        if(_db.hasVolatileDatabase())
+        {
+            bool moved = true;
+            for(auto& table : _volatileTables)
+            {
+                if(_settings.volatileDatabase()) moved = moveTable(table, "main", "volatile") && moved;
+                else moved = moveTable(table, "volatile", "main") && moved;
+            }
+            if(_settings.volatileDatabase()) volatileSchema = "volatile.";
+            else if(moved) GD::out.printInfo("Info: All tables were moved back to the main database. The file ending with \".volatile\" in the database directory can be deleted while Homegear is stopped.");
+        }
+
         _db.executeCommand("CREATE TABLE IF NOT EXISTS homegearVariables (variableID INTEGER PRIMARY KEY UNIQUE, variableIndex INTEGER NOT NULL, integerValue INTEGER, stringValue TEXT, binaryValue BLOB)");
         _db.executeCommand("CREATE INDEX IF NOT EXISTS homegearVariablesIndex ON homegearVariables (variableID, variableIndex)");
         _db.executeCommand("CREATE TABLE IF NOT EXISTS familyVariables (variableID INTEGER PRIMARY KEY UNIQUE, familyID INTEGER NOT NULL, variableIndex INTEGER NOT NULL, variableName TEXT, integerValue INTEGER, stringValue TEXT, binaryValue BLOB)");
         _db.executeCommand("CREATE INDEX IF NOT EXISTS familyVariablesIndex ON familyVariables (variableID, familyID, variableIndex, variableName)");
         _db.executeCommand("CREATE TABLE IF NOT EXISTS peers (peerID INTEGER PRIMARY KEY UNIQUE, parent INTEGER NOT NULL, address INTEGER NOT NULL, serialNumber TEXT NOT NULL, type INTEGER NOT NULL)");
         _db.executeCommand("CREATE INDEX IF NOT EXISTS peersIndex ON peers (peerID, parent, address, serialNumber, type)");
-        _db.executeCommand("CREATE TABLE IF NOT EXISTS peerVariables (variableID INTEGER PRIMARY KEY UNIQUE, peerID INTEGER NOT NULL, variableIndex INTEGER NOT NULL, integerValue INTEGER, stringValue TEXT, binaryValue BLOB)");
-        _db.executeCommand("CREATE INDEX IF NOT EXISTS peerVariablesIndex ON peerVariables (variableID, peerID, variableIndex)");
+        _db.executeCommand("CREATE INDEX IF NOT EXISTS peersParentIndex ON peers (parent)");
+        _db.executeCommand("CREATE TABLE IF NOT EXISTS " + volatileSchema + "peerVariables (variableID INTEGER PRIMARY KEY UNIQUE, peerID INTEGER NOT NULL, variableIndex INTEGER NOT NULL, integerValue INTEGER, stringValue TEXT, binaryValue BLOB)");
+        _db.executeCommand("CREATE INDEX IF NOT EXISTS " + volatileSchema + "peerVariablesPeerIndex ON peerVariables (peerID, variableIndex)");
         _db.executeCommand("CREATE TABLE IF NOT EXISTS serviceMessages (variableID INTEGER PRIMARY KEY UNIQUE, familyID INTEGER NOT NULL, peerID INTEGER NOT NULL, messageID INTEGER NOT NULL, messageSubID TEXT, timestamp INTEGER, integerValue INTEGER, message TEXT, variables BLOB, binaryData BLOB)");
         _db.executeCommand("CREATE INDEX IF NOT EXISTS serviceMessagesIndex ON serviceMessages (variableID, familyID, peerID, messageID, messageSubID, timestamp)");
+        _db.executeCommand("CREATE INDEX IF NOT EXISTS serviceMessagesPeerIndex ON serviceMessages (peerID, messageID, messageSubID)");
         _db.executeCommand("CREATE TABLE IF NOT EXISTS parameters (parameterID INTEGER PRIMARY KEY UNIQUE, peerID INTEGER NOT NULL, parameterSetType INTEGER NOT NULL, peerChannel INTEGER NOT NULL, remotePeer INTEGER, remoteChannel INTEGER, parameterName TEXT, value BLOB, room INTEGER, categories TEXT, roles TEXT, specialType INTEGER, metadata BLOB)");
-        _db.executeCommand("CREATE INDEX IF NOT EXISTS parametersIndex ON parameters (parameterID, peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, specialType)");
+        _db.executeCommand("CREATE INDEX IF NOT EXISTS parametersPeerIndex ON parameters (peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName)");
         _db.executeCommand("CREATE TABLE IF NOT EXISTS metadata (objectID TEXT, dataID TEXT, serializedObject BLOB)");
         _db.executeCommand("CREATE INDEX IF NOT EXISTS metadataIndex ON metadata (objectID, dataID)");
         _db.executeCommand("CREATE TABLE IF NOT EXISTS systemVariables (variableID TEXT PRIMARY KEY UNIQUE NOT NULL, serializedObject BLOB, room INTEGER, categories TEXT, flags INTEGER, roles TEXT)");
@@ -112,12 +244,12 @@ void DatabaseController::initializeDatabase()
         _db.executeCommand("CREATE INDEX IF NOT EXISTS userDataIndex ON userData (userID, component, key)");
         _db.executeCommand("CREATE TABLE IF NOT EXISTS groups (id INTEGER PRIMARY KEY UNIQUE, translations BLOB NOT NULL, acl BLOB NOT NULL)");
         _db.executeCommand("CREATE INDEX IF NOT EXISTS groupsIndex ON groups (id)");
-        _db.executeCommand("CREATE TABLE IF NOT EXISTS events (eventID INTEGER PRIMARY KEY UNIQUE, name TEXT NOT NULL, type INTEGER NOT NULL, peerID INTEGER, peerChannel INTEGER, variable TEXT, trigger INTEGER, triggerValue BLOB, eventMethod TEXT, eventMethodParameters BLOB, resetAfter INTEGER, initialTime INTEGER, timeOperation INTEGER, timeFactor REAL, timeLimit INTEGER, resetMethod TEXT, resetMethodParameters BLOB, eventTime INTEGER, endTime INTEGER, recurEvery INTEGER, lastValue BLOB, lastRaised INTEGER, lastReset INTEGER, currentTime INTEGER, enabled INTEGER)");
-        _db.executeCommand("CREATE INDEX IF NOT EXISTS eventsIndex ON events (eventID, name, type, peerID, peerChannel)");
+        _db.executeCommand("CREATE TABLE IF NOT EXISTS " + volatileSchema + "events (eventID INTEGER PRIMARY KEY UNIQUE, name TEXT NOT NULL, type INTEGER NOT NULL, peerID INTEGER, peerChannel INTEGER, variable TEXT, trigger INTEGER, triggerValue BLOB, eventMethod TEXT, eventMethodParameters BLOB, resetAfter INTEGER, initialTime INTEGER, timeOperation INTEGER, timeFactor REAL, timeLimit INTEGER, resetMethod TEXT, resetMethodParameters BLOB, eventTime INTEGER, endTime INTEGER, recurEvery INTEGER, lastValue BLOB, lastRaised INTEGER, lastReset INTEGER, currentTime INTEGER, enabled INTEGER)");
+        _db.executeCommand("CREATE INDEX IF NOT EXISTS " + volatileSchema + "eventsIndex ON events (eventID, name, type, peerID, peerChannel)");
         _db.executeCommand("CREATE TABLE IF NOT EXISTS nodeData (node TEXT, key TEXT, value BLOB)");
         _db.executeCommand("CREATE INDEX IF NOT EXISTS nodeDataIndex ON nodeData (node, key)");
-        _db.executeCommand("CREATE TABLE IF NOT EXISTS data (component TEXT, key TEXT, value BLOB)");
-        _db.executeCommand("CREATE INDEX IF NOT EXISTS dataIndex ON data (component, key)");
+        _db.executeCommand("CREATE TABLE IF NOT EXISTS " + volatileSchema + "data (component TEXT, key TEXT, value BLOB)");
+        _db.executeCommand("CREATE UNIQUE INDEX IF NOT EXISTS " + volatileSchema + "dataIndex ON data (component, key)");
         _db.executeCommand("CREATE TABLE IF NOT EXISTS rooms (id INTEGER PRIMARY KEY UNIQUE, translations BLOB, metadata BLOB)");
         _db.executeCommand("CREATE INDEX IF NOT EXISTS roomsIndex ON rooms (id)");
         _db.executeCommand("CREATE TABLE IF NOT EXISTS stories (id INTEGER PRIMARY KEY UNIQUE, translations BLOB, rooms TEXT, metadata BLOB)");
@@ -357,6 +489,10 @@ void DatabaseController::initializeDatabase()
 
         createDefaultRoles();
 
+        //The number of data rows is only counted once. From here on the writes of setData() and deleteData() maintain it.
+        auto dataRows = _db.executeCommand("SELECT COUNT(*) FROM data");
+        if(!dataRows->empty() && !dataRows->at(0).empty()) _dataRowCount = dataRows->at(0).at(0)->intValue;
+
         BaseLib::Database::DataRow data;
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(0)));
         auto result = _db.executeCommand("SELECT 1 FROM homegearVariables WHERE variableIndex=?", data);
@@ -366,7 +502,7 @@ void DatabaseController::initializeDatabase()
             data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn()));
             data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(0)));
             data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn()));
-            data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn("0.7.11")));
+            data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn("0.7.13")));
             data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn()));
             _db.executeCommand("INSERT INTO homegearVariables VALUES(?, ?, ?, ?, ?)", data);
 
@@ -411,11 +547,218 @@ void DatabaseController::initializeDatabase()
     }
 }
 
+void DatabaseController::commitTransaction()
+{
+    try
+    {
+        if(!_transactionOpen) return;
+        _transactionOpen = false;
+        int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
+        _db.commitGroupTransaction();
+        uint64_t latency = BaseLib::HelperFunctions::getTimeMicroseconds() - startTime;
+        _committedWrites = _processedWrites.load();
+
+        _groupCommitCount++;
+        _groupCommitEntries += _transactionEntries;
+        if(_transactionEntries > _groupCommitMaxEntries) _groupCommitMaxEntries = _transactionEntries;
+        _commitLatencySum += latency;
+        if(latency > _commitLatencyMax) _commitLatencyMax = latency;
+        if(GD::bl->debugLevel > 5) GD::out.printDebug("Debug: Committed " + std::to_string(_transactionEntries) + " queued database writes in " + std::to_string(latency) + "us.");
+        _transactionEntries = 0;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
 void DatabaseController::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueueEntry>& entry)
 {
-    std::shared_ptr<QueueEntry> queueEntry = std::dynamic_pointer_cast<QueueEntry>(entry);
-    if(!queueEntry) return;
-    _db.executeWriteCommand(queueEntry->getEntry());
+    try
+    {
+        std::shared_ptr<QueueEntry> queueEntry = std::dynamic_pointer_cast<QueueEntry>(entry);
+        if(!queueEntry) return;
+        std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>> write;
+        if(!queueEntry->getCoalescingKey().empty())
+        {
+            //From here on new writes with the same key need to be queued again.
+            std::lock_guard<std::mutex> pendingWritesGuard(_pendingWritesMutex);
+            auto pendingWriteIterator = _pendingWrites.find(queueEntry->getCoalescingKey());
+            if(pendingWriteIterator != _pendingWrites.end() && pendingWriteIterator->second == queueEntry) _pendingWrites.erase(pendingWriteIterator);
+            write = queueEntry->getEntry();
+        }
+        else write = queueEntry->getEntry();
+        std::string& command = write->first;
+        _queuedWrites++;
+
+        std::lock_guard<std::mutex> transactionGuard(_transactionMutex);
+        if(command.compare(0, 10, "SAVEPOINT ") == 0 || command.compare(0, 8, "RELEASE ") == 0)
+        {
+            //Savepoints opened outside of a transaction start their own one, so don't nest them in a group transaction.
+            commitTransaction();
+            _db.executeWriteCommand(write);
+            _processedWrites++;
+            if(command.front() == 'S') _savepointDepth++;
+            else if(_savepointDepth > 0) _savepointDepth--;
+            if(_savepointDepth == 0) _committedWrites = _processedWrites.load();
+            return;
+        }
+
+        //Synchronous writes from other threads commit the group transaction before they are executed.
+        if(_transactionOpen && !_db.groupTransactionOpen()) commitTransaction();
+
+        if(!_transactionOpen && _settings.groupCommit() && _savepointDepth == 0 && queueSize(0) > 0)
+        {
+            _db.beginGroupTransaction();
+            _transactionOpen = true;
+            _transactionStartTime = BaseLib::HelperFunctions::getTime();
+            _transactionEntries = 0;
+        }
+
+        int32_t changes = 0;
+        _db.executeGroupedWriteCommand(write, &changes);
+        if(changes > 0 && queueEntry->getRowCounter()) *queueEntry->getRowCounter() += (int64_t)changes * queueEntry->getRowCounterFactor();
+        _processedWrites++;
+        if(!_transactionOpen && _savepointDepth == 0) _committedWrites = _processedWrites.load();
+
+        if(_transactionOpen)
+        {
+            _transactionEntries++;
+            if(queueSize(0) == 0 || _transactionEntries >= (uint32_t)_settings.groupCommitMaxEntries() || BaseLib::HelperFunctions::getTime() - _transactionStartTime >= _settings.groupCommitMaxDuration())
+            {
+                commitTransaction();
+            }
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+uint64_t DatabaseController::enqueueWrite(std::shared_ptr<BaseLib::IQueueEntry>& entry)
+{
+    try
+    {
+        std::shared_ptr<QueueEntry> queueEntry = std::dynamic_pointer_cast<QueueEntry>(entry);
+        if(!queueEntry) return 0;
+
+        std::lock_guard<std::mutex> pendingWritesGuard(_pendingWritesMutex);
+        if(!queueEntry->getBarrierPrefix().empty())
+        {
+            //Writes addressing the same row under another key must not be moved past this one.
+            const std::string& barrierPrefix = queueEntry->getBarrierPrefix();
+            auto pendingWriteIterator = _pendingWrites.lower_bound(barrierPrefix);
+            while(pendingWriteIterator != _pendingWrites.end() && pendingWriteIterator->first.compare(0, barrierPrefix.size(), barrierPrefix) == 0)
+            {
+                pendingWriteIterator = _pendingWrites.erase(pendingWriteIterator);
+            }
+        }
+        if(!queueEntry->getCoalescingKey().empty())
+        {
+            auto pendingWriteIterator = _pendingWrites.find(queueEntry->getCoalescingKey());
+            if(pendingWriteIterator != _pendingWrites.end())
+            {
+                //The pending write is executed with the new data at its position in the queue.
+                pendingWriteIterator->second->setEntry(queueEntry->getEntry());
+                _coalescedWrites++;
+                return pendingWriteIterator->second->getSequence();
+            }
+        }
+        //Pending writes must not be moved past writes without a key, so writes queued after it are not merged into them.
+        else _pendingWrites.clear();
+
+        //All writes are enqueued while _pendingWritesMutex is locked, so sequence numbers match the queue order.
+        queueEntry->setSequence(_enqueuedWrites + 1);
+        if(!enqueue(0, entry)) return 0;
+        _enqueuedWrites++;
+        if(!queueEntry->getCoalescingKey().empty()) _pendingWrites.emplace(queueEntry->getCoalescingKey(), queueEntry);
+        return queueEntry->getSequence();
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return 0;
+}
+
+BaseLib::PVariable DatabaseController::getMetrics()
+{
+    try
+    {
+        auto metrics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        uint64_t commitCount = _groupCommitCount;
+        metrics->structValue->emplace("queueSize", std::make_shared<BaseLib::Variable>((int64_t)queueSize(0)));
+        metrics->structValue->emplace("queuedWrites", std::make_shared<BaseLib::Variable>((int64_t)_queuedWrites));
+        metrics->structValue->emplace("coalescedWrites", std::make_shared<BaseLib::Variable>((int64_t)_coalescedWrites));
+        metrics->structValue->emplace("groupCommit", std::make_shared<BaseLib::Variable>(_settings.groupCommit()));
+        metrics->structValue->emplace("groupCommits", std::make_shared<BaseLib::Variable>((int64_t)commitCount));
+        metrics->structValue->emplace("groupCommitMaxEntries", std::make_shared<BaseLib::Variable>((int64_t)_groupCommitMaxEntries));
+        metrics->structValue->emplace("groupCommitAverageEntries", std::make_shared<BaseLib::Variable>(commitCount > 0 ? (double)_groupCommitEntries / commitCount : 0.0));
+        metrics->structValue->emplace("groupCommitAverageLatency", std::make_shared<BaseLib::Variable>((int64_t)(commitCount > 0 ? _commitLatencySum / commitCount : 0)));
+        metrics->structValue->emplace("groupCommitMaxLatency", std::make_shared<BaseLib::Variable>((int64_t)_commitLatencyMax));
+        metrics->structValue->emplace("peerVariableReads", std::make_shared<BaseLib::Variable>((int64_t)_peerVariableReads));
+        metrics->structValue->emplace("peerVariableReadTime", std::make_shared<BaseLib::Variable>((int64_t)_peerVariableReadTime));
+        metrics->structValue->emplace("peerParameterReads", std::make_shared<BaseLib::Variable>((int64_t)_peerParameterReads));
+        metrics->structValue->emplace("peerParameterReadTime", std::make_shared<BaseLib::Variable>((int64_t)_peerParameterReadTime));
+        metrics->structValue->emplace("bulkLoadedPeers", std::make_shared<BaseLib::Variable>((int64_t)_bulkLoadedPeers));
+        metrics->structValue->emplace("bulkLoadTime", std::make_shared<BaseLib::Variable>((int64_t)_bulkLoadTime));
+        metrics->structValue->emplace("bulkLoadHits", std::make_shared<BaseLib::Variable>((int64_t)_bulkLoadHits));
+        {
+            std::lock_guard<std::mutex> dataGuard(_dataMutex);
+            metrics->structValue->emplace("dataCacheSize", std::make_shared<BaseLib::Variable>((int64_t)_data.size()));
+            metrics->structValue->emplace("dataCacheEntries", std::make_shared<BaseLib::Variable>((int64_t)_data.entries()));
+            metrics->structValue->emplace("dataCacheHits", std::make_shared<BaseLib::Variable>((int64_t)_data.hits()));
+            metrics->structValue->emplace("dataCacheMisses", std::make_shared<BaseLib::Variable>((int64_t)_data.misses()));
+            metrics->structValue->emplace("dataCacheEvictions", std::make_shared<BaseLib::Variable>((int64_t)_data.evictions()));
+        }
+        {
+            std::lock_guard<std::mutex> dataGuard(_nodeDataMutex);
+            metrics->structValue->emplace("nodeDataCacheSize", std::make_shared<BaseLib::Variable>((int64_t)_nodeData.size()));
+            metrics->structValue->emplace("nodeDataCacheEntries", std::make_shared<BaseLib::Variable>((int64_t)_nodeData.entries()));
+            metrics->structValue->emplace("nodeDataCacheHits", std::make_shared<BaseLib::Variable>((int64_t)_nodeData.hits()));
+            metrics->structValue->emplace("nodeDataCacheMisses", std::make_shared<BaseLib::Variable>((int64_t)_nodeData.misses()));
+            metrics->structValue->emplace("nodeDataCacheEvictions", std::make_shared<BaseLib::Variable>((int64_t)_nodeData.evictions()));
+        }
+        {
+            std::lock_guard<std::mutex> dataGuard(_userDataMutex);
+            metrics->structValue->emplace("userDataCacheSize", std::make_shared<BaseLib::Variable>((int64_t)_userData.size()));
+            metrics->structValue->emplace("userDataCacheEntries", std::make_shared<BaseLib::Variable>((int64_t)_userData.entries()));
+            metrics->structValue->emplace("userDataCacheHits", std::make_shared<BaseLib::Variable>((int64_t)_userData.hits()));
+            metrics->structValue->emplace("userDataCacheMisses", std::make_shared<BaseLib::Variable>((int64_t)_userData.misses()));
+            metrics->structValue->emplace("userDataCacheEvictions", std::make_shared<BaseLib::Variable>((int64_t)_userData.evictions()));
+        }
+        metrics->structValue->emplace("statementCacheHits", std::make_shared<BaseLib::Variable>((int64_t)_db.statementCacheHits()));
+        metrics->structValue->emplace("statementCacheMisses", std::make_shared<BaseLib::Variable>((int64_t)_db.statementCacheMisses()));
+        metrics->structValue->emplace("statementCacheSize", std::make_shared<BaseLib::Variable>((int64_t)_db.statementCacheSize()));
+        metrics->structValue->emplace("readPoolReads", std::make_shared<BaseLib::Variable>((int64_t)_db.readPoolReads()));
+        metrics->structValue->emplace("readPoolWaits", std::make_shared<BaseLib::Variable>((int64_t)_db.readPoolWaits()));
+        metrics->structValue->emplace("readPoolWaitTime", std::make_shared<BaseLib::Variable>((int64_t)_db.readPoolWaitTime()));
+        metrics->structValue->emplace("databaseLockWaits", std::make_shared<BaseLib::Variable>((int64_t)_db.databaseLockWaits()));
+        metrics->structValue->emplace("databaseLockWaitTime", std::make_shared<BaseLib::Variable>((int64_t)_db.databaseLockWaitTime()));
+        return metrics;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
 }
 
 bool DatabaseController::convertDatabase()
@@ -440,7 +783,7 @@ bool DatabaseController::convertDatabase()
         int64_t versionId = result->at(0).at(0)->intValue;
         std::string version = result->at(0).at(3)->textValue;
 
-        if(version == "0.7.11") return false; //Up to date
+        if(version == "0.7.13") return false; //Up to date
         /*if(version == "0.0.7")
 		{
 			GD::out.printMessage("Converting database from version " + version + " to version 0.3.0...");
@@ -532,7 +875,7 @@ bool DatabaseController::convertDatabase()
             _db.executeCommand("DELETE FROM peerVariables WHERE variableIndex=15");
 
             _db.executeCommand("CREATE TABLE IF NOT EXISTS serviceMessages (variableID INTEGER PRIMARY KEY UNIQUE, peerID INTEGER NOT NULL, variableIndex INTEGER NOT NULL, integerValue INTEGER, stringValue TEXT, binaryValue BLOB)");
-            _db.executeCommand("CREATE INDEX IF NOT EXISTS serviceMessagesIndex ON peerVariables (variableID, peerID, variableIndex)");
+            _db.executeCommand("CREATE INDEX IF NOT EXISTS " + getTableSchema("peerVariables") + "serviceMessagesIndex ON peerVariables (variableID, peerID, variableIndex)");
 
             _db.executeCommand("UPDATE peerVariables SET variableIndex=1001 WHERE variableIndex=0");
             _db.executeCommand("UPDATE peerVariables SET variableIndex=1002 WHERE variableIndex=3");
@@ -847,8 +1190,56 @@ bool DatabaseController::convertDatabase()
 
             version = "0.7.11";
         }
+        if(version == "0.7.11")
+        {
+            GD::out.printMessage("Converting database from version " + version + " to version 0.7.12...");
+
+            //The old indexes start with the primary key, so lookups by peer ID scanned the whole table.
+            int64_t startTime = BaseLib::HelperFunctions::getTime();
+            std::string peerVariablesSchema = getTableSchema("peerVariables");
+            _db.executeCommand("DROP INDEX IF EXISTS " + peerVariablesSchema + "peerVariablesIndex");
+            _db.executeCommand("CREATE INDEX IF NOT EXISTS " + peerVariablesSchema + "peerVariablesPeerIndex ON peerVariables (peerID, variableIndex)");
+            _db.executeCommand("DROP INDEX IF EXISTS parametersIndex");
+            _db.executeCommand("CREATE INDEX IF NOT EXISTS parametersPeerIndex ON parameters (peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName)");
+            _db.executeCommand("CREATE INDEX IF NOT EXISTS serviceMessagesPeerIndex ON serviceMessages (peerID, messageID, messageSubID)");
+            _db.executeCommand("CREATE INDEX IF NOT EXISTS peersParentIndex ON peers (parent)");
+            _db.executeCommand("ANALYZE");
+            GD::out.printMessage("Created peer indexes in " + std::to_string(BaseLib::HelperFunctions::getTime() - startTime) + "ms.");
+
+            data.clear();
+            data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(versionId)));
+            data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(0)));
+            data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn()));
+            //Don't forget to set new version in initializeDatabase!!!
+            data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn("0.7.12")));
+            data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn()));
+            _db.executeWriteCommand("REPLACE INTO homegearVariables VALUES(?, ?, ?, ?, ?)", data);
+
+            version = "0.7.12";
+        }
+        if(version == "0.7.12")
+        {
+            GD::out.printMessage("Converting database from version " + version + " to version 0.7.13...");
+
+            //setData() used DELETE and INSERT, so there should be no duplicates. Keep the newest row to be on the safe side.
+            _db.executeCommand("DELETE FROM data WHERE rowid NOT IN (SELECT MAX(rowid) FROM data GROUP BY component, key)");
+            std::string dataSchema = getTableSchema("data");
+            _db.executeCommand("DROP INDEX IF EXISTS " + dataSchema + "dataIndex");
+            _db.executeCommand("CREATE UNIQUE INDEX IF NOT EXISTS " + dataSchema + "dataIndex ON data (component, key)");
+
+            data.clear();
+            data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(versionId)));
+            data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(0)));
+            data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn()));
+            //Don't forget to set new version in initializeDatabase!!!
+            data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn("0.7.13")));
+            data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn()));
+            _db.executeWriteCommand("REPLACE INTO homegearVariables VALUES(?, ?, ?, ?, ?)", data);
+
+            version = "0.7.13";
+        }
 
-        if(version != "0.7.11")
+        if(version != "0.7.13")
         {
             GD::out.printCritical("Critical: Unknown database version: " + version);
             return true; //Don't know, what to do
@@ -871,14 +1262,20 @@ void DatabaseController::createSavepointSynchronous(std::string& name)
 {
     if(GD::bl->debugLevel > 5) GD::out.printDebug("Debug: Creating savepoint (synchronous) " + name);
     BaseLib::Database::DataRow data;
+    std::lock_guard<std::mutex> transactionGuard(_transactionMutex);
+    commitTransaction();
     _db.executeWriteCommand("SAVEPOINT " + name, data);
+    _savepointDepth++;
 }
 
 void DatabaseController::releaseSavepointSynchronous(std::string& name)
 {
     if(GD::bl->debugLevel > 5) GD::out.printDebug("Debug: Releasing savepoint (synchronous) " + name);
     BaseLib::Database::DataRow data;
+    std::lock_guard<std::mutex> transactionGuard(_transactionMutex);
     _db.executeWriteCommand("RELEASE " + name, data);
+    if(_savepointDepth > 0) _savepointDepth--;
+    if(_savepointDepth == 0) _committedWrites = _processedWrites.load();
 }
 
 void DatabaseController::createSavepointAsynchronous(std::string& name)
@@ -886,7 +1283,7 @@ void DatabaseController::createSavepointAsynchronous(std::string& name)
     if(GD::bl->debugLevel > 5) GD::out.printDebug("Debug: Creating savepoint (asynchronous) " + name);
     BaseLib::Database::DataRow data;
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("SAVEPOINT " + name, data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
 }
 
 void DatabaseController::releaseSavepointAsynchronous(std::string& name)
@@ -894,7 +1291,7 @@ void DatabaseController::releaseSavepointAsynchronous(std::string& name)
     if(GD::bl->debugLevel > 5) GD::out.printDebug("Debug: Releasing savepoint (asynchronous) " + name);
     BaseLib::Database::DataRow data;
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("RELEASE " + name, data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
 }
 //End general
 
@@ -924,7 +1321,7 @@ void DatabaseController::setHomegearVariableString(HomegearVariables::Enum id, s
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(value)));
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn()));
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT INTO homegearVariables VALUES(?, ?, ?, ?, ?)", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
     }
     else
     {
@@ -935,7 +1332,7 @@ void DatabaseController::setHomegearVariableString(HomegearVariables::Enum id, s
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(value)));
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn()));
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("REPLACE INTO homegearVariables VALUES(?, ?, ?, ?, ?)", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
     }
 }
 //End Homegear variables
@@ -950,16 +1347,7 @@ BaseLib::PVariable DatabaseController::getData(std::string& component, std::stri
         if(!key.empty())
         {
             std::lock_guard<std::mutex> dataGuard(_dataMutex);
-            auto componentIterator = _data.find(component);
-            if(componentIterator != _data.end())
-            {
-                auto keyIterator = componentIterator->second.find(key);
-                if(keyIterator != componentIterator->second.end())
-                {
-                    value = keyIterator->second;
-                    return value;
-                }
-            }
+            if(_data.get(component, key, value)) return value;
         }
 
         BaseLib::Database::DataRow data;
@@ -987,7 +1375,8 @@ BaseLib::PVariable DatabaseController::getData(std::string& component, std::stri
         {
             value = _rpcDecoder->decodeResponse(*rows->at(0).at(0)->binaryValue);
             std::lock_guard<std::mutex> dataGuard(_dataMutex);
-            _data[component][key] = value;
+            //Don't overwrite a value set in the meantime.
+            if(!_data.contains(component, key)) _data.set(component, key, value, rows->at(0).at(0)->binaryValue->size(), 0);
         }
 
         return value;
@@ -1015,32 +1404,31 @@ BaseLib::PVariable DatabaseController::setData(std::string& component, std::stri
         //Don't check for type here, so base64, string and future data types that use stringValue are handled
         if(value->type != BaseLib::VariableType::tBase64 && value->type != BaseLib::VariableType::tString && value->type != BaseLib::VariableType::tInteger && value->type != BaseLib::VariableType::tInteger64 && value->type != BaseLib::VariableType::tFloat && value->type != BaseLib::VariableType::tBoolean && value->type != BaseLib::VariableType::tStruct && value->type != BaseLib::VariableType::tArray) return BaseLib::Variable::createError(-32602, "Type " + BaseLib::Variable::getTypeString(value->type) + " is currently not supported.");
 
-        std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT COUNT(*) FROM data");
-        if(rows->size() == 0 || rows->at(0).size() == 0)
-        {
-            return BaseLib::Variable::createError(-32500, "Error counting data in database.");
-        }
-        if(rows->at(0).at(0)->intValue > 1000000)
-        {
-            return BaseLib::Variable::createError(-32500, "Reached limit of 1000000 data entries. Please delete data before adding new entries.");
-        }
-
-        {
-            std::lock_guard<std::mutex> dataGuard(_dataMutex);
-            _data[component][key] = value;
-        }
-
         BaseLib::Database::DataRow data;
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(component)));
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(key)));
-        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM data WHERE component=? AND key=?", data);
-        enqueue(0, entry);
 
         std::vector<char> encodedValue;
         _rpcEncoder->encodeResponse(value, encodedValue);
+
+        std::lock_guard<std::mutex> dataGuard(_dataMutex);
+        //Existing keys can still be set, when the limit is reached.
+        if(_dataRowCount >= 1000000 && !_data.contains(component, key) && _db.executeCommand("SELECT 1 FROM data WHERE component=? AND key=?", data)->empty())
+        {
+            return BaseLib::Variable::createError(-32500, "Reached limit of 1000000 data entries. Please delete data before adding new entries.");
+        }
+
+        //INSERT OR REPLACE counts as one change for both new and existing rows. INSERT OR IGNORE only changes new rows.
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(encodedValue)));
-        entry = std::make_shared<QueueEntry>("INSERT INTO data VALUES(?, ?, ?)", data);
-        enqueue(0, entry);
+        auto insertEntry = std::make_shared<QueueEntry>("INSERT OR IGNORE INTO data VALUES(?, ?, ?)", data);
+        insertEntry->setRowCounter(&_dataRowCount, 1);
+        std::shared_ptr<BaseLib::IQueueEntry> entry = insertEntry;
+        enqueueWrite(entry);
+
+        BaseLib::Database::DataRow updateData{data.at(2), data.at(0), data.at(1)};
+        entry = std::make_shared<QueueEntry>("UPDATE data SET value=? WHERE component=? AND key=?", updateData);
+        //The write is queued while _dataMutex is locked, so the cached value can't be evicted before it is written.
+        _data.set(component, key, value, encodedValue.size(), enqueueWrite(entry));
 
         return BaseLib::PVariable(new BaseLib::Variable(BaseLib::VariableType::tVoid));
     }
@@ -1059,16 +1447,6 @@ BaseLib::PVariable DatabaseController::deleteData(std::string& component, std::s
 {
     try
     {
-        {
-            std::lock_guard<std::mutex> dataGuard(_dataMutex);
-            if(key.empty()) _data.erase(component);
-            else
-            {
-                auto dataIterator = _data.find(component);
-                if(dataIterator != _data.end()) dataIterator->second.erase(key);
-            }
-        }
-
         BaseLib::Database::DataRow data;
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(component)));
         std::string command("DELETE FROM data WHERE component=?");
@@ -1077,8 +1455,18 @@ BaseLib::PVariable DatabaseController::deleteData(std::string& component, std::s
             data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(key)));
             command.append(" AND key=?");
         }
-        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(command, data);
-        enqueue(0, entry);
+
+        {
+            std::lock_guard<std::mutex> dataGuard(_dataMutex);
+            if(key.empty()) _data.erase(component);
+            else _data.erase(component, key);
+
+            //Queued while _dataMutex is locked, so a setData() can't queue its write in between.
+            auto deleteEntry = std::make_shared<QueueEntry>(command, data);
+            deleteEntry->setRowCounter(&_dataRowCount, -1);
+            std::shared_ptr<BaseLib::IQueueEntry> entry = deleteEntry;
+            enqueueWrite(entry);
+        }
 
         return BaseLib::PVariable(new BaseLib::Variable(BaseLib::VariableType::tVoid));
     }
@@ -1684,13 +2072,15 @@ BaseLib::PVariable DatabaseController::getRooms(BaseLib::PRpcClientInfo clientIn
         std::multimap<int32_t, BaseLib::PVariable> sortedRooms;
         int32_t pos = 0;
 
-        std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT id, translations, metadata FROM rooms");
-        for(auto& row : *rows)
+        std::vector<char> blob;
+        bool success = _db.executeQuery("SELECT id, translations, metadata FROM rooms", [&](SQLite3::Row& row)
         {
-            if(checkAcls && !clientInfo->acls->checkRoomReadAccess(row.second.at(0)->intValue)) continue;
+            int64_t id = row.getInteger(0);
+            if(checkAcls && !clientInfo->acls->checkRoomReadAccess(id)) return true;
             BaseLib::PVariable room = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-            room->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(row.second.at(0)->intValue));
-            BaseLib::PVariable translations = _rpcDecoder->decodeResponse(*row.second.at(1)->binaryValue);
+            room->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(id));
+            row.getBlob(1, blob);
+            BaseLib::PVariable translations = _rpcDecoder->decodeResponse(blob);
             if(languageCode.empty()) room->structValue->emplace("TRANSLATIONS", translations);
             else
             {
@@ -1703,9 +2093,10 @@ BaseLib::PVariable DatabaseController::getRooms(BaseLib::PRpcClientInfo clientIn
                     else room->structValue->emplace("NAME", std::make_shared<BaseLib::Variable>(""));
                 }
             }
-            if(!row.second.at(2)->binaryValue->empty())
+            row.getBlob(2, blob);
+            if(!blob.empty())
             {
-                BaseLib::PVariable metadata = _rpcDecoder->decodeResponse(*row.second.at(2)->binaryValue);
+                BaseLib::PVariable metadata = _rpcDecoder->decodeResponse(blob);
                 room->structValue->emplace("METADATA", metadata);
 
                 auto positionIterator = metadata->structValue->find("position");
@@ -1717,7 +2108,9 @@ BaseLib::PVariable DatabaseController::getRooms(BaseLib::PRpcClientInfo clientIn
                 room->structValue->emplace("METADATA", std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct));
                 sortedRooms.emplace(pos++, room);
             }
-        }
+            return true;
+        });
+        if(!success) return BaseLib::Variable::createError(-1, "Could not read from database.");
 
         BaseLib::PVariable rooms = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
         rooms->arrayValue->reserve(sortedRooms.size());
@@ -1880,13 +2273,15 @@ BaseLib::PVariable DatabaseController::getCategories(BaseLib::PRpcClientInfo cli
         std::multimap<int32_t, BaseLib::PVariable> sortedCategories;
         int32_t pos = 0;
 
-        std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT id, translations, metadata FROM categories");
-        for(auto& row : *rows)
+        std::vector<char> blob;
+        bool success = _db.executeQuery("SELECT id, translations, metadata FROM categories", [&](SQLite3::Row& row)
         {
-            if(checkAcls && !clientInfo->acls->checkCategoryReadAccess(row.second.at(0)->intValue)) continue;
+            int64_t id = row.getInteger(0);
+            if(checkAcls && !clientInfo->acls->checkCategoryReadAccess(id)) return true;
             BaseLib::PVariable category = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-            category->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(row.second.at(0)->intValue));
-            BaseLib::PVariable translations = _rpcDecoder->decodeResponse(*row.second.at(1)->binaryValue);
+            category->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(id));
+            row.getBlob(1, blob);
+            BaseLib::PVariable translations = _rpcDecoder->decodeResponse(blob);
             if(languageCode.empty()) category->structValue->emplace("TRANSLATIONS", translations);
             else
             {
@@ -1899,9 +2294,10 @@ BaseLib::PVariable DatabaseController::getCategories(BaseLib::PRpcClientInfo cli
                     else category->structValue->emplace("NAME", std::make_shared<BaseLib::Variable>(""));
                 }
             }
-            if(!row.second.at(2)->binaryValue->empty())
+            row.getBlob(2, blob);
+            if(!blob.empty())
             {
-                BaseLib::PVariable metadata = _rpcDecoder->decodeResponse(*row.second.at(2)->binaryValue);
+                BaseLib::PVariable metadata = _rpcDecoder->decodeResponse(blob);
                 category->structValue->emplace("METADATA", metadata);
 
                 auto positionIterator = metadata->structValue->find("position");
@@ -1913,7 +2309,9 @@ BaseLib::PVariable DatabaseController::getCategories(BaseLib::PRpcClientInfo cli
                 category->structValue->emplace("METADATA", std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct));
                 sortedCategories.emplace(pos++, category);
             }
-        }
+            return true;
+        });
+        if(!success) return BaseLib::Variable::createError(-1, "Could not read from database.");
 
         BaseLib::PVariable categories = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
         categories->arrayValue->reserve(sortedCategories.size());
@@ -2212,13 +2610,15 @@ BaseLib::PVariable DatabaseController::getRoles(BaseLib::PRpcClientInfo clientIn
         std::multimap<int32_t, BaseLib::PVariable> sortedRoles;
         int32_t pos = 0;
 
-        std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT id, translations, metadata FROM roles");
-        for(auto& row : *rows)
+        std::vector<char> blob;
+        bool success = _db.executeQuery("SELECT id, translations, metadata FROM roles", [&](SQLite3::Row& row)
         {
-            if(checkAcls && !clientInfo->acls->checkRoleReadAccess(row.second.at(0)->intValue)) continue;
+            int64_t id = row.getInteger(0);
+            if(checkAcls && !clientInfo->acls->checkRoleReadAccess(id)) return true;
             BaseLib::PVariable role = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-            role->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(row.second.at(0)->intValue));
-            BaseLib::PVariable translations = _rpcDecoder->decodeResponse(*row.second.at(1)->binaryValue);
+            role->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(id));
+            row.getBlob(1, blob);
+            BaseLib::PVariable translations = _rpcDecoder->decodeResponse(blob);
             if(languageCode.empty()) role->structValue->emplace("TRANSLATIONS", translations);
             else
             {
@@ -2231,9 +2631,10 @@ BaseLib::PVariable DatabaseController::getRoles(BaseLib::PRpcClientInfo clientIn
                     else role->structValue->emplace("NAME", std::make_shared<BaseLib::Variable>(""));
                 }
             }
-            if(!row.second.at(2)->binaryValue->empty())
+            row.getBlob(2, blob);
+            if(!blob.empty())
             {
-                BaseLib::PVariable metadata = _rpcDecoder->decodeResponse(*row.second.at(2)->binaryValue);
+                BaseLib::PVariable metadata = _rpcDecoder->decodeResponse(blob);
                 role->structValue->emplace("METADATA", metadata);
 
                 auto positionIterator = metadata->structValue->find("position");
@@ -2245,7 +2646,9 @@ BaseLib::PVariable DatabaseController::getRoles(BaseLib::PRpcClientInfo clientIn
                 role->structValue->emplace("METADATA", std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct));
                 sortedRoles.emplace(pos++, role);
             }
-        }
+            return true;
+        });
+        if(!success) return BaseLib::Variable::createError(-1, "Could not read from database.");
 
         BaseLib::PVariable roles = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
         roles->arrayValue->reserve(sortedRoles.size());
@@ -2376,12 +2779,11 @@ std::set<std::string> DatabaseController::getAllNodeDataNodes()
     try
     {
         std::set<std::string> nodeIds;
-        std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT node FROM nodeData");
-
-        for(auto& row : *rows)
+        _db.executeQuery("SELECT node FROM nodeData", [&](SQLite3::Row& row)
         {
-            nodeIds.emplace(row.second.at(0)->textValue);
-        }
+            nodeIds.emplace(row.getText(0));
+            return true;
+        });
 
         return nodeIds;
     }
@@ -2412,16 +2814,10 @@ BaseLib::PVariable DatabaseController::getNodeData(std::string& node, std::strin
         if(!key.empty())
         {
             std::lock_guard<std::mutex> dataGuard(_nodeDataMutex);
-            auto componentIterator = _nodeData.find(node);
-            if(componentIterator != _nodeData.end())
+            if(_nodeData.get(node, key, value))
             {
-                auto keyIterator = componentIterator->second.find(key);
-                if(keyIterator != componentIterator->second.end())
-                {
-                    value = keyIterator->second;
-                    if(obfuscate) value = value->stringValue.empty() ? std::make_shared<BaseLib::Variable>(std::string()) : std::make_shared<BaseLib::Variable>(std::string("*"));
-                    return value;
-                }
+                if(obfuscate) value = value->stringValue.empty() ? std::make_shared<BaseLib::Variable>(std::string()) : std::make_shared<BaseLib::Variable>(std::string("*"));
+                return value;
             }
         }
 
@@ -2460,7 +2856,8 @@ BaseLib::PVariable DatabaseController::getNodeData(std::string& node, std::strin
         {
             value = _rpcDecoder->decodeResponse(*rows->at(0).at(0)->binaryValue);
             std::lock_guard<std::mutex> dataGuard(_nodeDataMutex);
-            _nodeData[node][key] = value;
+            //Don't overwrite a value set in the meantime.
+            if(!_nodeData.contains(node, key)) _nodeData.set(node, key, value, rows->at(0).at(0)->binaryValue->size(), 0);
         }
 
         if(obfuscate) value = value->stringValue.empty() ? std::make_shared<BaseLib::Variable>(std::string()) : std::make_shared<BaseLib::Variable>(std::string("*"));
@@ -2499,22 +2896,23 @@ BaseLib::PVariable DatabaseController::setNodeData(std::string& node, std::strin
             return BaseLib::Variable::createError(-32500, "Reached limit of 1000000 data entries. Please delete data before adding new entries.");
         }
 
-        {
-            std::lock_guard<std::mutex> dataGuard(_nodeDataMutex);
-            _nodeData[node][key] = value;
-        }
+        std::vector<char> encodedValue;
+        _rpcEncoder->encodeResponse(value, encodedValue);
 
         BaseLib::Database::DataRow data;
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(node)));
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(key)));
-        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM nodeData WHERE node=? AND key=?", data);
-        enqueue(0, entry);
 
-        std::vector<char> encodedValue;
-        _rpcEncoder->encodeResponse(value, encodedValue);
-        data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(encodedValue)));
-        entry = std::make_shared<QueueEntry>("INSERT INTO nodeData VALUES(?, ?, ?)", data);
-        enqueue(0, entry);
+        {
+            //The writes are queued while _nodeDataMutex is locked, so the cached value can't be evicted before it is written.
+            std::lock_guard<std::mutex> dataGuard(_nodeDataMutex);
+            std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM nodeData WHERE node=? AND key=?", data);
+            enqueueWrite(entry);
+
+            data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(encodedValue)));
+            entry = std::make_shared<QueueEntry>("INSERT INTO nodeData VALUES(?, ?, ?)", data);
+            _nodeData.set(node, key, value, encodedValue.size(), enqueueWrite(entry));
+        }
 
         return BaseLib::PVariable(new BaseLib::Variable(BaseLib::VariableType::tVoid));
     }
@@ -2536,11 +2934,7 @@ BaseLib::PVariable DatabaseController::deleteNodeData(std::string& node, std::st
         {
             std::lock_guard<std::mutex> dataGuard(_nodeDataMutex);
             if(key.empty()) _nodeData.erase(node);
-            else
-            {
-                auto dataIterator = _nodeData.find(node);
-                if(dataIterator != _nodeData.end()) dataIterator->second.erase(key);
-            }
+            else _nodeData.erase(node, key);
         }
 
         BaseLib::Database::DataRow data;
@@ -2552,7 +2946,7 @@ BaseLib::PVariable DatabaseController::deleteNodeData(std::string& node, std::st
             command.append(" AND key=?");
         }
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(command, data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
 
         return BaseLib::PVariable(new BaseLib::Variable(BaseLib::VariableType::tVoid));
     }
@@ -2674,14 +3068,14 @@ BaseLib::PVariable DatabaseController::setMetadata(BaseLib::PRpcClientInfo clien
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(std::to_string(peerID))));
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(dataID)));
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM metadata WHERE objectID=? AND dataID=?", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
 
         std::vector<char> value;
         _rpcEncoder->encodeResponse(metadata, value);
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(value)));
 
         entry = std::make_shared<QueueEntry>("INSERT INTO metadata VALUES(?, ?, ?)", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
 
 #ifdef EVENTHANDLER
         GD::eventHandler->trigger(peerID, -1, dataID, metadata);
@@ -2736,7 +3130,7 @@ BaseLib::PVariable DatabaseController::deleteMetadata(uint64_t peerID, std::stri
             command.append(" AND dataID=?");
         }
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(command, data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
 
         std::shared_ptr<std::vector<std::string>> valueKeys(new std::vector<std::string>{dataID});
         std::shared_ptr<std::vector<BaseLib::PVariable>> values(new std::vector<BaseLib::PVariable>());
@@ -2780,7 +3174,7 @@ void DatabaseController::deleteSystemVariable(std::string& variableId)
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(variableId)));
         std::string command("DELETE FROM systemVariables WHERE variableID=?");
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(command, data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
     }
     catch(const std::exception& ex)
     {
@@ -2944,8 +3338,8 @@ BaseLib::PVariable DatabaseController::setSystemVariable(std::string& variableId
         data.push_back(std::make_shared<BaseLib::Database::DataColumn>(roles));
         data.push_back(std::make_shared<BaseLib::Database::DataColumn>(flags));
 
-        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO systemVariables(variableID, serializedObject, room, categories, roles, flags) VALUES(?, ?, ?, ?, ?, ?)", data);
-        enqueue(0, entry);
+        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO systemVariables(variableID, serializedObject, room, categories, roles, flags) VALUES(?, ?, ?, ?, ?, ?)", data, "systemVariable" + variableId);
+        enqueueWrite(entry);
 
         return std::make_shared<BaseLib::Variable>();
     }
@@ -3407,13 +3801,9 @@ BaseLib::PVariable DatabaseController::deleteUserData(uint64_t userId, const std
         if(_db.executeCommand("SELECT userID FROM users WHERE userID=?", data)->empty()) return BaseLib::Variable::createError(-1, "Unknown user.");
 
         {
-            std::lock_guard<std::mutex> dataGuard(_dataMutex);
-            if(key.empty()) _data.erase(component);
-            else
-            {
-                auto dataIterator = _data.find(component);
-                if(dataIterator != _data.end()) dataIterator->second.erase(key);
-            }
+            std::lock_guard<std::mutex> userDataGuard(_userDataMutex);
+            if(key.empty()) _userData.erase(std::to_string(userId) + '/' + component);
+            else _userData.erase(std::to_string(userId) + '/' + component, key);
         }
 
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(component)));
@@ -3424,7 +3814,7 @@ BaseLib::PVariable DatabaseController::deleteUserData(uint64_t userId, const std
             command.append(" AND key=?");
         }
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(command, data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
 
         return BaseLib::PVariable(new BaseLib::Variable(BaseLib::VariableType::tVoid));
     }
@@ -3449,19 +3839,11 @@ BaseLib::PVariable DatabaseController::getUserData(uint64_t userId, const std::s
 
         BaseLib::PVariable value;
 
+        std::string cacheComponent = std::to_string(userId) + '/' + component;
         if(!key.empty())
         {
-            std::lock_guard<std::mutex> dataGuard(_dataMutex);
-            auto componentIterator = _data.find(component);
-            if(componentIterator != _data.end())
-            {
-                auto keyIterator = componentIterator->second.find(key);
-                if(keyIterator != componentIterator->second.end())
-                {
-                    value = keyIterator->second;
-                    return value;
-                }
-            }
+            std::lock_guard<std::mutex> userDataGuard(_userDataMutex);
+            if(_userData.get(cacheComponent, key, value)) return value;
         }
 
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(component)));
@@ -3487,8 +3869,9 @@ BaseLib::PVariable DatabaseController::getUserData(uint64_t userId, const std::s
         else
         {
             value = _rpcDecoder->decodeResponse(*rows->at(0).at(0)->binaryValue);
-            std::lock_guard<std::mutex> dataGuard(_dataMutex);
-            _data[component][key] = value;
+            std::lock_guard<std::mutex> userDataGuard(_userDataMutex);
+            //Don't overwrite a value set in the meantime.
+            if(!_userData.contains(cacheComponent, key)) _userData.set(cacheComponent, key, value, rows->at(0).at(0)->binaryValue->size(), 0);
         }
 
         return value;
@@ -3530,21 +3913,22 @@ BaseLib::PVariable DatabaseController::setUserData(uint64_t userId, const std::s
             return BaseLib::Variable::createError(-32500, "Reached limit of 1000000 data entries. Please delete data before adding new entries.");
         }
 
-        {
-            std::lock_guard<std::mutex> dataGuard(_dataMutex);
-            _data[component][key] = value;
-        }
+        std::vector<char> encodedValue;
+        _rpcEncoder->encodeResponse(value, encodedValue);
 
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(component)));
         data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(key)));
-        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM userData WHERE userID=? AND component=? AND key=?", data);
-        enqueue(0, entry);
 
-        std::vector<char> encodedValue;
-        _rpcEncoder->encodeResponse(value, encodedValue);
-        data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(encodedValue)));
-        entry = std::make_shared<QueueEntry>("INSERT INTO userData VALUES(?, ?, ?, ?)", data);
-        enqueue(0, entry);
+        {
+            //The writes are queued while _userDataMutex is locked, so the cached value can't be evicted before it is written.
+            std::lock_guard<std::mutex> userDataGuard(_userDataMutex);
+            std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM userData WHERE userID=? AND component=? AND key=?", data);
+            enqueueWrite(entry);
+
+            data.push_back(std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(encodedValue)));
+            entry = std::make_shared<QueueEntry>("INSERT INTO userData VALUES(?, ?, ?, ?)", data);
+            _userData.set(std::to_string(userId) + '/' + component, key, value, encodedValue.size(), enqueueWrite(entry));
+        }
 
         return BaseLib::PVariable(new BaseLib::Variable(BaseLib::VariableType::tVoid));
     }
@@ -3709,15 +4093,15 @@ BaseLib::PVariable DatabaseController::getGroups(std::string languageCode)
     {
         BaseLib::PVariable groups = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
 
-        std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT id, translations, acl FROM groups");
-        groups->arrayValue->reserve(rows->size());
-        for(auto row : *rows)
+        std::vector<char> blob;
+        bool success = _db.executeQuery("SELECT id, translations, acl FROM groups", [&](SQLite3::Row& row)
         {
             BaseLib::PVariable group = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
 
-            group->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(row.second.at(0)->intValue));
+            group->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(row.getInteger(0)));
 
-            BaseLib::PVariable translations = _rpcDecoder->decodeResponse(*row.second.at(1)->binaryValue);
+            row.getBlob(1, blob);
+            BaseLib::PVariable translations = _rpcDecoder->decodeResponse(blob);
             if(languageCode.empty()) group->structValue->emplace("TRANSLATIONS", translations);
             else
             {
@@ -3731,11 +4115,14 @@ BaseLib::PVariable DatabaseController::getGroups(std::string languageCode)
                 }
             }
 
-            BaseLib::PVariable acl = _rpcDecoder->decodeResponse(*row.second.at(2)->binaryValue);
+            row.getBlob(2, blob);
+            BaseLib::PVariable acl = _rpcDecoder->decodeResponse(blob);
             group->structValue->emplace("ACL", acl);
 
             groups->arrayValue->push_back(group);
-        }
+            return true;
+        });
+        if(!success) return BaseLib::Variable::createError(-1, "Could not read from database.");
 
         return groups;
     }
@@ -3800,6 +4187,7 @@ BaseLib::PVariable DatabaseController::updateGroup(uint64_t groupId, BaseLib::PV
             _db.executeCommand("UPDATE groups SET translations=?, acl=? WHERE id=?", data);
         }
         else _db.executeCommand("UPDATE groups SET acl=? WHERE id=?", data);
+        GD::rpcResponseCache.invalidate();
 
         return std::make_shared<BaseLib::Variable>();
     }
@@ -3840,12 +4228,12 @@ void DatabaseController::saveEventAsynchronous(BaseLib::Database::DataRow& event
     {
         event.push_front(event.at(0));
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO events (eventID, name, type, peerID, peerChannel, variable, trigger, triggerValue, eventMethod, eventMethodParameters, resetAfter, initialTime, timeOperation, timeFactor, timeLimit, resetMethod, resetMethodParameters, eventTime, endTime, recurEvery, lastValue, lastRaised, lastReset, currentTime, enabled) VALUES((SELECT eventID FROM events WHERE name=?), ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", event);
-        enqueue(0, entry);
+        enqueueWrite(entry);
     }
     else if(event.size() == 25 && event.at(0)->intValue != 0)
     {
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("REPLACE INTO events VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", event);
-        enqueue(0, entry);
+        enqueueWrite(entry);
     }
     else GD::out.printError("Error: Either eventID is 0 or the number of columns is invalid.");
 }
@@ -3856,7 +4244,7 @@ void DatabaseController::deleteEvent(std::string& name)
     {
         BaseLib::Database::DataRow data({std::shared_ptr<BaseLib::Database::DataColumn>(new BaseLib::Database::DataColumn(name))});
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM events WHERE name=?", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
     }
     catch(const std::exception& ex)
     {
@@ -3875,7 +4263,7 @@ void DatabaseController::deleteFamily(int32_t familyId)
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(familyId));
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM familyVariables WHERE familyID=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
 }
 
 void DatabaseController::saveFamilyVariableAsynchronous(int32_t familyId, BaseLib::Database::DataRow& data)
@@ -3894,19 +4282,19 @@ void DatabaseController::saveFamilyVariableAsynchronous(int32_t familyId, BaseLi
                 case BaseLib::Database::DataColumn::DataType::INTEGER:
                 {
                     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE familyVariables SET integerValue=? WHERE variableID=?", data);
-                    enqueue(0, entry);
+                    enqueueWrite(entry);
                 }
                     break;
                 case BaseLib::Database::DataColumn::DataType::TEXT:
                 {
                     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE familyVariables SET stringValue=? WHERE variableID=?", data);
-                    enqueue(0, entry);
+                    enqueueWrite(entry);
                 }
                     break;
                 case BaseLib::Database::DataColumn::DataType::BLOB:
                 {
                     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE familyVariables SET binaryValue=? WHERE variableID=?", data);
-                    enqueue(0, entry);
+                    enqueueWrite(entry);
                 }
                     break;
                 case BaseLib::Database::DataColumn::DataType::NODATA:
@@ -3922,12 +4310,12 @@ void DatabaseController::saveFamilyVariableAsynchronous(int32_t familyId, BaseLi
             if(data.size() == 9)
             {
                 std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO familyVariables (variableID, familyID, variableIndex, variableName, integerValue, stringValue, binaryValue) VALUES((SELECT variableID FROM familyVariables WHERE familyID=? AND variableIndex=? AND variableName=?), ?, ?, ?, ?, ?, ?)", data);
-                enqueue(0, entry);
+                enqueueWrite(entry);
             }
             else if(data.size() == 7 && data.at(0)->intValue != 0)
             {
                 std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("REPLACE INTO familyVariables VALUES(?, ?, ?, ?, ?, ?, ?)", data);
-                enqueue(0, entry);
+                enqueueWrite(entry);
             }
             else GD::out.printError("Error: Either variableID is 0 or the number of columns is invalid.");
         }
@@ -3974,22 +4362,22 @@ void DatabaseController::deleteFamilyVariable(BaseLib::Database::DataRow& data)
                 return;
             }
             std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM familyVariables WHERE variableID=?", data);
-            enqueue(0, entry);
+            enqueueWrite(entry);
         }
         else if(data.size() == 2 && data.at(1)->dataType == BaseLib::Database::DataColumn::DataType::Enum::INTEGER)
         {
             std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM familyVariables WHERE familyID=? AND variableIndex=?", data);
-            enqueue(0, entry);
+            enqueueWrite(entry);
         }
         else if(data.size() == 2 && data.at(1)->dataType == BaseLib::Database::DataColumn::DataType::Enum::TEXT)
         {
             std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM familyVariables WHERE familyID=? AND variableName=?", data);
-            enqueue(0, entry);
+            enqueueWrite(entry);
         }
         else if(data.size() == 3)
         {
             std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM familyVariables WHERE familyID=? AND variableIndex=? AND variableName=?", data);
-            enqueue(0, entry);
+            enqueueWrite(entry);
         }
     }
     catch(const std::exception& ex)
@@ -4031,9 +4419,9 @@ void DatabaseController::deleteDevice(uint64_t id)
         BaseLib::Database::DataRow data;
         data.push_back(std::make_shared<BaseLib::Database::DataColumn>(id));
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM devices WHERE deviceID=?", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
         entry = std::make_shared<QueueEntry>("DELETE FROM deviceVariables WHERE deviceID=?", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
     }
     catch(const std::exception& ex)
     {
@@ -4086,19 +4474,19 @@ void DatabaseController::saveDeviceVariableAsynchronous(BaseLib::Database::DataR
                 case BaseLib::Database::DataColumn::DataType::INTEGER:
                 {
                     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE deviceVariables SET integerValue=? WHERE variableID=?", data);
-                    enqueue(0, entry);
+                    enqueueWrite(entry);
                 }
                     break;
                 case BaseLib::Database::DataColumn::DataType::TEXT:
                 {
                     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE deviceVariables SET stringValue=? WHERE variableID=?", data);
-                    enqueue(0, entry);
+                    enqueueWrite(entry);
                 }
                     break;
                 case BaseLib::Database::DataColumn::DataType::BLOB:
                 {
                     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE deviceVariables SET binaryValue=? WHERE variableID=?", data);
-                    enqueue(0, entry);
+                    enqueueWrite(entry);
                 }
                     break;
                 case BaseLib::Database::DataColumn::DataType::NODATA:
@@ -4113,13 +4501,15 @@ void DatabaseController::saveDeviceVariableAsynchronous(BaseLib::Database::DataR
         {
             if(data.size() == 5)
             {
-                std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO deviceVariables (variableID, deviceID, variableIndex, integerValue, stringValue, binaryValue) VALUES((SELECT variableID FROM deviceVariables WHERE deviceID=" + std::to_string(data.at(0)->intValue) + " AND variableIndex=" + std::to_string(data.at(1)->intValue) + "), ?, ?, ?, ?, ?)", data);
-                enqueue(0, entry);
+                BaseLib::Database::DataRow insertData{data.at(0), data.at(1)};
+                insertData.insert(insertData.end(), data.begin(), data.end());
+                std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO deviceVariables (variableID, deviceID, variableIndex, integerValue, stringValue, binaryValue) VALUES((SELECT variableID FROM deviceVariables WHERE deviceID=? AND variableIndex=?), ?, ?, ?, ?, ?)", insertData);
+                enqueueWrite(entry);
             }
             else if(data.size() == 6 && data.at(0)->intValue != 0)
             {
                 std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("REPLACE INTO deviceVariables VALUES(?, ?, ?, ?, ?, ?)", data);
-                enqueue(0, entry);
+                enqueueWrite(entry);
             }
             else GD::out.printError("Error: Either variableID is 0 or the number of columns is invalid.");
         }
@@ -4141,7 +4531,7 @@ void DatabaseController::deletePeers(int32_t deviceID)
         BaseLib::Database::DataRow data;
         data.push_back(std::make_shared<BaseLib::Database::DataColumn>(deviceID));
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM peers WHERE parent=?", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
     }
     catch(const std::exception& ex)
     {
@@ -4199,15 +4589,16 @@ void DatabaseController::deletePeer(uint64_t id)
 {
     try
     {
+        invalidateBulkLoadedPeerData(id);
         BaseLib::Database::DataRow data({std::make_shared<BaseLib::Database::DataColumn>(id)});
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM parameters WHERE peerID=?", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
         entry = std::make_shared<QueueEntry>("DELETE FROM peerVariables WHERE peerID=?", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
         entry = std::make_shared<QueueEntry>("DELETE FROM peers WHERE peerID=?", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
         entry = std::make_shared<QueueEntry>("DELETE FROM serviceMessages WHERE peerID=?", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
     }
     catch(const std::exception& ex)
     {
@@ -4237,6 +4628,11 @@ void DatabaseController::savePeerParameterAsynchronous(BaseLib::Database::DataRo
 {
     try
     {
+        //Bulk loaded rows of the peer would be outdated after this write.
+        if(data.size() == 2) invalidateBulkLoadedPeerParameter(data.at(1)->intValue);
+        else if(data.size() == 8) invalidateBulkLoadedPeerData(data.at(1)->intValue);
+        else if(!data.empty()) invalidateBulkLoadedPeerData(data.at(0)->intValue);
+
         if(data.size() == 2)
         {
             if(data.at(1)->intValue == 0)
@@ -4245,26 +4641,28 @@ void DatabaseController::savePeerParameterAsynchronous(BaseLib::Database::DataRo
                 return;
             }
             std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE parameters SET value=? WHERE parameterID=?", data);
-            enqueue(0, entry);
+            enqueueWrite(entry);
         }
         else
         {
             if(data.size() == 6)
             {
                 data.push_front(data.at(3));
-                std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO parameters (parameterID, peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value, specialType) VALUES((SELECT parameterID FROM parameters WHERE peerID=" + std::to_string(data.at(1)->intValue) + " AND parameterSetType=" + std::to_string(data.at(2)->intValue) + " AND peerChannel=" + std::to_string(data.at(3)->intValue) + " AND parameterName=?), ?, ?, ?, ?, ?, ?)", data);
-                enqueue(0, entry);
+                data.insert(data.begin(), {data.at(1), data.at(2), data.at(3)});
+                std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO parameters (parameterID, peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value, specialType) VALUES((SELECT parameterID FROM parameters WHERE peerID=? AND parameterSetType=? AND peerChannel=? AND parameterName=?), ?, ?, ?, ?, ?, ?)", data);
+                enqueueWrite(entry);
             }
             else if(data.size() == 7)
             {
                 data.push_front(data.at(5));
-                std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO parameters (parameterID, peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value) VALUES((SELECT parameterID FROM parameters WHERE peerID=" + std::to_string(data.at(1)->intValue) + " AND parameterSetType=" + std::to_string(data.at(2)->intValue) + " AND peerChannel=" + std::to_string(data.at(3)->intValue) + " AND remotePeer=" + std::to_string(data.at(4)->intValue) + " AND remoteChannel=" + std::to_string(data.at(5)->intValue) + " AND parameterName=?), ?, ?, ?, ?, ?, ?, ?)", data);
-                enqueue(0, entry);
+                data.insert(data.begin(), {data.at(1), data.at(2), data.at(3), data.at(4), data.at(5)});
+                std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO parameters (parameterID, peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value) VALUES((SELECT parameterID FROM parameters WHERE peerID=? AND parameterSetType=? AND peerChannel=? AND remotePeer=? AND remoteChannel=? AND parameterName=?), ?, ?, ?, ?, ?, ?, ?)", data);
+                enqueueWrite(entry);
             }
             else if(data.size() == 8 && data.at(0)->intValue != 0)
             {
                 std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("REPLACE INTO parameters (parameterID, peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value) VALUES(?, ?, ?, ?, ?, ?, ?, ?)", data);
-                enqueue(0, entry);
+                enqueueWrite(entry);
             }
             else GD::out.printError("Error: Either parameterID is 0 or the number of columns is invalid.");
         }
@@ -4288,10 +4686,12 @@ void DatabaseController::saveSpecialPeerParameterAsynchronous(BaseLib::Database:
             GD::out.printError("Error: Invalid number of columns.");
             return;
         }
+        invalidateBulkLoadedPeerData(data.at(0)->intValue);
 
         data.push_front(data.at(3));
-        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO parameters (parameterID, peerID, parameterSetType, peerChannel, parameterName, value, specialType, metadata, roles) VALUES((SELECT parameterID FROM parameters WHERE peerID=" + std::to_string(data.at(1)->intValue) + " AND parameterSetType=" + std::to_string(data.at(2)->intValue) + " AND peerChannel=" + std::to_string(data.at(3)->intValue) + " AND parameterName=?), ?, ?, ?, ?, ?, ?, ?, ?)", data);
-        enqueue(0, entry);
+        data.insert(data.begin(), {data.at(1), data.at(2), data.at(3)});
+        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO parameters (parameterID, peerID, parameterSetType, peerChannel, parameterName, value, specialType, metadata, roles) VALUES((SELECT parameterID FROM parameters WHERE peerID=? AND parameterSetType=? AND peerChannel=? AND parameterName=?), ?, ?, ?, ?, ?, ?, ?, ?)", data);
+        enqueueWrite(entry);
     }
     catch(const std::exception& ex)
     {
@@ -4314,8 +4714,9 @@ void DatabaseController::savePeerParameterRoomAsynchronous(BaseLib::Database::Da
                 GD::out.printError("Error: Could not save room of peer parameter. Parameter ID is \"0\".");
                 return;
             }
+            invalidateBulkLoadedPeerParameter(data.at(1)->intValue);
             std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE parameters SET room=? WHERE parameterID=?", data);
-            enqueue(0, entry);
+            enqueueWrite(entry);
         }
     }
     catch(const std::exception& ex)
@@ -4339,8 +4740,9 @@ void DatabaseController::savePeerParameterCategoriesAsynchronous(BaseLib::Databa
                 GD::out.printError("Error: Could not save categories of peer parameter. Parameter ID is \"0\".");
                 return;
             }
+            invalidateBulkLoadedPeerParameter(data.at(1)->intValue);
             std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE parameters SET categories=? WHERE parameterID=?", data);
-            enqueue(0, entry);
+            enqueueWrite(entry);
         }
     }
     catch(const std::exception& ex)
@@ -4364,8 +4766,9 @@ void DatabaseController::savePeerParameterRolesAsynchronous(BaseLib::Database::D
                 GD::out.printError("Error: Could not save roles of peer parameter. Parameter ID is \"0\".");
                 return;
             }
+            invalidateBulkLoadedPeerParameter(data.at(1)->intValue);
             std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE parameters SET roles=? WHERE parameterID=?", data);
-            enqueue(0, entry);
+            enqueueWrite(entry);
         }
     }
     catch(const std::exception& ex)
@@ -4382,6 +4785,11 @@ void DatabaseController::savePeerVariableAsynchronous(BaseLib::Database::DataRow
 {
     try
     {
+        //Bulk loaded rows of the peer would be outdated after this write.
+        if(data.size() == 2) invalidateBulkLoadedPeerVariable(data.at(1)->intValue);
+        else if(data.size() == 5) invalidateBulkLoadedPeerData(data.at(0)->intValue);
+        else if(data.size() == 6) invalidateBulkLoadedPeerData(data.at(1)->intValue);
+
         if(data.size() == 2)
         {
             if(data.at(1)->intValue == 0)
@@ -4393,20 +4801,20 @@ void DatabaseController::savePeerVariableAsynchronous(BaseLib::Database::DataRow
             {
                 case BaseLib::Database::DataColumn::DataType::INTEGER:
                 {
-                    std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE peerVariables SET integerValue=? WHERE variableID=?", data);
-                    enqueue(0, entry);
+                    std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE peerVariables SET integerValue=? WHERE variableID=?", data, "peerVariableId" + std::to_string(data.at(1)->intValue), "peerVariableIndex");
+                    enqueueWrite(entry);
                 }
                     break;
                 case BaseLib::Database::DataColumn::DataType::TEXT:
                 {
-                    std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE peerVariables SET stringValue=? WHERE variableID=?", data);
-                    enqueue(0, entry);
+                    std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE peerVariables SET stringValue=? WHERE variableID=?", data, "peerVariableId" + std::to_string(data.at(1)->intValue), "peerVariableIndex");
+                    enqueueWrite(entry);
                 }
                     break;
                 case BaseLib::Database::DataColumn::DataType::BLOB:
                 {
-                    std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE peerVariables SET binaryValue=? WHERE variableID=?", data);
-                    enqueue(0, entry);
+                    std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE peerVariables SET binaryValue=? WHERE variableID=?", data, "peerVariableId" + std::to_string(data.at(1)->intValue), "peerVariableIndex");
+                    enqueueWrite(entry);
                 }
                     break;
                 case BaseLib::Database::DataColumn::DataType::NODATA:
@@ -4421,13 +4829,15 @@ void DatabaseController::savePeerVariableAsynchronous(BaseLib::Database::DataRow
         {
             if(data.size() == 5)
             {
-                std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO peerVariables (variableID, peerID, variableIndex, integerValue, stringValue, binaryValue) VALUES((SELECT variableID FROM peerVariables WHERE peerID=" + std::to_string(data.at(0)->intValue) + " AND variableIndex=" + std::to_string(data.at(1)->intValue) + "), ?, ?, ?, ?, ?)", data);
-                enqueue(0, entry);
+                BaseLib::Database::DataRow insertData{data.at(0), data.at(1)};
+                insertData.insert(insertData.end(), data.begin(), data.end());
+                std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO peerVariables (variableID, peerID, variableIndex, integerValue, stringValue, binaryValue) VALUES((SELECT variableID FROM peerVariables WHERE peerID=? AND variableIndex=?), ?, ?, ?, ?, ?)", insertData, "peerVariableIndex" + std::to_string(data.at(0)->intValue) + "." + std::to_string(data.at(1)->intValue), "peerVariableId");
+                enqueueWrite(entry);
             }
             else if(data.size() == 6 && data.at(0)->intValue != 0)
             {
                 std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("REPLACE INTO peerVariables VALUES(?, ?, ?, ?, ?, ?)", data);
-                enqueue(0, entry);
+                enqueueWrite(entry);
             }
             else GD::out.printError("Error: Either variableID is 0 or the number of columns is invalid.");
         }
@@ -4446,9 +4856,24 @@ std::shared_ptr<BaseLib::Database::DataTable> DatabaseController::getPeerParamet
 {
     try
     {
+        {
+            std::lock_guard<std::mutex> bulkPeerDataGuard(_bulkPeerDataMutex);
+            auto peerIterator = _bulkPeerParameters.find(peerID);
+            if(peerIterator != _bulkPeerParameters.end())
+            {
+                auto result = peerIterator->second;
+                eraseBulkLoadedPeerRows(peerID, _bulkPeerParameters, _bulkPeerParameterIds);
+                _bulkLoadHits++;
+                return result;
+            }
+        }
+
         BaseLib::Database::DataRow data;
         data.push_back(std::make_shared<BaseLib::Database::DataColumn>(peerID));
+        int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
         std::shared_ptr<BaseLib::Database::DataTable> result = _db.executeCommand("SELECT * FROM parameters WHERE peerID=?", data);
+        _peerParameterReadTime += BaseLib::HelperFunctions::getTimeMicroseconds() - startTime;
+        _peerParameterReads++;
         return result;
     }
     catch(const std::exception& ex)
@@ -4466,9 +4891,24 @@ std::shared_ptr<BaseLib::Database::DataTable> DatabaseController::getPeerVariabl
 {
     try
     {
+        {
+            std::lock_guard<std::mutex> bulkPeerDataGuard(_bulkPeerDataMutex);
+            auto peerIterator = _bulkPeerVariables.find(peerID);
+            if(peerIterator != _bulkPeerVariables.end())
+            {
+                auto result = peerIterator->second;
+                eraseBulkLoadedPeerRows(peerID, _bulkPeerVariables, _bulkPeerVariableIds);
+                _bulkLoadHits++;
+                return result;
+            }
+        }
+
         BaseLib::Database::DataRow data;
         data.push_back(std::make_shared<BaseLib::Database::DataColumn>(peerID));
+        int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
         std::shared_ptr<BaseLib::Database::DataTable> result = _db.executeCommand("SELECT * FROM peerVariables WHERE peerID=?", data);
+        _peerVariableReadTime += BaseLib::HelperFunctions::getTimeMicroseconds() - startTime;
+        _peerVariableReads++;
         return result;
     }
     catch(const std::exception& ex)
@@ -4486,6 +4926,7 @@ void DatabaseController::deletePeerParameter(uint64_t peerID, BaseLib::Database:
 {
     try
     {
+        invalidateBulkLoadedPeerData(peerID);
         if(data.size() == 2)
         {
             if(data.at(1)->intValue == 0)
@@ -4494,22 +4935,22 @@ void DatabaseController::deletePeerParameter(uint64_t peerID, BaseLib::Database:
                 return;
             }
             std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM parameters WHERE peerID=? AND parameterID=?", data);
-            enqueue(0, entry);
+            enqueueWrite(entry);
         }
         else if(data.size() == 4)
         {
             std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM parameters WHERE peerID=? AND parameterSetType=? AND peerChannel=? AND parameterName=?", data);
-            enqueue(0, entry);
+            enqueueWrite(entry);
         }
         else if(data.size() == 5)
         {
             std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM parameters WHERE peerID=? AND parameterSetType=? AND peerChannel=? AND remotePeer=? AND remoteChannel=?", data);
-            enqueue(0, entry);
+            enqueueWrite(entry);
         }
         else
         {
             std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM parameters WHERE peerID=? AND parameterSetType=? AND peerChannel=? AND parameterName=? AND remotePeer=? AND remoteChannel=?", data);
-            enqueue(0, entry);
+            enqueueWrite(entry);
         }
     }
     catch(const std::exception& ex)
@@ -4537,26 +4978,28 @@ bool DatabaseController::setPeerID(uint64_t oldPeerID, uint64_t newPeerID)
         data.push_back(std::make_shared<BaseLib::Database::DataColumn>(newPeerID));
         data.push_back(std::make_shared<BaseLib::Database::DataColumn>(oldPeerID));
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE peers SET peerID=? WHERE peerID=?", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
         entry = std::make_shared<QueueEntry>("UPDATE parameters SET peerID=? WHERE peerID=?", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
         entry = std::make_shared<QueueEntry>("UPDATE peerVariables SET peerID=? WHERE peerID=?", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
         entry = std::make_shared<QueueEntry>("UPDATE serviceMessages SET peerID=? WHERE peerID=?", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
         entry = std::make_shared<QueueEntry>("UPDATE events SET peerID=? WHERE peerID=?", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
 
         {
             std::lock_guard<std::mutex> metadataGuard(_metadataMutex);
             _metadata.erase(oldPeerID);
         }
+        invalidateBulkLoadedPeerData(oldPeerID);
+        invalidateBulkLoadedPeerData(newPeerID);
 
         data.clear();
         data.push_back(std::make_shared<BaseLib::Database::DataColumn>(std::to_string(newPeerID)));
         data.push_back(std::make_shared<BaseLib::Database::DataColumn>(std::to_string(oldPeerID)));
         entry = std::make_shared<QueueEntry>("UPDATE metadata SET objectID=? WHERE objectID=?", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
         return true;
     }
     catch(const std::exception& ex)
@@ -4569,6 +5012,205 @@ bool DatabaseController::setPeerID(uint64_t oldPeerID, uint64_t newPeerID)
     }
     return false;
 }
+
+uint32_t DatabaseController::bulkLoadPeerData(int32_t familyId)
+{
+    try
+    {
+        BaseLib::Database::DataRow data;
+        std::string join;
+        if(familyId != -1)
+        {
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>(familyId));
+            join = " JOIN devices ON devices.deviceID=peers.parent WHERE devices.deviceFamily=?";
+        }
+        return bulkLoadPeerData("SELECT peers.peerID FROM peers" + join,
+                                "SELECT peerVariables.* FROM peerVariables JOIN peers ON peers.peerID=peerVariables.peerID" + join + " ORDER BY peerVariables.peerID",
+                                "SELECT parameters.* FROM parameters JOIN peers ON peers.peerID=parameters.peerID" + join + " ORDER BY parameters.peerID",
+                                data);
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return 0;
+}
+
+uint32_t DatabaseController::bulkLoadPeerData(const std::set<uint64_t>& peerIds)
+{
+    try
+    {
+        //Load in chunks, so the number of parameters stays below SQLite's limit. Every chunk has the same size, so the
+        //statements are only prepared once and stay in the statement cache.
+        const size_t chunkSize = 100;
+        std::string placeholders;
+        placeholders.reserve(chunkSize * 2);
+        for(size_t i = 0; i < chunkSize; i++)
+        {
+            placeholders.append(placeholders.empty() ? "?" : ",?");
+        }
+        const std::string peersCommand = "SELECT peerID FROM peers WHERE peerID IN (" + placeholders + ")";
+        const std::string variablesCommand = "SELECT * FROM peerVariables WHERE peerID IN (" + placeholders + ") ORDER BY peerID";
+        const std::string parametersCommand = "SELECT * FROM parameters WHERE peerID IN (" + placeholders + ") ORDER BY peerID";
+
+        uint32_t peerCount = 0;
+        auto peerIterator = peerIds.begin();
+        while(peerIterator != peerIds.end())
+        {
+            BaseLib::Database::DataRow data;
+            for(; peerIterator != peerIds.end() && data.size() < chunkSize; ++peerIterator)
+            {
+                data.push_back(std::make_shared<BaseLib::Database::DataColumn>(*peerIterator));
+            }
+            //The last chunk is filled up with its last peer ID. Duplicates in IN lists don't change the result.
+            while(data.size() < chunkSize) data.push_back(data.back());
+            peerCount += bulkLoadPeerData(peersCommand, variablesCommand, parametersCommand, data);
+        }
+        return peerCount;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return 0;
+}
+
+uint32_t DatabaseController::bulkLoadPeerData(const std::string& peersCommand, const std::string& variablesCommand, const std::string& parametersCommand, BaseLib::Database::DataRow& data)
+{
+    try
+    {
+        int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
+
+        std::unordered_map<uint64_t, std::shared_ptr<BaseLib::Database::DataTable>> peerVariables;
+        std::unordered_map<uint64_t, std::shared_ptr<BaseLib::Database::DataTable>> peerParameters;
+        std::unordered_map<uint64_t, uint64_t> variableIds;
+        std::unordered_map<uint64_t, uint64_t> parameterIds;
+        //Peers without variables or parameters get empty tables, so they are not looked up again.
+        bool success = _db.executeQuery(peersCommand, data, [&](SQLite3::Row& row)
+        {
+            uint64_t peerId = (uint64_t)row.getInteger(0);
+            peerVariables.emplace(peerId, std::make_shared<BaseLib::Database::DataTable>());
+            peerParameters.emplace(peerId, std::make_shared<BaseLib::Database::DataTable>());
+            return true;
+        });
+        if(!success) return 0;
+
+        bulkLoadPeerRows(variablesCommand, data, peerVariables, variableIds);
+        bulkLoadPeerRows(parametersCommand, data, peerParameters, parameterIds);
+
+        uint32_t peerCount = peerVariables.size();
+        {
+            std::lock_guard<std::mutex> bulkPeerDataGuard(_bulkPeerDataMutex);
+            for(auto& element : peerVariables)
+            {
+                _bulkPeerVariables[element.first] = std::move(element.second);
+            }
+            for(auto& element : peerParameters)
+            {
+                _bulkPeerParameters[element.first] = std::move(element.second);
+            }
+            _bulkPeerVariableIds.insert(variableIds.begin(), variableIds.end());
+            _bulkPeerParameterIds.insert(parameterIds.begin(), parameterIds.end());
+        }
+
+        _bulkLoadedPeers += peerCount;
+        _bulkLoadTime += BaseLib::HelperFunctions::getTimeMicroseconds() - startTime;
+        return peerCount;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return 0;
+}
+
+void DatabaseController::bulkLoadPeerRows(const std::string& command, BaseLib::Database::DataRow& data, std::unordered_map<uint64_t, std::shared_ptr<BaseLib::Database::DataTable>>& peerRows, std::unordered_map<uint64_t, uint64_t>& rowPeerIds)
+{
+    uint64_t currentPeerId = 0;
+    std::shared_ptr<BaseLib::Database::DataTable> currentTable;
+    bool success = _db.executeQuery(command, data, [&](SQLite3::Row& row)
+    {
+        uint64_t peerId = (uint64_t)row.getInteger(1);
+        if(!currentTable || peerId != currentPeerId)
+        {
+            currentPeerId = peerId;
+            auto& table = peerRows[peerId];
+            if(!table) table = std::make_shared<BaseLib::Database::DataTable>();
+            currentTable = table;
+        }
+        rowPeerIds.emplace((uint64_t)row.getInteger(0), peerId);
+
+        auto& dataRow = (*currentTable)[currentTable->size()];
+        int32_t columnCount = row.columnCount();
+        for(int32_t i = 0; i < columnCount; i++)
+        {
+            dataRow[i] = row.getDataColumn(i);
+        }
+        return true;
+    });
+    if(!success) throw BaseLib::Exception("Could not execute command: " + command);
+}
+
+void DatabaseController::eraseBulkLoadedPeerRows(uint64_t peerId, std::unordered_map<uint64_t, std::shared_ptr<BaseLib::Database::DataTable>>& peerRows, std::unordered_map<uint64_t, uint64_t>& rowPeerIds)
+{
+    auto peerIterator = peerRows.find(peerId);
+    if(peerIterator == peerRows.end()) return;
+    for(auto& row : *peerIterator->second)
+    {
+        auto columnIterator = row.second.find(0);
+        if(columnIterator != row.second.end()) rowPeerIds.erase((uint64_t)columnIterator->second->intValue);
+    }
+    peerRows.erase(peerIterator);
+}
+
+void DatabaseController::invalidateBulkLoadedPeerData(uint64_t peerId)
+{
+    std::lock_guard<std::mutex> bulkPeerDataGuard(_bulkPeerDataMutex);
+    if(_bulkPeerVariables.empty() && _bulkPeerParameters.empty()) return;
+    eraseBulkLoadedPeerRows(peerId, _bulkPeerVariables, _bulkPeerVariableIds);
+    eraseBulkLoadedPeerRows(peerId, _bulkPeerParameters, _bulkPeerParameterIds);
+}
+
+void DatabaseController::invalidateBulkLoadedPeerVariable(uint64_t variableId)
+{
+    std::lock_guard<std::mutex> bulkPeerDataGuard(_bulkPeerDataMutex);
+    auto variableIterator = _bulkPeerVariableIds.find(variableId);
+    if(variableIterator == _bulkPeerVariableIds.end()) return;
+    uint64_t peerId = variableIterator->second;
+    eraseBulkLoadedPeerRows(peerId, _bulkPeerVariables, _bulkPeerVariableIds);
+    eraseBulkLoadedPeerRows(peerId, _bulkPeerParameters, _bulkPeerParameterIds);
+}
+
+void DatabaseController::invalidateBulkLoadedPeerParameter(uint64_t parameterId)
+{
+    std::lock_guard<std::mutex> bulkPeerDataGuard(_bulkPeerDataMutex);
+    auto parameterIterator = _bulkPeerParameterIds.find(parameterId);
+    if(parameterIterator == _bulkPeerParameterIds.end()) return;
+    uint64_t peerId = parameterIterator->second;
+    eraseBulkLoadedPeerRows(peerId, _bulkPeerVariables, _bulkPeerVariableIds);
+    eraseBulkLoadedPeerRows(peerId, _bulkPeerParameters, _bulkPeerParameterIds);
+}
+
+void DatabaseController::clearBulkLoadedPeerData()
+{
+    std::lock_guard<std::mutex> bulkPeerDataGuard(_bulkPeerDataMutex);
+    _bulkPeerVariables.clear();
+    _bulkPeerParameters.clear();
+    _bulkPeerVariableIds.clear();
+    _bulkPeerParameterIds.clear();
+}
 //End peer
 
 //Service messages
@@ -4608,19 +5250,19 @@ void DatabaseController::saveServiceMessageAsynchronous(uint64_t peerID, BaseLib
                 case BaseLib::Database::DataColumn::DataType::INTEGER:
                 {
                     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE serviceMessages SET timestamp=?, integerValue=? WHERE variableID=?", data);
-                    enqueue(0, entry);
+                    enqueueWrite(entry);
                 }
                     break;
                 case BaseLib::Database::DataColumn::DataType::TEXT:
                 {
                     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE serviceMessages SET timestamp=?, message=? WHERE variableID=?", data);
-                    enqueue(0, entry);
+                    enqueueWrite(entry);
                 }
                     break;
                 case BaseLib::Database::DataColumn::DataType::BLOB:
                 {
                     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE serviceMessages SET timestamp=?, binaryData=? WHERE variableID=?", data);
-                    enqueue(0, entry);
+                    enqueueWrite(entry);
                 }
                     break;
                 case BaseLib::Database::DataColumn::DataType::NODATA:
@@ -4639,17 +5281,19 @@ void DatabaseController::saveServiceMessageAsynchronous(uint64_t peerID, BaseLib
                 return;
             }
             std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE serviceMessages SET timestamp=?, integerValue=?, message=?, binaryData=? WHERE variableID=?", data);
-            enqueue(0, entry);
+            enqueueWrite(entry);
         }
         else if(data.size() == 9)
         {
-            std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO serviceMessages (variableID, familyID, peerID, messageID, messageSubID, timestamp, integerValue, message, variables, binaryData) VALUES((SELECT variableID FROM serviceMessages WHERE peerID=" + std::to_string(data.at(1)->intValue) + " AND messageID=" + std::to_string(data.at(2)->intValue) + "), ?, ?, ?, ?, ?, ?, ?, ?, ?)", data);
-            enqueue(0, entry);
+            BaseLib::Database::DataRow insertData{data.at(1), data.at(2)};
+            insertData.insert(insertData.end(), data.begin(), data.end());
+            std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO serviceMessages (variableID, familyID, peerID, messageID, messageSubID, timestamp, integerValue, message, variables, binaryData) VALUES((SELECT variableID FROM serviceMessages WHERE peerID=? AND messageID=?), ?, ?, ?, ?, ?, ?, ?, ?, ?)", insertData);
+            enqueueWrite(entry);
         }
         else if(data.size() == 10 && data.at(0)->intValue != 0)
         {
             std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("REPLACE INTO serviceMessages VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", data);
-            enqueue(0, entry);
+            enqueueWrite(entry);
         }
         else GD::out.printError("Error: Either variableID is 0 or the number of columns is invalid.");
     }
@@ -4670,7 +5314,7 @@ void DatabaseController::saveGlobalServiceMessageAsynchronous(BaseLib::Database:
         if(data.size() == 11)
         {
             std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO serviceMessages (variableID, familyID, peerID, messageID, messageSubID, timestamp, integerValue, message, variables, binaryData) VALUES((SELECT variableID FROM serviceMessages WHERE familyID=" + std::to_string(data.at(2)->intValue) + " AND messageID=" + std::to_string(data.at(4)->intValue) + " AND messageSubID=? AND message=?), ?, ?, ?, ?, ?, ?, ?, ?, ?)", data);
-            enqueue(0, entry);
+            enqueueWrite(entry);
         }
         else GD::out.printError("Error: Either variableID is 0 or the number of columns is invalid.");
     }
@@ -4756,19 +5400,19 @@ void DatabaseController::saveLicenseVariable(int32_t moduleId, BaseLib::Database
                 case BaseLib::Database::DataColumn::DataType::INTEGER:
                 {
                     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE licenseVariables SET integerValue=? WHERE variableID=?", data);
-                    enqueue(0, entry);
+                    enqueueWrite(entry);
                 }
                     break;
                 case BaseLib::Database::DataColumn::DataType::TEXT:
                 {
                     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE licenseVariables SET stringValue=? WHERE variableID=?", data);
-                    enqueue(0, entry);
+                    enqueueWrite(entry);
                 }
                     break;
                 case BaseLib::Database::DataColumn::DataType::BLOB:
                 {
                     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE licenseVariables SET binaryValue=? WHERE variableID=?", data);
-                    enqueue(0, entry);
+                    enqueueWrite(entry);
                 }
                     break;
                 case BaseLib::Database::DataColumn::DataType::NODATA:
@@ -4783,13 +5427,15 @@ void DatabaseController::saveLicenseVariable(int32_t moduleId, BaseLib::Database
         {
             if(data.size() == 5)
             {
-                std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO licenseVariables (variableID, moduleID, variableIndex, integerValue, stringValue, binaryValue) VALUES((SELECT variableID FROM licenseVariables WHERE moduleID=" + std::to_string(data.at(0)->intValue) + " AND variableIndex=" + std::to_string(data.at(1)->intValue) + "), ?, ?, ?, ?, ?)", data);
-                enqueue(0, entry);
+                BaseLib::Database::DataRow insertData{data.at(0), data.at(1)};
+                insertData.insert(insertData.end(), data.begin(), data.end());
+                std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO licenseVariables (variableID, moduleID, variableIndex, integerValue, stringValue, binaryValue) VALUES((SELECT variableID FROM licenseVariables WHERE moduleID=? AND variableIndex=?), ?, ?, ?, ?, ?)", insertData);
+                enqueueWrite(entry);
             }
             else if(data.size() == 6 && data.at(0)->intValue != 0)
             {
                 std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("REPLACE INTO licenseVariables VALUES(?, ?, ?, ?, ?, ?)", data);
-                enqueue(0, entry);
+                enqueueWrite(entry);
             }
             else GD::out.printError("Error: Either variableID is 0 or the number of columns is invalid.");
         }
@@ -33,10 +33,15 @@
 
 #include <homegear-base/BaseLib.h>
 #include "SQLite3.h"
+#include "DatabaseSettings.h"
+#include "DataCache.h"
 
 #include <thread>
 #include <condition_variable>
 #include <atomic>
+#include <set>
+#include <map>
+#include <unordered_set>
 
 namespace Homegear
 {
@@ -47,14 +52,37 @@ public:
 	class QueueEntry : public BaseLib::IQueueEntry
 	{
 	public:
-		QueueEntry(std::string command, BaseLib::Database::DataRow& data) { _entry = std::make_shared<std::pair<std::string, BaseLib::Database::DataRow>>(command, data); };
+		/**
+		 * @param command The SQL command to execute.
+		 * @param data The data to bind to the command.
+		 * @param coalescingKey Writes with the same non-empty key overwrite the same row. Only the latest of those still waiting in the queue is executed.
+		 * @param barrierPrefix Pending writes with a key starting with this prefix might overwrite the same row under a different key. They are not coalesced with writes queued after this one.
+		 */
+		QueueEntry(std::string command, BaseLib::Database::DataRow& data, std::string coalescingKey = "", std::string barrierPrefix = "") : _coalescingKey(coalescingKey), _barrierPrefix(barrierPrefix) { _entry = std::make_shared<std::pair<std::string, BaseLib::Database::DataRow>>(command, data); };
 
 		virtual ~QueueEntry() {};
 
 		std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>>& getEntry() { return _entry; }
+		void setEntry(std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>>& value) { _entry = value; }
+		const std::string& getCoalescingKey() { return _coalescingKey; }
+		const std::string& getBarrierPrefix() { return _barrierPrefix; }
+
+		/**
+		 * After the write is executed, the number of changed rows times "factor" is added to "counter".
+		 */
+		void setRowCounter(std::atomic<int64_t>* counter, int32_t factor) { _rowCounter = counter; _rowCounterFactor = factor; }
+		std::atomic<int64_t>* getRowCounter() { return _rowCounter; }
+		int32_t getRowCounterFactor() { return _rowCounterFactor; }
+		uint64_t getSequence() { return _sequence; }
+		void setSequence(uint64_t value) { _sequence = value; }
 
 	private:
 		std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>> _entry;
+		std::string _coalescingKey;
+		std::string _barrierPrefix;
+		uint64_t _sequence = 0;
+		std::atomic<int64_t>* _rowCounter = nullptr;
+		int32_t _rowCounterFactor = 0;
 	};
 
 	DatabaseController();
@@ -83,6 +111,15 @@ public:
 	void createSavepointAsynchronous(std::string& name) override;
 
 	void releaseSavepointAsynchronous(std::string& name) override;
+
+	/**
+	 * Returns statistics about the write queue, group commits, the data caches and the prepared statement cache.
+	 *
+	 * @return A struct with one entry per metric.
+	 */
+	BaseLib::PVariable getMetrics();
+
+	DatabaseSettings& getSettings() { return _settings; }
 	// }}}
 
 	// {{{ Homegear variables
@@ -346,6 +383,29 @@ public:
      * {@inheritDoc}
      */
 	bool setPeerID(uint64_t oldPeerID, uint64_t newPeerID) override;
+
+	/**
+	 * Reads the variables and parameters of the peers of a family in one pass ordered by peer ID. Until
+	 * clearBulkLoadedPeerData() is called, getPeerVariables() and getPeerParameters() return this data instead of
+	 * querying the database. The data of a peer is only returned once.
+	 *
+	 * @param familyId The family to load the peers of or -1 to load the peers of all families.
+	 * @return The number of loaded peers.
+	 */
+	uint32_t bulkLoadPeerData(int32_t familyId = -1);
+
+	/**
+	 * Same as bulkLoadPeerData(int32_t), but loads the given peers.
+	 *
+	 * @param peerIds The IDs of the peers to load.
+	 * @return The number of loaded peers.
+	 */
+	uint32_t bulkLoadPeerData(const std::set<uint64_t>& peerIds);
+
+	/**
+	 * Drops all bulk loaded peer data, that has not been returned yet.
+	 */
+	void clearBulkLoadedPeerData();
 	// }}}
 
 	// {{{ Service messages
@@ -371,15 +431,168 @@ protected:
 	std::atomic_bool _disposing;
 
 	Homegear::SQLite3 _db;
+	DatabaseSettings _settings;
+
+	// {{{ Group commit
+	/**
+	 * Protects the group commit state. Also serializes SAVEPOINT and RELEASE from outside of the queue thread with open
+	 * group transactions.
+	 */
+	std::mutex _transactionMutex;
+	bool _transactionOpen = false;
+	int32_t _savepointDepth = 0;
+	int64_t _transactionStartTime = 0;
+	uint32_t _transactionEntries = 0;
+
+	std::atomic<uint64_t> _groupCommitCount{0};
+	std::atomic<uint64_t> _groupCommitEntries{0};
+	std::atomic<uint64_t> _groupCommitMaxEntries{0};
+	std::atomic<uint64_t> _commitLatencySum{0};
+	std::atomic<uint64_t> _commitLatencyMax{0};
+	std::atomic<uint64_t> _queuedWrites{0};
+
+	/**
+	 * Commits the currently open group transaction if there is one. _transactionMutex needs to be locked.
+	 */
+	void commitTransaction();
+	// }}}
+
+	// {{{ Volatile database
+	/**
+	 * The tables stored in the volatile database when "volatileDatabase" is enabled.
+	 */
+	const std::vector<std::string> _volatileTables{"peerVariables", "events", "data"};
+
+	/**
+	 * Moves a table including its indexes from one attached database to another in one transaction. When the table exists
+	 * in both databases, the one in "main" is kept, because it is the one unqualified table names resolve to.
+	 *
+	 * @param table The name of the table.
+	 * @param sourceSchema The schema to move the table from, i. e. "main" or "volatile".
+	 * @param targetSchema The schema to move the table to.
+	 * @return false when the table could not be moved.
+	 */
+	bool moveTable(const std::string& table, const std::string& sourceSchema, const std::string& targetSchema);
+
+	/**
+	 * Inserts "schema" into a CREATE statement read from sqlite_master.
+	 */
+	static std::string qualifyCreateStatement(const std::string& statement, const std::string& schema);
+
+	/**
+	 * Returns "volatile." when a table is currently stored in the volatile database and an empty string otherwise.
+	 * Indexes are always created in the schema of their name, so the name of an index on such a table needs this
+	 * prefix. Used by convertDatabase(), which runs before the tables are moved.
+	 */
+	std::string getTableSchema(const std::string& table);
+	// }}}
+
+	// {{{ Peer lookup timing, in microseconds
+	std::atomic<uint64_t> _peerVariableReads{0};
+	std::atomic<uint64_t> _peerVariableReadTime{0};
+	std::atomic<uint64_t> _peerParameterReads{0};
+	std::atomic<uint64_t> _peerParameterReadTime{0};
+	// }}}
+
+	// {{{ Bulk peer loading
+	std::mutex _bulkPeerDataMutex;
+	std::unordered_map<uint64_t, std::shared_ptr<BaseLib::Database::DataTable>> _bulkPeerVariables;
+	std::unordered_map<uint64_t, std::shared_ptr<BaseLib::Database::DataTable>> _bulkPeerParameters;
+
+	/**
+	 * The peer IDs of the bulk loaded rows by variable and parameter ID, so writes addressing rows by ID can invalidate them.
+	 */
+	std::unordered_map<uint64_t, uint64_t> _bulkPeerVariableIds;
+	std::unordered_map<uint64_t, uint64_t> _bulkPeerParameterIds;
+	std::atomic<uint64_t> _bulkLoadedPeers{0};
+	std::atomic<uint64_t> _bulkLoadTime{0};
+	std::atomic<uint64_t> _bulkLoadHits{0};
+
+	/**
+	 * Loads the peers returned by "peersCommand" and their rows returned by "variablesCommand" and "parametersCommand".
+	 * The rows need to be ordered by peer ID. All commands are executed with the same "data".
+	 */
+	uint32_t bulkLoadPeerData(const std::string& peersCommand, const std::string& variablesCommand, const std::string& parametersCommand, BaseLib::Database::DataRow& data);
+
+	/**
+	 * Groups the rows returned by "command" by the peer ID in column 1 and maps the row ID in column 0 to the peer ID.
+	 */
+	void bulkLoadPeerRows(const std::string& command, BaseLib::Database::DataRow& data, std::unordered_map<uint64_t, std::shared_ptr<BaseLib::Database::DataTable>>& peerRows, std::unordered_map<uint64_t, uint64_t>& rowPeerIds);
+
+	/**
+	 * Removes the bulk loaded data of a peer, so it is read from the database again.
+	 */
+	void invalidateBulkLoadedPeerData(uint64_t peerId);
+
+	/**
+	 * Removes the bulk loaded data of the peer the variable with ID "variableId" belongs to.
+	 */
+	void invalidateBulkLoadedPeerVariable(uint64_t variableId);
+
+	/**
+	 * Removes the bulk loaded data of the peer the parameter with ID "parameterId" belongs to.
+	 */
+	void invalidateBulkLoadedPeerParameter(uint64_t parameterId);
+
+	/**
+	 * Removes a peer's bulk loaded rows and their IDs. _bulkPeerDataMutex needs to be locked.
+	 */
+	static void eraseBulkLoadedPeerRows(uint64_t peerId, std::unordered_map<uint64_t, std::shared_ptr<BaseLib::Database::DataTable>>& peerRows, std::unordered_map<uint64_t, uint64_t>& rowPeerIds);
+	// }}}
+
+	// {{{ Write coalescing
+	/**
+	 * Queued writes with a coalescing key, that have not been executed yet. Ordered, so writes with a barrier prefix can find all keys starting with it.
+	 */
+	std::mutex _pendingWritesMutex;
+	std::map<std::string, std::shared_ptr<QueueEntry>> _pendingWrites;
+	std::atomic<uint64_t> _coalescedWrites{0};
+
+	/**
+	 * Number of writes added to the queue. Every write gets the next number as sequence number.
+	 */
+	std::atomic<uint64_t> _enqueuedWrites{0};
+
+	/**
+	 * Number of writes executed by the queue. A write has been executed when its sequence number is not larger.
+	 */
+	std::atomic<uint64_t> _processedWrites{0};
+
+	/**
+	 * Number of executed writes, that have been committed. Only these can be read by the connections of the read pool, so
+	 * the data caches keep values with newer writes.
+	 */
+	std::atomic<uint64_t> _committedWrites{0};
+
+	/**
+	 * Adds a write to the queue. When a write with the same coalescing key is still pending, its data is replaced instead.
+	 * Writes without a key clear the pending writes, so no write is ever moved past one of them.
+	 *
+	 * @return The sequence number of the write or 0 when it could not be queued.
+	 */
+	uint64_t enqueueWrite(std::shared_ptr<BaseLib::IQueueEntry>& entry);
+	// }}}
 
 	std::unique_ptr<BaseLib::Rpc::RpcDecoder> _rpcDecoder;
 	std::unique_ptr<BaseLib::Rpc::RpcEncoder> _rpcEncoder;
 
 	std::mutex _dataMutex;
-	std::unordered_map<std::string, std::map<std::string, BaseLib::PVariable>> _data;
+	DataCache _data{_committedWrites};
+
+	/**
+	 * The number of rows in "data". It is counted once at startup and updated with the number of rows the queued inserts
+	 * and deletes changed, when they are executed.
+	 */
+	std::atomic<int64_t> _dataRowCount{0};
+
+	/**
+	 * The components of user data are prefixed with the user ID, e.g. "5/ui".
+	 */
+	std::mutex _userDataMutex;
+	DataCache _userData{_committedWrites};
 
 	std::mutex _nodeDataMutex;
-	std::unordered_map<std::string, std::map<std::string, BaseLib::PVariable>> _nodeData;
+	DataCache _nodeData{_committedWrites};
 
 	std::mutex _metadataMutex;
 	std::unordered_map<uint64_t, std::map<std::string, BaseLib::PVariable>> _metadata;
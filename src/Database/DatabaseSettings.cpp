@@ -0,0 +1,246 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "../GD/GD.h"
+#include "DatabaseSettings.h"
+
+#include <sstream>
+
+namespace Homegear
+{
+
+DatabaseSettings::DatabaseSettings()
+{
+    reset();
+}
+
+void DatabaseSettings::reset()
+{
+    _groupCommit = true;
+    _groupCommitMaxEntries = 1000;
+    _groupCommitMaxDuration = 100;
+    _synchronousMode = "";
+    _readConnections = 2;
+    _backupPagesPerStep = 100;
+    _backupStepInterval = 10;
+    _volatileDatabase = false;
+    _volatileSynchronousMode = "normal";
+    _volatileBackups = true;
+    _dataCacheSize = 16384;
+    _nodeDataCacheSize = 16384;
+    _userDataCacheSize = 4096;
+    _historyEnabled = false;
+    _historyBlockSize = 256;
+    _historyFlushInterval = 600;
+    _historyRetention = 365;
+    _historyVariables.clear();
+}
+
+void DatabaseSettings::load(std::string filename)
+{
+    try
+    {
+        reset();
+        char input[1024];
+        FILE* fin;
+        int32_t len, ptr;
+        bool found = false;
+
+        if(!(fin = fopen(filename.c_str(), "r")))
+        {
+            GD::bl->out.printInfo("Info: Unable to open config file: " + filename + ". Using default database settings.");
+            return;
+        }
+
+        while(fgets(input, 1024, fin))
+        {
+            if(input[0] == '#') continue;
+            len = strlen(input);
+            if(len < 2) continue;
+            if(input[len - 1] == '\n') input[len - 1] = '\0';
+            ptr = 0;
+            found = false;
+            while(ptr < len)
+            {
+                if(input[ptr] == '=')
+                {
+                    found = true;
+                    input[ptr++] = '\0';
+                    break;
+                }
+                ptr++;
+            }
+            if(found)
+            {
+                std::string name(input);
+                BaseLib::HelperFunctions::toLower(name);
+                BaseLib::HelperFunctions::trim(name);
+                std::string value(&input[ptr]);
+                BaseLib::HelperFunctions::trim(value);
+                if(name == "groupcommit")
+                {
+                    _groupCommit = (BaseLib::HelperFunctions::toLower(value) == "true");
+                    GD::bl->out.printDebug("Debug (database settings): groupCommit set to " + std::to_string(_groupCommit));
+                }
+                else if(name == "groupcommitmaxentries")
+                {
+                    int32_t integerValue = BaseLib::Math::getNumber(value, false);
+                    if(integerValue > 0) _groupCommitMaxEntries = integerValue;
+                    GD::bl->out.printDebug("Debug (database settings): groupCommitMaxEntries set to " + std::to_string(_groupCommitMaxEntries));
+                }
+                else if(name == "groupcommitmaxduration")
+                {
+                    int32_t integerValue = BaseLib::Math::getNumber(value, false);
+                    if(integerValue > 0) _groupCommitMaxDuration = integerValue;
+                    GD::bl->out.printDebug("Debug (database settings): groupCommitMaxDuration set to " + std::to_string(_groupCommitMaxDuration));
+                }
+                else if(name == "synchronousmode")
+                {
+                    BaseLib::HelperFunctions::toLower(value);
+                    if(value == "off" || value == "normal" || value == "full" || value == "extra") _synchronousMode = value;
+                    else if(value.empty() || value == "default") _synchronousMode = "";
+                    else GD::bl->out.printWarning("Warning (database settings): Unknown value for synchronousMode: " + value);
+                    GD::bl->out.printDebug("Debug (database settings): synchronousMode set to " + _synchronousMode);
+                }
+                else if(name == "readconnections")
+                {
+                    _readConnections = BaseLib::Math::getNumber(value, false);
+                    if(_readConnections < 0) _readConnections = 0;
+                    else if(_readConnections > 100) _readConnections = 100;
+                    GD::bl->out.printDebug("Debug (database settings): readConnections set to " + std::to_string(_readConnections));
+                }
+                else if(name == "backuppagesperstep")
+                {
+                    _backupPagesPerStep = BaseLib::Math::getNumber(value, false);
+                    GD::bl->out.printDebug("Debug (database settings): backupPagesPerStep set to " + std::to_string(_backupPagesPerStep));
+                }
+                else if(name == "backupstepinterval")
+                {
+                    _backupStepInterval = BaseLib::Math::getNumber(value, false);
+                    if(_backupStepInterval < 0) _backupStepInterval = 0;
+                    GD::bl->out.printDebug("Debug (database settings): backupStepInterval set to " + std::to_string(_backupStepInterval));
+                }
+                else if(name == "volatiledatabase")
+                {
+                    _volatileDatabase = (BaseLib::HelperFunctions::toLower(value) == "true");
+                    GD::bl->out.printDebug("Debug (database settings): volatileDatabase set to " + std::to_string(_volatileDatabase));
+                }
+                else if(name == "volatilesynchronousmode")
+                {
+                    BaseLib::HelperFunctions::toLower(value);
+                    if(value == "off" || value == "normal" || value == "full" || value == "extra") _volatileSynchronousMode = value;
+                    else if(value.empty() || value == "default") _volatileSynchronousMode = "";
+                    else GD::bl->out.printWarning("Warning (database settings): Unknown value for volatileSynchronousMode: " + value);
+                    GD::bl->out.printDebug("Debug (database settings): volatileSynchronousMode set to " + _volatileSynchronousMode);
+                }
+                else if(name == "volatilebackups")
+                {
+                    _volatileBackups = (BaseLib::HelperFunctions::toLower(value) == "true");
+                    GD::bl->out.printDebug("Debug (database settings): volatileBackups set to " + std::to_string(_volatileBackups));
+                }
+                else if(name == "datacachesize")
+                {
+                    _dataCacheSize = BaseLib::Math::getNumber(value, false);
+                    if(_dataCacheSize < 0) _dataCacheSize = 0;
+                    GD::bl->out.printDebug("Debug (database settings): dataCacheSize set to " + std::to_string(_dataCacheSize));
+                }
+                else if(name == "nodedatacachesize")
+                {
+                    _nodeDataCacheSize = BaseLib::Math::getNumber(value, false);
+                    if(_nodeDataCacheSize < 0) _nodeDataCacheSize = 0;
+                    GD::bl->out.printDebug("Debug (database settings): nodeDataCacheSize set to " + std::to_string(_nodeDataCacheSize));
+                }
+                else if(name == "userdatacachesize")
+                {
+                    _userDataCacheSize = BaseLib::Math::getNumber(value, false);
+                    if(_userDataCacheSize < 0) _userDataCacheSize = 0;
+                    GD::bl->out.printDebug("Debug (database settings): userDataCacheSize set to " + std::to_string(_userDataCacheSize));
+                }
+                else if(name == "historyenabled")
+                {
+                    _historyEnabled = (BaseLib::HelperFunctions::toLower(value) == "true");
+                    GD::bl->out.printDebug("Debug (database settings): historyEnabled set to " + std::to_string(_historyEnabled));
+                }
+                else if(name == "historyblocksize")
+                {
+                    int32_t integerValue = BaseLib::Math::getNumber(value, false);
+                    if(integerValue > 0) _historyBlockSize = integerValue;
+                    GD::bl->out.printDebug("Debug (database settings): historyBlockSize set to " + std::to_string(_historyBlockSize));
+                }
+                else if(name == "historyflushinterval")
+                {
+                    int32_t integerValue = BaseLib::Math::getNumber(value, false);
+                    if(integerValue > 0) _historyFlushInterval = integerValue;
+                    GD::bl->out.printDebug("Debug (database settings): historyFlushInterval set to " + std::to_string(_historyFlushInterval));
+                }
+                else if(name == "historyretention")
+                {
+                    _historyRetention = BaseLib::Math::getNumber(value, false);
+                    if(_historyRetention < 0) _historyRetention = 0;
+                    GD::bl->out.printDebug("Debug (database settings): historyRetention set to " + std::to_string(_historyRetention));
+                }
+                else if(name == "historyvariable")
+                {
+                    std::istringstream stream(value);
+                    std::string peerId;
+                    std::string channel;
+                    std::string retention;
+                    HistoryVariable historyVariable;
+                    if(!(stream >> peerId >> channel >> historyVariable.variable >> retention))
+                    {
+                        GD::bl->out.printWarning("Warning (database settings): Invalid historyVariable entry: " + value);
+                        continue;
+                    }
+                    historyVariable.anyPeer = (peerId == "*");
+                    if(!historyVariable.anyPeer) historyVariable.peerId = BaseLib::Math::getNumber64(peerId, false);
+                    historyVariable.anyChannel = (channel == "*");
+                    if(!historyVariable.anyChannel) historyVariable.channel = BaseLib::Math::getNumber(channel, false);
+                    if(historyVariable.variable == "*") historyVariable.variable.clear();
+                    historyVariable.retention = BaseLib::Math::getNumber(retention, false);
+                    if(historyVariable.retention < 0) historyVariable.retention = 0;
+                    _historyVariables.push_back(historyVariable);
+                    GD::bl->out.printDebug("Debug (database settings): Added historyVariable " + value);
+                }
+                else
+                {
+                    GD::bl->out.printWarning("Warning: Setting not found: " + std::string(input));
+                }
+            }
+        }
+
+        fclose(fin);
+    }
+    catch(const std::exception& ex)
+    {
+        GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+}
@@ -0,0 +1,140 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef DATABASESETTINGS_H_
+#define DATABASESETTINGS_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <string>
+#include <vector>
+
+namespace Homegear
+{
+
+class DatabaseSettings
+{
+public:
+    /**
+     * Selects the variables recorded by the history store and how long their values are kept.
+     */
+    struct HistoryVariable
+    {
+        bool anyPeer = true;
+        uint64_t peerId = 0;
+        bool anyChannel = true;
+        int32_t channel = -1;
+        /**
+         * Empty for all variables.
+         */
+        std::string variable;
+        /**
+         * Retention in days. 0 disables recording.
+         */
+        int32_t retention = 0;
+    };
+
+    DatabaseSettings();
+
+    virtual ~DatabaseSettings() {}
+
+    void load(std::string filename);
+
+    // {{{ Group commit
+    bool groupCommit() { return _groupCommit; }
+
+    int32_t groupCommitMaxEntries() { return _groupCommitMaxEntries; }
+
+    int32_t groupCommitMaxDuration() { return _groupCommitMaxDuration; }
+    // }}}
+
+    std::string synchronousMode() { return _synchronousMode; }
+
+    int32_t readConnections() { return _readConnections; }
+
+    // {{{ Backup
+    int32_t backupPagesPerStep() { return _backupPagesPerStep; }
+
+    int32_t backupStepInterval() { return _backupStepInterval; }
+    // }}}
+
+    // {{{ Volatile database
+    bool volatileDatabase() { return _volatileDatabase; }
+
+    std::string volatileSynchronousMode() { return _volatileSynchronousMode; }
+
+    bool volatileBackups() { return _volatileBackups; }
+    // }}}
+
+    // {{{ Data caches
+    int32_t dataCacheSize() { return _dataCacheSize; }
+
+    int32_t nodeDataCacheSize() { return _nodeDataCacheSize; }
+
+    int32_t userDataCacheSize() { return _userDataCacheSize; }
+    // }}}
+
+    // {{{ History
+    bool historyEnabled() { return _historyEnabled; }
+
+    int32_t historyBlockSize() { return _historyBlockSize; }
+
+    int32_t historyFlushInterval() { return _historyFlushInterval; }
+
+    int32_t historyRetention() { return _historyRetention; }
+
+    std::vector<HistoryVariable>& historyVariables() { return _historyVariables; }
+    // }}}
+private:
+    bool _groupCommit = true;
+    int32_t _groupCommitMaxEntries = 1000;
+    int32_t _groupCommitMaxDuration = 100;
+    std::string _synchronousMode;
+    int32_t _readConnections = 2;
+    int32_t _backupPagesPerStep = 100;
+    int32_t _backupStepInterval = 10;
+    bool _volatileDatabase = false;
+    std::string _volatileSynchronousMode = "normal";
+    bool _volatileBackups = true;
+    int32_t _dataCacheSize = 16384;
+    int32_t _nodeDataCacheSize = 16384;
+    int32_t _userDataCacheSize = 4096;
+    bool _historyEnabled = false;
+    int32_t _historyBlockSize = 256;
+    int32_t _historyFlushInterval = 600;
+    int32_t _historyRetention = 365;
+    std::vector<HistoryVariable> _historyVariables;
+
+    void reset();
+};
+
+}
+
+#endif
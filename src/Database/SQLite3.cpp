@@ -33,6 +33,8 @@
 #include "SQLite3.h"
 #include "../GD/GD.h"
 
+#include <cctype>
+
 namespace Homegear
 {
 
@@ -76,33 +78,199 @@ void SQLite3::dispose()
     closeDatabase(true);
 }
 
-void SQLite3::hotBackup()
+void SQLite3::setBackupPacing(int32_t pagesPerStep, int32_t stepInterval)
+{
+    _backupPagesPerStep = pagesPerStep > 0 ? pagesPerStep : -1;
+    _backupStepInterval = stepInterval >= 0 ? stepInterval : 0;
+}
+
+void SQLite3::setVolatileDatabase(std::string databaseFilename, std::string synchronousMode, std::string backupFilename)
+{
+    std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
+    if(_database)
+    {
+        GD::out.printWarning("Warning: The volatile database can't be changed while the database is open.");
+        return;
+    }
+    _volatileDatabaseFilename = std::move(databaseFilename);
+    _volatileSynchronousMode = std::move(synchronousMode);
+    _volatileBackupFilename = std::move(backupFilename);
+}
+
+void SQLite3::rotateBackups(const std::string& backupFilename)
 {
+    if(GD::bl->settings.databaseMaxBackups() > 1)
+    {
+        if(GD::bl->io.fileExists(_backupPath + backupFilename + std::to_string(GD::bl->settings.databaseMaxBackups() - 1)))
+        {
+            if(!GD::bl->io.deleteFile(_backupPath + backupFilename + std::to_string(GD::bl->settings.databaseMaxBackups() - 1)))
+            {
+                GD::out.printError("Error: Cannot delete file: " + _backupPath + backupFilename + std::to_string(GD::bl->settings.databaseMaxBackups() - 1));
+            }
+        }
+        for(int32_t i = GD::bl->settings.databaseMaxBackups() - 2; i >= 0; i--)
+        {
+            if(GD::bl->io.fileExists(_backupPath + backupFilename + std::to_string(i)))
+            {
+                if(!GD::bl->io.moveFile(_backupPath + backupFilename + std::to_string(i), _backupPath + backupFilename + std::to_string(i + 1)))
+                {
+                    GD::out.printError("Error: Cannot move file: " + _backupPath + backupFilename + std::to_string(i));
+                }
+            }
+        }
+    }
+}
+
+void SQLite3::onlineBackup(const std::string& schema, const std::string& backupFilename)
+{
+    std::unique_lock<std::mutex> backupGuard(_backupMutex, std::try_to_lock);
+    if(!backupGuard.owns_lock())
+    {
+        GD::out.printInfo("Info: Not backing up database, because a backup is already running.");
+        return;
+    }
+
+    sqlite3* backupDatabase = nullptr;
+    std::string tempFilename = _backupPath + backupFilename + ".tmp";
     try
     {
-        if(_databasePath.empty() || _databaseFilename.empty())
+        if(_backupPath.empty() || backupFilename.empty())
         {
-            GD::out.printError("Error: Can't backup database: _databasePath or _databaseFilename is empty.");
+            GD::out.printError("Error: Can't backup database: _backupPath or backupFilename is empty.");
             return;
         }
-        std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
-        closeDatabase(false);
-        if(GD::bl->io.fileExists(_databasePath + _databaseFilename))
+        if(GD::bl->settings.databaseMaxBackups() == 0) return;
+
+        GD::out.printInfo("Info: Backing up database (" + schema + ")...");
+        int64_t startTime = BaseLib::HelperFunctions::getTime();
+        if(GD::bl->io.fileExists(tempFilename)) GD::bl->io.deleteFile(tempFilename);
+        int32_t result = sqlite3_open(tempFilename.c_str(), &backupDatabase);
+        if(result || !backupDatabase)
+        {
+            GD::out.printError("Error: Can't open backup file " + tempFilename + ": " + std::string(sqlite3_errmsg(backupDatabase)));
+            if(backupDatabase) sqlite3_close(backupDatabase);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
+            if(!_database)
+            {
+                sqlite3_close(backupDatabase);
+                return;
+            }
+            _backup = sqlite3_backup_init(backupDatabase, "main", _database, schema.c_str());
+            if(!_backup)
+            {
+                GD::out.printError("Error: Can't start backup: " + std::string(sqlite3_errmsg(backupDatabase)));
+                sqlite3_close(backupDatabase);
+                GD::bl->io.deleteFile(tempFilename);
+                return;
+            }
+        }
+
+        int64_t deferStartTime = 0;
+        uint32_t skippedSteps = 0;
+        uint32_t forcedSteps = 0;
+        while(true)
+        {
+            {
+                std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
+                if(!_backup) //Aborted by closeDatabase()
+                {
+                    result = SQLITE_ABORT;
+                    break;
+                }
+                //Don't copy pages while a transaction of the main connection is open, as the backup would need to restart.
+                //Transactions that follow each other without a gap would defer the backup forever, so the deferral is
+                //limited.
+                if(_transactionActive)
+                {
+                    int64_t time = BaseLib::HelperFunctions::getTime();
+                    if(deferStartTime == 0) deferStartTime = time;
+                    if(time - deferStartTime < _backupMaxDeferTime)
+                    {
+                        skippedSteps++;
+                        result = SQLITE_BUSY;
+                    }
+                    else
+                    {
+                        forcedSteps++;
+                        deferStartTime = 0;
+                        result = sqlite3_backup_step(_backup, _backupPagesPerStep);
+                    }
+                }
+                else
+                {
+                    deferStartTime = 0;
+                    result = sqlite3_backup_step(_backup, _backupPagesPerStep);
+                }
+                if(result != SQLITE_OK && result != SQLITE_BUSY && result != SQLITE_LOCKED)
+                {
+                    int32_t finishResult = sqlite3_backup_finish(_backup);
+                    _backup = nullptr;
+                    if(result == SQLITE_DONE) result = finishResult;
+                    break;
+                }
+            }
+            if(_backupStepInterval > 0) std::this_thread::sleep_for(std::chrono::milliseconds(_backupStepInterval));
+        }
+        sqlite3_close(backupDatabase);
+        backupDatabase = nullptr;
+
+        if(result != SQLITE_OK)
+        {
+            GD::out.printError("Error: Backup of database failed after " + std::to_string(BaseLib::HelperFunctions::getTime() - startTime) + "ms and " + std::to_string(skippedSteps) + " skipped steps (Error-no.: " + std::to_string(result) + ").");
+            GD::bl->io.deleteFile(tempFilename);
+            return;
+        }
+
+        if(!checkIntegrity(tempFilename))
+        {
+            GD::out.printCritical("Critical: Integrity check on database backup failed. Keeping old backups.");
+            GD::bl->io.deleteFile(tempFilename);
+            return;
+        }
+
+        rotateBackups(backupFilename);
+        if(!GD::bl->io.moveFile(tempFilename, _backupPath + backupFilename + '0'))
         {
-            if(!checkIntegrity(_databasePath + _databaseFilename))
+            GD::out.printError("Error: Cannot move file: " + tempFilename);
+            return;
+        }
+        GD::out.printInfo("Info: Backup of database (" + schema + ") completed in " + std::to_string(BaseLib::HelperFunctions::getTime() - startTime) + "ms. Steps skipped because of open transactions: " + std::to_string(skippedSteps) + ", steps executed after waiting for " + std::to_string(_backupMaxDeferTime) + "ms: " + std::to_string(forcedSteps));
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    if(backupDatabase) sqlite3_close(backupDatabase);
+}
+
+bool SQLite3::checkDatabaseFile(const std::string& databaseFilename, const std::string& backupFilename)
+{
+    try
+    {
+        if(GD::bl->io.fileExists(_databasePath + databaseFilename))
+        {
+            if(!checkIntegrity(_databasePath + databaseFilename))
             {
-                GD::out.printCritical("Critical: Integrity check on database failed.");
-                if(!_backupPath.empty() && !_backupFilename.empty())
+                GD::out.printCritical("Critical: Integrity check on database " + databaseFilename + " failed.");
+                if(!_backupPath.empty() && !backupFilename.empty())
                 {
-                    GD::out.printCritical("Critical: Backing up corrupted database file to: " + _backupPath + _databaseFilename + ".broken");
-                    GD::bl->io.copyFile(_databasePath + _databaseFilename, _backupPath + _databaseFilename + ".broken");
+                    GD::out.printCritical("Critical: Backing up corrupted database file to: " + _backupPath + databaseFilename + ".broken");
+                    GD::bl->io.copyFile(_databasePath + databaseFilename, _backupPath + databaseFilename + ".broken");
                     bool restored = false;
                     for(int32_t i = 0; i <= 10000; i++)
                     {
-                        if(GD::bl->io.fileExists(_backupPath + _backupFilename + std::to_string(i)) && checkIntegrity(_backupPath + _backupFilename + std::to_string(i)))
+                        if(GD::bl->io.fileExists(_backupPath + backupFilename + std::to_string(i)) && checkIntegrity(_backupPath + backupFilename + std::to_string(i)))
                         {
-                            GD::out.printCritical("Critical: Restoring database file: " + _backupPath + _backupFilename + std::to_string(i));
-                            if(GD::bl->io.copyFile(_backupPath + _backupFilename + std::to_string(i), _databasePath + _databaseFilename))
+                            GD::out.printCritical("Critical: Restoring database file: " + _backupPath + backupFilename + std::to_string(i));
+                            if(GD::bl->io.copyFile(_backupPath + backupFilename + std::to_string(i), _databasePath + databaseFilename))
                             {
                                 restored = true;
                                 break;
@@ -112,59 +280,40 @@ void SQLite3::hotBackup()
                     if(!restored)
                     {
                         GD::out.printCritical("Critical: Could not restore database.");
-                        return;
+                        return false;
                     }
                 }
-                else return;
+                else return false;
             }
             else
             {
-                if(!_backupPath.empty() && !_backupFilename.empty())
+                if(!_backupPath.empty() && !backupFilename.empty())
                 {
-                    GD::out.printInfo("Info: Backing up database...");
-                    if(GD::bl->settings.databaseMaxBackups() > 1)
-                    {
-                        if(GD::bl->io.fileExists(_backupPath + _backupFilename + std::to_string(GD::bl->settings.databaseMaxBackups() - 1)))
-                        {
-                            if(!GD::bl->io.deleteFile(_backupPath + _backupFilename + std::to_string(GD::bl->settings.databaseMaxBackups() - 1)))
-                            {
-                                GD::out.printError("Error: Cannot delete file: " + _backupPath + _backupFilename + std::to_string(GD::bl->settings.databaseMaxBackups() - 1));
-                            }
-                        }
-                        for(int32_t i = GD::bl->settings.databaseMaxBackups() - 2; i >= 0; i--)
-                        {
-                            if(GD::bl->io.fileExists(_backupPath + _backupFilename + std::to_string(i)))
-                            {
-                                if(!GD::bl->io.moveFile(_backupPath + _backupFilename + std::to_string(i), _backupPath + _backupFilename + std::to_string(i + 1)))
-                                {
-                                    GD::out.printError("Error: Cannot move file: " + _backupPath + _backupFilename + std::to_string(i));
-                                }
-                            }
-                        }
-                    }
+                    GD::out.printInfo("Info: Backing up database " + databaseFilename + "...");
+                    rotateBackups(backupFilename);
                     if(GD::bl->settings.databaseMaxBackups() > 0)
                     {
-                        if(!GD::bl->io.copyFile(_databasePath + _databaseFilename, _backupPath + _backupFilename + '0'))
+                        if(!GD::bl->io.copyFile(_databasePath + databaseFilename, _backupPath + backupFilename + '0'))
                         {
-                            GD::out.printError("Error: Cannot copy file: " + _backupPath + _backupFilename + '0');
+                            GD::out.printError("Error: Cannot copy file: " + _backupPath + backupFilename + '0');
                         }
                     }
                 }
-                else GD::out.printError("Error: Can't backup database: _backupPath or _backupFilename is empty.");
+                else GD::out.printDebug("Debug: Not backing up " + databaseFilename + ", because no backup path is set.");
             }
         }
         else
         {
-            GD::out.printWarning("Warning: No database found. Trying to restore backup.");
-            if(!_backupPath.empty() && !_backupFilename.empty())
+            GD::out.printWarning("Warning: Database " + databaseFilename + " not found. Trying to restore backup.");
+            if(!_backupPath.empty() && !backupFilename.empty())
             {
                 bool restored = false;
                 for(int32_t i = 0; i <= 10000; i++)
                 {
-                    if(GD::bl->io.fileExists(_backupPath + _backupFilename + std::to_string(i)) && checkIntegrity(_backupPath + _backupFilename + std::to_string(i)))
+                    if(GD::bl->io.fileExists(_backupPath + backupFilename + std::to_string(i)) && checkIntegrity(_backupPath + backupFilename + std::to_string(i)))
                     {
-                        GD::out.printWarning("Warning: Restoring database file: " + _backupPath + _backupFilename + std::to_string(i));
-                        if(GD::bl->io.copyFile(_backupPath + _backupFilename + std::to_string(i), _databasePath + _databaseFilename))
+                        GD::out.printWarning("Warning: Restoring database file: " + _backupPath + backupFilename + std::to_string(i));
+                        if(GD::bl->io.copyFile(_backupPath + backupFilename + std::to_string(i), _databasePath + databaseFilename))
                         {
                             restored = true;
                             break;
@@ -175,6 +324,47 @@ void SQLite3::hotBackup()
                 else GD::out.printWarning("Warning: Database could not be restored. Creating new database.");
             }
         }
+        return true;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return false;
+}
+
+void SQLite3::hotBackup()
+{
+    try
+    {
+        if(_databasePath.empty() || _databaseFilename.empty())
+        {
+            GD::out.printError("Error: Can't backup database: _databasePath or _databaseFilename is empty.");
+            return;
+        }
+        if(isOpen())
+        {
+            onlineBackup("main", _backupFilename);
+            if(hasVolatileDatabase() && !_volatileBackupFilename.empty()) onlineBackup("volatile", _volatileBackupFilename);
+            return;
+        }
+        std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
+        closeDatabase(false);
+        if(!checkDatabaseFile(_databaseFilename, _backupFilename)) return;
+        if(hasVolatileDatabase() && !checkDatabaseFile(_volatileDatabaseFilename, _volatileBackupFilename))
+        {
+            //The volatile data is not worth refusing to start, so start with an empty file.
+            GD::out.printCritical("Critical: Moving corrupted database file to " + _databasePath + _volatileDatabaseFilename + ".broken and creating a new one.");
+            if(!GD::bl->io.moveFile(_databasePath + _volatileDatabaseFilename, _databasePath + _volatileDatabaseFilename + ".broken"))
+            {
+                GD::out.printCritical("Critical: Cannot move file: " + _databasePath + _volatileDatabaseFilename);
+                return;
+            }
+        }
         openDatabase(false);
     }
     catch(const std::exception& ex)
@@ -243,6 +433,61 @@ bool SQLite3::checkIntegrity(std::string databasePath)
     return true;
 }
 
+void SQLite3::setSynchronousMode(std::string mode)
+{
+    try
+    {
+        std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
+        _synchronousMode = mode;
+        if(!_database) return;
+        std::string command = "PRAGMA synchronous=" + (_synchronousMode.empty() ? std::string(_databaseSynchronous ? "FULL" : "OFF") : _synchronousMode);
+        char* errorMessage = nullptr;
+        sqlite3_exec(_database, command.c_str(), 0, 0, &errorMessage);
+        if(errorMessage)
+        {
+            GD::out.printError("Can't execute \"" + command + "\": " + std::string(errorMessage));
+            sqlite3_free(errorMessage);
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+bool SQLite3::attachVolatileDatabase(sqlite3* database)
+{
+    try
+    {
+        if(!hasVolatileDatabase()) return true;
+        char* command = sqlite3_mprintf("ATTACH DATABASE %Q AS volatile", (_databasePath + _volatileDatabaseFilename).c_str());
+        if(!command) return false;
+        char* errorMessage = nullptr;
+        sqlite3_exec(database, command, 0, 0, &errorMessage);
+        sqlite3_free(command);
+        if(errorMessage)
+        {
+            GD::out.printCritical("Critical: Can't attach database " + _volatileDatabaseFilename + ": " + std::string(errorMessage));
+            sqlite3_free(errorMessage);
+            return false;
+        }
+        return true;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return false;
+}
+
 void SQLite3::openDatabase(bool lockMutex)
 {
     try
@@ -260,8 +505,23 @@ void SQLite3::openDatabase(bool lockMutex)
             return;
         }
         sqlite3_extended_result_codes(_database, 1);
+        if(!attachVolatileDatabase(_database))
+        {
+            GD::out.printCritical("Critical: Storing all tables in " + _databaseFilename + ".");
+            _volatileDatabaseFilename.clear();
+        }
 
-        if(!_databaseSynchronous)
+        if(!_synchronousMode.empty())
+        {
+            std::string command = "PRAGMA synchronous=" + _synchronousMode;
+            sqlite3_exec(_database, command.c_str(), 0, 0, &errorMessage);
+            if(errorMessage)
+            {
+                GD::out.printError("Can't execute \"" + command + "\": " + std::string(errorMessage));
+                sqlite3_free(errorMessage);
+            }
+        }
+        else if(!_databaseSynchronous)
         {
             sqlite3_exec(_database, "PRAGMA synchronous=OFF", 0, 0, &errorMessage);
             if(errorMessage)
@@ -271,6 +531,20 @@ void SQLite3::openDatabase(bool lockMutex)
             }
         }
 
+        if(hasVolatileDatabase())
+        {
+            //Attached databases don't inherit the synchronous mode of the main database.
+            std::string synchronousMode = _volatileSynchronousMode;
+            if(synchronousMode.empty()) synchronousMode = _synchronousMode.empty() ? std::string(_databaseSynchronous ? "FULL" : "OFF") : _synchronousMode;
+            std::string command = "PRAGMA volatile.synchronous=" + synchronousMode;
+            sqlite3_exec(_database, command.c_str(), 0, 0, &errorMessage);
+            if(errorMessage)
+            {
+                GD::out.printError("Can't execute \"" + command + "\": " + std::string(errorMessage));
+                sqlite3_free(errorMessage);
+            }
+        }
+
         //Reset to default journal mode, because WAL stays active.
         //Also I'm not sure if VACUUM works with journal_mode=WAL.
         sqlite3_exec(_database, "PRAGMA journal_mode=DELETE", 0, 0, &errorMessage);
@@ -287,6 +561,16 @@ void SQLite3::openDatabase(bool lockMutex)
             sqlite3_free(errorMessage);
         }
 
+        if(hasVolatileDatabase())
+        {
+            sqlite3_exec(_database, "VACUUM volatile", 0, 0, &errorMessage);
+            if(errorMessage)
+            {
+                GD::out.printWarning("Warning: Can't execute \"VACUUM volatile\": " + std::string(errorMessage));
+                sqlite3_free(errorMessage);
+            }
+        }
+
         if(_databaseMemoryJournal)
         {
             sqlite3_exec(_database, "PRAGMA journal_mode=MEMORY", 0, 0, &errorMessage);
@@ -306,6 +590,8 @@ void SQLite3::openDatabase(bool lockMutex)
                 sqlite3_free(errorMessage);
             }
         }
+
+        openReadConnections();
     }
     catch(const std::exception& ex)
     {
@@ -325,6 +611,13 @@ void SQLite3::closeDatabase(bool lockMutex)
         std::unique_lock<std::mutex> databaseGuard(_databaseMutex, std::defer_lock);
         if(lockMutex) databaseGuard.lock();
         GD::out.printInfo("Closing database...");
+        if(_backup)
+        {
+            sqlite3_backup_finish(_backup);
+            _backup = nullptr;
+        }
+        closeReadConnections();
+        clearStatementCache(_statementCache);
         char* errorMessage = nullptr;
         sqlite3_exec(_database, "COMMIT", 0, 0, &errorMessage); //Release all savepoints
         if(errorMessage)
@@ -347,6 +640,8 @@ void SQLite3::closeDatabase(bool lockMutex)
         }
         sqlite3_close(_database);
         _database = nullptr;
+        _transactionActive = false;
+        _groupTransactionOpen = false;
     }
     catch(const std::exception& ex)
     {
@@ -362,50 +657,325 @@ void SQLite3::getDataRows(sqlite3_stmt* statement, std::shared_ptr<BaseLib::Data
 {
     int32_t result;
     int32_t row = 0;
+    Row currentRow(statement);
     while((result = sqlite3_step(statement)) == SQLITE_ROW)
     {
+        auto& dataRow = (*dataRows)[row];
         for(int32_t i = 0; i < sqlite3_column_count(statement); i++)
         {
-            std::shared_ptr<BaseLib::Database::DataColumn> col(new BaseLib::Database::DataColumn());
-            col->index = i;
-            int32_t columnType = sqlite3_column_type(statement, i);
-            if(columnType == SQLITE_INTEGER)
-            {
-                col->dataType = BaseLib::Database::DataColumn::DataType::Enum::INTEGER;
-                col->intValue = sqlite3_column_int64(statement, i);
-            }
-            else if(columnType == SQLITE_FLOAT)
-            {
-                col->dataType = BaseLib::Database::DataColumn::DataType::Enum::FLOAT;
-                col->floatValue = sqlite3_column_double(statement, i);
-            }
-            else if(columnType == SQLITE_BLOB)
-            {
-                col->dataType = BaseLib::Database::DataColumn::DataType::Enum::BLOB;
-                char* binaryData = (char*)sqlite3_column_blob(statement, i);
-                int32_t size = sqlite3_column_bytes(statement, i);
-                if(size > 0) col->binaryValue.reset(new std::vector<char>(binaryData, binaryData + size));
-            }
-            else if(columnType == SQLITE_NULL)
+            dataRow[i] = currentRow.getDataColumn(i);
+        }
+        row++;
+    }
+    if(result != SQLITE_DONE)
+    {
+        throw BaseLib::Exception("Can't execute command (Error-no.: " + std::to_string(result) + "): " + std::string(sqlite3_errmsg(sqlite3_db_handle(statement))));
+    }
+}
+
+std::string SQLite3::Row::getText(int32_t column)
+{
+    const char* text = (const char*)sqlite3_column_text(_statement, column);
+    if(!text) return "";
+    return std::string(text, (size_t)sqlite3_column_bytes(_statement, column));
+}
+
+void SQLite3::Row::getBlob(int32_t column, std::vector<char>& buffer)
+{
+    const char* binaryData = (const char*)sqlite3_column_blob(_statement, column);
+    int32_t size = sqlite3_column_bytes(_statement, column);
+    if(!binaryData || size <= 0) buffer.clear();
+    else buffer.assign(binaryData, binaryData + size);
+}
+
+std::shared_ptr<BaseLib::Database::DataColumn> SQLite3::Row::getDataColumn(int32_t column)
+{
+    auto col = std::make_shared<BaseLib::Database::DataColumn>();
+    col->index = column;
+    int32_t columnType = sqlite3_column_type(_statement, column);
+    if(columnType == SQLITE_INTEGER)
+    {
+        col->dataType = BaseLib::Database::DataColumn::DataType::Enum::INTEGER;
+        col->intValue = sqlite3_column_int64(_statement, column);
+    }
+    else if(columnType == SQLITE_FLOAT)
+    {
+        col->dataType = BaseLib::Database::DataColumn::DataType::Enum::FLOAT;
+        col->floatValue = sqlite3_column_double(_statement, column);
+    }
+    else if(columnType == SQLITE_BLOB)
+    {
+        col->dataType = BaseLib::Database::DataColumn::DataType::Enum::BLOB;
+        char* binaryData = (char*)sqlite3_column_blob(_statement, column);
+        int32_t size = sqlite3_column_bytes(_statement, column);
+        if(size > 0) col->binaryValue.reset(new std::vector<char>(binaryData, binaryData + size));
+    }
+    else if(columnType == SQLITE_NULL)
+    {
+        col->dataType = BaseLib::Database::DataColumn::DataType::Enum::NODATA;
+    }
+    else if(columnType == SQLITE_TEXT) //or SQLITE3_TEXT. As we are not using SQLite version 2 it doesn't matter
+    {
+        col->dataType = BaseLib::Database::DataColumn::DataType::Enum::TEXT;
+        col->textValue = std::string((const char*)sqlite3_column_text(_statement, column));
+    }
+    return col;
+}
+
+void SQLite3::stepRows(sqlite3_stmt* statement, const RowCallback& callback)
+{
+    int32_t result;
+    Row row(statement);
+    while((result = sqlite3_step(statement)) == SQLITE_ROW)
+    {
+        if(!callback(row)) return;
+    }
+    if(result != SQLITE_DONE)
+    {
+        throw BaseLib::Exception("Can't execute command (Error-no.: " + std::to_string(result) + "): " + std::string(sqlite3_errmsg(sqlite3_db_handle(statement))));
+    }
+}
+
+bool SQLite3::startsWithKeyword(const std::string& command, const std::string& keyword)
+{
+    size_t position = command.find_first_not_of(" \t\r\n");
+    if(position == std::string::npos || command.size() - position < keyword.size()) return false;
+    for(size_t i = 0; i < keyword.size(); i++, position++)
+    {
+        if(std::toupper((unsigned char)command[position]) != keyword[i]) return false;
+    }
+    return position == command.size() || !(std::isalnum((unsigned char)command[position]) || command[position] == '_');
+}
+
+bool SQLite3::isSchemaCommand(const std::string& command)
+{
+    return startsWithKeyword(command, "CREATE") || startsWithKeyword(command, "DROP") || startsWithKeyword(command, "ALTER") || startsWithKeyword(command, "VACUUM") || startsWithKeyword(command, "PRAGMA");
+}
+
+sqlite3_stmt* SQLite3::prepareStatement(sqlite3* database, StatementCache& statementCache, const std::string& command, bool& cached)
+{
+    cached = false;
+    if(!database) return nullptr;
+
+    auto statementIterator = statementCache.statements.find(command);
+    if(statementIterator != statementCache.statements.end())
+    {
+        _statementCacheHits++;
+        statementCache.lru.splice(statementCache.lru.begin(), statementCache.lru, statementIterator->second.lruIterator);
+        cached = true;
+        return statementIterator->second.statement;
+    }
+
+    _statementCacheMisses++;
+    sqlite3_stmt* statement = nullptr;
+    int32_t result = sqlite3_prepare_v2(database, command.c_str(), -1, &statement, nullptr);
+    if(result)
+    {
+        if(statement) sqlite3_finalize(statement);
+        return nullptr;
+    }
+
+    //Commands without parameters usually have their values embedded, so they are rarely executed twice and would only
+    //push reusable statements out of the cache.
+    if(isSchemaCommand(command) || _statementCacheMaxSize == 0 || sqlite3_bind_parameter_count(statement) == 0) return statement;
+
+    while(statementCache.statements.size() >= _statementCacheMaxSize && !statementCache.lru.empty())
+    {
+        auto oldestIterator = statementCache.statements.find(statementCache.lru.back());
+        if(oldestIterator != statementCache.statements.end())
+        {
+            sqlite3_finalize(oldestIterator->second.statement);
+            statementCache.statements.erase(oldestIterator);
+        }
+        statementCache.lru.pop_back();
+    }
+
+    statementCache.lru.push_front(command);
+    CachedStatement cachedStatement;
+    cachedStatement.statement = statement;
+    cachedStatement.lruIterator = statementCache.lru.begin();
+    statementCache.statements.emplace(command, cachedStatement);
+    cached = true;
+    return statement;
+}
+
+int32_t SQLite3::releaseStatement(sqlite3_stmt* statement, bool cached)
+{
+    if(!statement) return SQLITE_OK;
+    if(!cached) return sqlite3_finalize(statement);
+    //Reset immediately, so read transactions are not kept open by idle statements.
+    int32_t result = sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
+    return result;
+}
+
+void SQLite3::clearStatementCache(StatementCache& statementCache)
+{
+    for(auto& cachedStatement : statementCache.statements)
+    {
+        sqlite3_finalize(cachedStatement.second.statement);
+    }
+    statementCache.statements.clear();
+    statementCache.lru.clear();
+}
+
+size_t SQLite3::statementCacheSize()
+{
+    size_t size = 0;
+    {
+        std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
+        size = _statementCache.statements.size();
+    }
+    for(auto& readConnection : _readConnections)
+    {
+        std::lock_guard<std::mutex> connectionGuard(readConnection->mutex);
+        size += readConnection->statementCache.statements.size();
+    }
+    return size;
+}
+
+void SQLite3::setReadConnectionCount(uint32_t count)
+{
+    std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
+    if(_database)
+    {
+        GD::out.printWarning("Warning: The number of database read connections can't be changed while the database is open.");
+        return;
+    }
+    _readConnections.clear();
+    _readConnections.reserve(count);
+    for(uint32_t i = 0; i < count; i++)
+    {
+        _readConnections.emplace_back(new ReadConnection());
+    }
+}
+
+void SQLite3::openReadConnections()
+{
+    try
+    {
+        if(_readConnections.empty()) return;
+        if(!_databaseWALJournal)
+        {
+            GD::out.printInfo("Info: Not using database read connections, because WAL journal is disabled.");
+            return;
+        }
+        std::string fullDatabasePath = _databasePath + _databaseFilename;
+        for(auto& readConnection : _readConnections)
+        {
+            std::lock_guard<std::mutex> connectionGuard(readConnection->mutex);
+            if(readConnection->database) continue;
+            //The connection is protected by its own mutex, so SQLite's mutex is not needed.
+            int result = sqlite3_open_v2(fullDatabasePath.c_str(), &readConnection->database, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr);
+            if(result || !readConnection->database)
             {
-                col->dataType = BaseLib::Database::DataColumn::DataType::Enum::NODATA;
+                GD::out.printError("Error: Can't open database read connection: " + std::string(sqlite3_errmsg(readConnection->database)));
+                if(readConnection->database) sqlite3_close(readConnection->database);
+                readConnection->database = nullptr;
+                continue;
             }
-            else if(columnType == SQLITE_TEXT) //or SQLITE3_TEXT. As we are not using SQLite version 2 it doesn't matter
+            sqlite3_extended_result_codes(readConnection->database, 1);
+            sqlite3_busy_timeout(readConnection->database, 1000);
+            if(!attachVolatileDatabase(readConnection->database))
             {
-                col->dataType = BaseLib::Database::DataColumn::DataType::Enum::TEXT;
-                col->textValue = std::string((const char*)sqlite3_column_text(statement, i));
+                //Without the volatile tables the connection would return wrong results.
+                sqlite3_close(readConnection->database);
+                readConnection->database = nullptr;
             }
-            if(i == 0) dataRows->insert(std::pair<uint32_t, std::map<uint32_t, std::shared_ptr<BaseLib::Database::DataColumn>>>(row, std::map<uint32_t, std::shared_ptr<BaseLib::Database::DataColumn>>()));
-            dataRows->at(row)[i] = col;
         }
-        row++;
     }
-    if(result != SQLITE_DONE)
+    catch(const std::exception& ex)
     {
-        throw BaseLib::Exception("Can't execute command (Error-no.: " + std::to_string(result) + "): " + std::string(sqlite3_errmsg(_database)));
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
 }
 
+void SQLite3::closeReadConnections()
+{
+    try
+    {
+        for(auto& readConnection : _readConnections)
+        {
+            std::lock_guard<std::mutex> connectionGuard(readConnection->mutex);
+            if(!readConnection->database) continue;
+            clearStatementCache(readConnection->statementCache);
+            sqlite3_close(readConnection->database);
+            readConnection->database = nullptr;
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void SQLite3::lockDatabaseMutex(std::unique_lock<std::mutex>& databaseGuard)
+{
+    if(databaseGuard.try_lock()) return;
+    _databaseLockWaits++;
+    int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
+    databaseGuard.lock();
+    _databaseLockWaitTime += BaseLib::HelperFunctions::getTimeMicroseconds() - startTime;
+}
+
+bool SQLite3::executeReadCommand(const std::string& command, BaseLib::Database::DataRow& dataToEscape, const std::function<void(sqlite3_stmt* statement)>& processRows)
+{
+    if(_readConnections.empty() || (_transactionActive && !_groupTransactionOpen) || !startsWithKeyword(command, "SELECT")) return false;
+
+    ReadConnection* readConnection = nullptr;
+    std::unique_lock<std::mutex> connectionGuard;
+    for(auto& connection : _readConnections)
+    {
+        std::unique_lock<std::mutex> guard(connection->mutex, std::try_to_lock);
+        if(guard.owns_lock())
+        {
+            readConnection = connection.get();
+            connectionGuard = std::move(guard);
+            break;
+        }
+    }
+    if(!readConnection)
+    {
+        _readPoolWaits++;
+        int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
+        readConnection = _readConnections.at(_nextReadConnection++ % _readConnections.size()).get();
+        connectionGuard = std::unique_lock<std::mutex>(readConnection->mutex);
+        _readPoolWaitTime += BaseLib::HelperFunctions::getTimeMicroseconds() - startTime;
+    }
+    if(!readConnection->database) return false;
+
+    _readPoolReads++;
+    bool cached = false;
+    sqlite3_stmt* statement = prepareStatement(readConnection->database, readConnection->statementCache, command, cached);
+    if(!statement)
+    {
+        GD::out.printError("Can't execute command \"" + command + "\": " + std::string(sqlite3_errmsg(readConnection->database)));
+        return true;
+    }
+    try
+    {
+        bindData(statement, dataToEscape);
+        processRows(statement);
+    }
+    catch(const std::exception& ex)
+    {
+        releaseStatement(statement, cached);
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+        return true;
+    }
+    int32_t result = releaseStatement(statement, cached);
+    if(result) GD::out.printError("Can't execute command \"" + command + "\" (Error-no.: " + std::to_string(result) + "): " + std::string(sqlite3_errmsg(readConnection->database)));
+    return true;
+}
+
 void SQLite3::bindData(sqlite3_stmt* statement, BaseLib::Database::DataRow& dataToEscape)
 {
     //There is no try/catch block on purpose!
@@ -434,46 +1004,47 @@ void SQLite3::bindData(sqlite3_stmt* statement, BaseLib::Database::DataRow& data
         }
         if(result)
         {
-            throw(BaseLib::Exception(std::string(sqlite3_errmsg(_database))));
+            throw(BaseLib::Exception(std::string(sqlite3_errmsg(sqlite3_db_handle(statement)))));
         }
         index++;
     });
 }
 
 uint32_t SQLite3::executeWriteCommand(std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>> command)
+{
+    if(!command) return 0;
+    return executeWrite(command->first, command->second, false);
+}
+
+uint32_t SQLite3::executeWriteCommand(std::string command, BaseLib::Database::DataRow& dataToEscape, int32_t* changes)
+{
+    return executeWrite(command, dataToEscape, false, changes);
+}
+
+uint32_t SQLite3::executeGroupedWriteCommand(std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>> command, int32_t* changes)
+{
+    if(!command) return 0;
+    return executeWrite(command->first, command->second, true, changes);
+}
+
+void SQLite3::beginGroupTransaction()
 {
     try
     {
-        if(!command) return 0;
-        std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
-        if(!_database)
-        {
-            GD::out.printError("Error: Could not write to database. No database handle.");
-            return 0;
-        }
-        sqlite3_stmt* statement = nullptr;
-        int32_t result = sqlite3_prepare_v2(_database, command->first.c_str(), -1, &statement, NULL);
-        if(result)
-        {
-            GD::out.printError("Can't execute command \"" + command->first + "\": " + std::string(sqlite3_errmsg(_database)));
-            return 0;
-        }
-        if(!command->second.empty()) bindData(statement, command->second);
-        result = sqlite3_step(statement);
-        if(result != SQLITE_DONE)
-        {
-            GD::out.printError("Can't execute command: " + std::string(sqlite3_errmsg(_database)));
-            return 0;
-        }
-        sqlite3_clear_bindings(statement);
-        result = sqlite3_finalize(statement);
-        if(result)
+        std::unique_lock<std::mutex> databaseGuard(_databaseMutex, std::defer_lock);
+        lockDatabaseMutex(databaseGuard);
+        if(!_database || _groupTransactionOpen) return;
+        //Set before BEGIN, so reads never see an open transaction without the flag and switch to the main connection.
+        _groupTransactionOpen = true;
+        char* errorMessage = nullptr;
+        sqlite3_exec(_database, "BEGIN", nullptr, nullptr, &errorMessage);
+        if(errorMessage)
         {
-            GD::out.printError("Can't execute command \"" + command->first + "\": " + std::string(sqlite3_errmsg(_database)));
-            return 0;
+            GD::out.printError("Error: Can't execute \"BEGIN\": " + std::string(errorMessage));
+            sqlite3_free(errorMessage);
+            _groupTransactionOpen = false;
         }
-        uint32_t rowID = sqlite3_last_insert_rowid(_database);
-        return rowID;
+        _transactionActive = !sqlite3_get_autocommit(_database);
     }
     catch(const std::exception& ex)
     {
@@ -483,40 +1054,92 @@ uint32_t SQLite3::executeWriteCommand(std::shared_ptr<std::pair<std::string, Bas
     {
         GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
-    return 0;
 }
 
-uint32_t SQLite3::executeWriteCommand(std::string command, BaseLib::Database::DataRow& dataToEscape)
+bool SQLite3::commitGroupTransaction()
 {
     try
     {
-        std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
+        std::unique_lock<std::mutex> databaseGuard(_databaseMutex, std::defer_lock);
+        lockDatabaseMutex(databaseGuard);
+        return commitGroupTransactionInternal();
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return false;
+}
+
+bool SQLite3::commitGroupTransactionInternal()
+{
+    //There is no try/catch block on purpose!
+    if(!_groupTransactionOpen || !_database) return false;
+    char* errorMessage = nullptr;
+    sqlite3_exec(_database, "COMMIT", nullptr, nullptr, &errorMessage);
+    if(errorMessage)
+    {
+        GD::out.printError("Error: Can't execute \"COMMIT\": " + std::string(errorMessage));
+        sqlite3_free(errorMessage);
+    }
+    _transactionActive = !sqlite3_get_autocommit(_database);
+    _groupTransactionOpen = false;
+    return true;
+}
+
+uint32_t SQLite3::executeWrite(const std::string& command, BaseLib::Database::DataRow& dataToEscape, bool grouped, int32_t* changes)
+{
+    if(changes) *changes = -1;
+    try
+    {
+        std::unique_lock<std::mutex> databaseGuard(_databaseMutex, std::defer_lock);
+        lockDatabaseMutex(databaseGuard);
         if(!_database)
         {
             GD::out.printError("Error: Could not write to database. No database handle.");
             return 0;
         }
-        sqlite3_stmt* statement = nullptr;
-        int32_t result = sqlite3_prepare_v2(_database, command.c_str(), -1, &statement, NULL);
-        if(result)
+        if(!grouped) commitGroupTransactionInternal();
+        bool cached = false;
+        sqlite3_stmt* statement = prepareStatement(_database, _statementCache, command, cached);
+        if(!statement)
         {
             GD::out.printError("Can't execute command \"" + command + "\": " + std::string(sqlite3_errmsg(_database)));
             return 0;
         }
-        if(!dataToEscape.empty()) bindData(statement, dataToEscape);
-        result = sqlite3_step(statement);
+        int32_t result = SQLITE_OK;
+        try
+        {
+            if(!dataToEscape.empty()) bindData(statement, dataToEscape);
+            result = sqlite3_step(statement);
+        }
+        catch(...)
+        {
+            releaseStatement(statement, cached);
+            _transactionActive = !sqlite3_get_autocommit(_database);
+            throw;
+        }
         if(result != SQLITE_DONE)
         {
             GD::out.printError("Can't execute command \"" + command + "\": " + std::string(sqlite3_errmsg(_database)));
+            releaseStatement(statement, cached);
+            _transactionActive = !sqlite3_get_autocommit(_database);
             return 0;
         }
-        sqlite3_clear_bindings(statement);
-        result = sqlite3_finalize(statement);
+        int32_t changedRows = sqlite3_changes(_database);
+        result = releaseStatement(statement, cached);
+        _transactionActive = !sqlite3_get_autocommit(_database);
         if(result)
         {
             GD::out.printError("Can't execute command \"" + command + "\": " + std::string(sqlite3_errmsg(_database)));
             return 0;
         }
+        if(changes) *changes = changedRows;
+        if(isSchemaCommand(command)) clearStatementCache(_statementCache);
         uint32_t rowID = sqlite3_last_insert_rowid(_database);
         return rowID;
     }
@@ -531,42 +1154,48 @@ uint32_t SQLite3::executeWriteCommand(std::string command, BaseLib::Database::Da
     return 0;
 }
 
-std::shared_ptr<BaseLib::Database::DataTable> SQLite3::executeCommand(std::string command, BaseLib::Database::DataRow& dataToEscape)
+void SQLite3::executeStatement(const std::string& command, BaseLib::Database::DataRow& dataToEscape, const std::function<void(sqlite3_stmt* statement)>& processRows)
 {
-    std::shared_ptr<BaseLib::Database::DataTable> dataRows(new BaseLib::Database::DataTable());
     try
     {
-        std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
+        if(executeReadCommand(command, dataToEscape, processRows)) return;
+
+        std::unique_lock<std::mutex> databaseGuard(_databaseMutex, std::defer_lock);
+        lockDatabaseMutex(databaseGuard);
         if(!_database)
         {
             GD::out.printError("Error: Could not write to database. No database handle.");
-            return dataRows;
+            return;
         }
-        sqlite3_stmt* statement = nullptr;
-        int32_t result = sqlite3_prepare_v2(_database, command.c_str(), -1, &statement, NULL);
-        if(result)
+        if(!startsWithKeyword(command, "SELECT")) commitGroupTransactionInternal();
+        bool cached = false;
+        sqlite3_stmt* statement = prepareStatement(_database, _statementCache, command, cached);
+        if(!statement)
         {
             GD::out.printError("Can't execute command \"" + command + "\": " + std::string(sqlite3_errmsg(_database)));
-            return dataRows;
+            return;
         }
-        bindData(statement, dataToEscape);
         try
         {
-            getDataRows(statement, dataRows);
+            bindData(statement, dataToEscape);
+            processRows(statement);
         }
         catch(const std::exception& ex)
         {
-            if(command.compare(0, 7, "RELEASE") == 0)
+            releaseStatement(statement, cached);
+            _transactionActive = !sqlite3_get_autocommit(_database);
+            if(startsWithKeyword(command, "RELEASE"))
             {
                 GD::out.printInfo(std::string("Info: ") + ex.what());
-                sqlite3_clear_bindings(statement);
-                return dataRows;
+                return;
             }
             else GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+            return;
         }
-        sqlite3_clear_bindings(statement);
-        result = sqlite3_finalize(statement);
+        int32_t result = releaseStatement(statement, cached);
+        _transactionActive = !sqlite3_get_autocommit(_database);
         if(result) GD::out.printError("Can't execute command \"" + command + "\" (Error-no.: " + std::to_string(result) + "): " + std::string(sqlite3_errmsg(_database)));
+        else if(isSchemaCommand(command)) clearStatementCache(_statementCache);
     }
     catch(const std::exception& ex)
     {
@@ -576,304 +1205,39 @@ std::shared_ptr<BaseLib::Database::DataTable> SQLite3::executeCommand(std::strin
     {
         GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
-    return dataRows;
 }
 
-std::shared_ptr<BaseLib::Database::DataTable> SQLite3::executeCommand(std::string command)
+std::shared_ptr<BaseLib::Database::DataTable> SQLite3::executeCommand(std::string command, BaseLib::Database::DataRow& dataToEscape)
 {
     std::shared_ptr<BaseLib::Database::DataTable> dataRows(new BaseLib::Database::DataTable());
-    try
+    executeStatement(command, dataToEscape, [&](sqlite3_stmt* statement)
     {
-        std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
-        if(!_database)
-        {
-            GD::out.printError("Error: Could not write to database. No database handle.");
-            return dataRows;
-        }
-        sqlite3_stmt* statement = nullptr;
-        int32_t result = sqlite3_prepare_v2(_database, command.c_str(), -1, &statement, NULL);
-        if(result)
-        {
-            GD::out.printError("Can't execute command \"" + command + "\": " + std::string(sqlite3_errmsg(_database)));
-            return dataRows;
-        }
-        try
-        {
-            getDataRows(statement, dataRows);
-        }
-        catch(const std::exception& ex)
-        {
-            if(command.compare(0, 7, "RELEASE") == 0)
-            {
-                GD::out.printInfo(std::string("Info: ") + ex.what());
-                sqlite3_clear_bindings(statement);
-                return dataRows;
-            }
-            else GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-        }
-        sqlite3_clear_bindings(statement);
-        result = sqlite3_finalize(statement);
-        if(result)
-        {
-            GD::out.printError("Can't execute command \"" + command + "\" (Error-no.: " + std::to_string(result) + "): " + std::string(sqlite3_errmsg(_database)));
-        }
-    }
-    catch(const std::exception& ex)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(...)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-    }
+        getDataRows(statement, dataRows);
+    });
     return dataRows;
 }
 
-/*
-void SQLite3::benchmark1()
-{
-	//Duration for REPLACE in ms: 17836
-	//Duration for UPDATE in ms: 14973
-	std::vector<uint8_t> value({0});
-	int64_t startTime = HelperFunctions::getTime();
-	std::map<uint32_t, uint32_t> ids;
-	for(uint32_t i = 0; i < 10000; ++i)
-	{
-		DataRow data;
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn(10000000)));
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn(1)));
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn(2)));
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn("TEST" + std::to_string(i))));
-		value[0] = (i % 256);
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-		ids[i] = executeWriteCommand("REPLACE INTO parameters VALUES(?, ?, ?, ?, ?, ?, ?, ?)", data);
-	}
-	int64_t duration = HelperFunctions::getTime() - startTime;
-	std::cerr << "Duration for REPLACE in ms: " << duration << std::endl;
-	startTime = HelperFunctions::getTime();
-	for(uint32_t i = 0; i < 10000; ++i)
-	{
-		DataRow data;
-		value[0] = (i % 256);
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn(ids[i])));
-		executeWriteCommand("UPDATE parameters SET value=? WHERE parameterID=?", data);
-	}
-	duration = HelperFunctions::getTime() - startTime;
-	std::cerr << "Duration for UPDATE in ms: " << duration << std::endl;
-	executeCommand("DELETE FROM parameters WHERE peerID=10000000");
-}
-
-void SQLite3::benchmark2()
-{
-	try
-	{
-		//Duration for REPLACE in ms: 17002
-		//Duration for UPDATE in ms: 14391
-		sqlite3_stmt* statement = nullptr;
-		int32_t result = sqlite3_prepare_v2(_database, "REPLACE INTO parameters VALUES(?, ?, ?, ?, ?, ?, ?, ?)", -1, &statement, NULL);
-		if(result)
-		{
-			throw(Exception("Can't execute command: " + std::string(sqlite3_errmsg(_database))));
-		}
-		std::vector<uint8_t> value({0});
-		int64_t startTime = HelperFunctions::getTime();
-		std::map<uint32_t, uint32_t> ids;
-		for(uint32_t i = 0; i < 10000; ++i)
-		{
-			DataRow data;
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(10000000)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(1)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(2)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn("TEST" + std::to_string(i))));
-			value[0] = (i % 256);
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-			bindData(statement, data);
-			ids[i] = sqlite3_step(statement);
-			sqlite3_clear_bindings(statement);
-			sqlite3_reset(statement);
-		}
-		sqlite3_finalize(statement);
-		statement = nullptr;
-		sqlite3_prepare_v2(_database, "UPDATE parameters SET value=? WHERE parameterID=?", -1, &statement, NULL);
-		int64_t duration = HelperFunctions::getTime() - startTime;
-		std::cerr << "Duration for REPLACE in ms: " << duration << std::endl;
-		startTime = HelperFunctions::getTime();
-		for(uint32_t i = 0; i < 10000; ++i)
-		{
-			DataRow data;
-			value[0] = (i % 256);
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(ids[i])));
-			bindData(statement, data);
-			ids[i] = sqlite3_step(statement);
-			sqlite3_clear_bindings(statement);
-			sqlite3_reset(statement);
-		}
-		sqlite3_finalize(statement);
-		duration = HelperFunctions::getTime() - startTime;
-		std::cerr << "Duration for UPDATE in ms: " << duration << std::endl;
-		executeCommand("DELETE FROM parameters WHERE peerID=10000000");
-	}
-	catch(const std::exception& ex)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(const Exception& ex)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(...)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-    }
+std::shared_ptr<BaseLib::Database::DataTable> SQLite3::executeCommand(std::string command)
+{
+    BaseLib::Database::DataRow dataToEscape;
+    return executeCommand(command, dataToEscape);
 }
 
-void SQLite3::benchmark3()
-{
-	try
-	{
-		sqlite3_stmt* statement = nullptr;
-		int32_t result = sqlite3_prepare_v2(_database, "REPLACE INTO parameters VALUES(?, ?, ?, ?, ?, ?, ?, ?)", -1, &statement, NULL);
-		if(result)
-		{
-			throw(Exception("Can't execute command: " + std::string(sqlite3_errmsg(_database))));
-		}
-		std::vector<uint8_t> value({0});
-		executeCommand("BEGIN IMMEDIATE TRANSACTION");
-		int64_t startTime = HelperFunctions::getTime();
-		std::map<uint32_t, uint32_t> ids;
-		for(uint32_t i = 0; i < 10000; ++i)
-		{
-			DataRow data;
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(10000000)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(1)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(2)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn("TEST" + std::to_string(i))));
-			value[0] = (i % 256);
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-			bindData(statement, data);
-			ids[i] = sqlite3_step(statement);
-			sqlite3_clear_bindings(statement);
-			sqlite3_reset(statement);
-		}
-		sqlite3_finalize(statement);
-		statement = nullptr;
-		executeCommand("COMMIT TRANSACTION");
-		int64_t duration = HelperFunctions::getTime() - startTime;
-		std::cerr << "Duration for REPLACE in ms: " << duration << std::endl;
-		sqlite3_prepare_v2(_database, "UPDATE parameters SET value=? WHERE parameterID=?", -1, &statement, NULL);
-		executeCommand("BEGIN IMMEDIATE TRANSACTION");
-		startTime = HelperFunctions::getTime();
-		for(uint32_t i = 0; i < 10000; ++i)
-		{
-			DataRow data;
-			value[0] = (i % 256);
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(ids[i])));
-			bindData(statement, data);
-			ids[i] = sqlite3_step(statement);
-			sqlite3_clear_bindings(statement);
-			sqlite3_reset(statement);
-		}
-		sqlite3_finalize(statement);
-		executeCommand("COMMIT TRANSACTION");
-		duration = HelperFunctions::getTime() - startTime;
-		std::cerr << "Duration for UPDATE in ms: " << duration << std::endl;
-		executeCommand("DELETE FROM parameters WHERE peerID=10000000");
-	}
-	catch(const std::exception& ex)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(const Exception& ex)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(...)
+bool SQLite3::executeQuery(const std::string& command, BaseLib::Database::DataRow& dataToEscape, const RowCallback& callback)
+{
+    bool success = false;
+    executeStatement(command, dataToEscape, [&](sqlite3_stmt* statement)
     {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-    }
+        stepRows(statement, callback);
+        success = true;
+    });
+    return success;
 }
 
-void SQLite3::benchmark4()
-{
-	try
-	{
-		sqlite3_stmt* statement = nullptr;
-		int32_t result = sqlite3_prepare_v2(_database, "REPLACE INTO parameters VALUES(?, ?, ?, ?, ?, ?, ?, ?)", -1, &statement, NULL);
-		if(result)
-		{
-			throw(Exception("Can't execute command: " + std::string(sqlite3_errmsg(_database))));
-		}
-		std::vector<uint8_t> value({0});
-		executeCommand("SAVEPOINT peerConfig");
-		int64_t startTime = HelperFunctions::getTime();
-		std::map<uint32_t, uint32_t> ids;
-		for(uint32_t i = 0; i < 10000; ++i)
-		{
-			DataRow data;
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(10000000)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(1)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(2)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn("TEST" + std::to_string(i))));
-			value[0] = (i % 256);
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-			bindData(statement, data);
-			ids[i] = sqlite3_step(statement);
-			sqlite3_clear_bindings(statement);
-			sqlite3_reset(statement);
-		}
-		sqlite3_finalize(statement);
-		statement = nullptr;
-		executeCommand("RELEASE peerConfig");
-		int64_t duration = HelperFunctions::getTime() - startTime;
-		std::cerr << "Duration for REPLACE in ms: " << duration << std::endl;
-		sqlite3_prepare_v2(_database, "UPDATE parameters SET value=? WHERE parameterID=?", -1, &statement, NULL);
-		executeCommand("SAVEPOINT peerConfig");
-		startTime = HelperFunctions::getTime();
-		for(uint32_t i = 0; i < 10000; ++i)
-		{
-			DataRow data;
-			value[0] = (i % 256);
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(ids[i])));
-			bindData(statement, data);
-			ids[i] = sqlite3_step(statement);
-			sqlite3_clear_bindings(statement);
-			sqlite3_reset(statement);
-		}
-		sqlite3_finalize(statement);
-		executeCommand("RELEASE peerConfig");
-		duration = HelperFunctions::getTime() - startTime;
-		std::cerr << "Duration for UPDATE in ms: " << duration << std::endl;
-		executeCommand("DELETE FROM parameters WHERE peerID=10000000");
-	}
-	catch(const std::exception& ex)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(const Exception& ex)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(...)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-    }
+bool SQLite3::executeQuery(const std::string& command, const RowCallback& callback)
+{
+    BaseLib::Database::DataRow dataToEscape;
+    return executeQuery(command, dataToEscape, callback);
 }
-*/
 
 }
@@ -34,6 +34,11 @@
 #include "homegear-base/Database/DatabaseTypes.h"
 
 #include <mutex>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
 
 #include <sqlite3.h>
 
@@ -48,18 +53,161 @@ public:
     virtual ~SQLite3();
     void dispose();
     void init(std::string databasePath, std::string databaseFilename, bool databaseSynchronous, bool databaseMemoryJournal, bool databaseWALJournal, std::string backupPath = "", std::string backupFilename = "");
+
+    /**
+     * Backs up the database. When the database is open, the backup is created online with SQLite's backup API, so
+     * reads and writes continue during the backup. Otherwise the database is checked for integrity and restored from the
+     * newest intact backup if necessary, before it is (re)opened.
+     */
     void hotBackup();
+
+    /**
+     * Sets how fast online backups are created.
+     *
+     * @param pagesPerStep The number of pages copied while the database mutex is locked.
+     * @param stepInterval The time in milliseconds to wait between two steps.
+     */
+    void setBackupPacing(int32_t pagesPerStep, int32_t stepInterval);
+
+    /**
+     * Attaches a second database file as schema "volatile" to every connection. It is meant for tables that change
+     * constantly, so they can be synced and backed up independently of the main database. Has to be called before the
+     * database is opened.
+     *
+     * @param databaseFilename The filename of the database in the database path. An empty string disables the volatile database.
+     * @param synchronousMode One of "off", "normal", "full" or "extra". An empty string uses the mode of the main database.
+     * @param backupFilename The filename of the backups in the backup path. An empty string disables backups of the volatile database.
+     */
+    void setVolatileDatabase(std::string databaseFilename, std::string synchronousMode, std::string backupFilename);
+    bool hasVolatileDatabase() { return !_volatileDatabaseFilename.empty(); }
     uint32_t executeWriteCommand(std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>> command);
-    uint32_t executeWriteCommand(std::string command, BaseLib::Database::DataRow& dataToEscape);
+
+    /**
+     * @param changes When set, receives the number of rows inserted, updated or deleted by the write or -1 when the write
+     * failed. The return value can't tell, as it is the ID of the last inserted row, which can be 0.
+     */
+    uint32_t executeWriteCommand(std::string command, BaseLib::Database::DataRow& dataToEscape, int32_t* changes = nullptr);
     std::shared_ptr<BaseLib::Database::DataTable> executeCommand(std::string command);
     std::shared_ptr<BaseLib::Database::DataTable> executeCommand(std::string command, BaseLib::Database::DataRow& dataToEscape);
+
+    // {{{ Group transaction
+    /**
+     * Opens a transaction for the writes executed with executeGroupedWriteCommand(). Every other write commits it first,
+     * so writes from other threads are never part of it. Reads keep using the read pool while it is open.
+     */
+    void beginGroupTransaction();
+
+    /**
+     * Executes a write within the group transaction. When no group transaction is open, the write is executed in its own
+     * transaction.
+     *
+     * @param changes When set, receives the number of rows inserted, updated or deleted by the write or -1 when the write
+     * failed.
+     */
+    uint32_t executeGroupedWriteCommand(std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>> command, int32_t* changes = nullptr);
+
+    /**
+     * @return false when no group transaction was open, e.g. because a write outside of it committed it already.
+     */
+    bool commitGroupTransaction();
+    bool groupTransactionOpen() { return _groupTransactionOpen; }
+    // }}}
+
+    // {{{ Row cursor
+    /**
+     * Gives access to the current row of a command executed with executeQuery(). It is only valid within the callback.
+     */
+    class Row
+    {
+    public:
+        explicit Row(sqlite3_stmt* statement) : _statement(statement) {}
+
+        int32_t columnCount() { return sqlite3_column_count(_statement); }
+        bool isNull(int32_t column) { return sqlite3_column_type(_statement, column) == SQLITE_NULL; }
+        int64_t getInteger(int32_t column) { return sqlite3_column_int64(_statement, column); }
+        double getFloat(int32_t column) { return sqlite3_column_double(_statement, column); }
+        std::string getText(int32_t column);
+
+        /**
+         * Copies a BLOB column into "buffer". NULL columns result in an empty buffer. The capacity of "buffer" is kept, so
+         * reusing one buffer for all rows avoids allocations.
+         */
+        void getBlob(int32_t column, std::vector<char>& buffer);
+
+        /**
+         * Returns the column as it is stored in a DataTable by executeCommand().
+         */
+        std::shared_ptr<BaseLib::Database::DataColumn> getDataColumn(int32_t column);
+    private:
+        sqlite3_stmt* _statement = nullptr;
+    };
+
+    /**
+     * Called for every row. Return false to stop reading further rows.
+     */
+    typedef std::function<bool(Row& row)> RowCallback;
+
+    /**
+     * Executes a command and passes the resulting rows one by one to "callback" without building a DataTable. The
+     * connection stays locked while the callback runs, so the callback must not access the database.
+     *
+     * @param command The SQL command to execute.
+     * @param dataToEscape The data to bind to the command's parameters.
+     * @param callback The function to call for every row.
+     * @return true when the command was executed successfully, false on errors.
+     */
+    bool executeQuery(const std::string& command, BaseLib::Database::DataRow& dataToEscape, const RowCallback& callback);
+    bool executeQuery(const std::string& command, const RowCallback& callback);
+    // }}}
+
     bool isOpen() { return _database != nullptr; }
-    /*void benchmark1();
-    void benchmark2();
-    void benchmark3();
-    void benchmark4();*/
+
+    /**
+     * Overrides "databaseSynchronous". The mode is applied immediately and every time the database is (re)opened.
+     *
+     * @param mode One of "off", "normal", "full" or "extra". An empty string restores the behavior set by "databaseSynchronous".
+     */
+    void setSynchronousMode(std::string mode);
+    uint64_t statementCacheHits() { return _statementCacheHits; }
+    uint64_t statementCacheMisses() { return _statementCacheMisses; }
+    size_t statementCacheSize();
+
+    /**
+     * Sets the number of read-only connections used for SELECT commands. The pool is only used in WAL journal mode. Has
+     * to be called before the database is opened.
+     *
+     * @param count The number of read connections. 0 executes all commands on the main connection.
+     */
+    void setReadConnectionCount(uint32_t count);
+
+    // {{{ Contention metrics
+    uint64_t readPoolReads() { return _readPoolReads; }
+    uint64_t readPoolWaits() { return _readPoolWaits; }
+    uint64_t readPoolWaitTime() { return _readPoolWaitTime; }
+    uint64_t databaseLockWaits() { return _databaseLockWaits; }
+    uint64_t databaseLockWaitTime() { return _databaseLockWaitTime; }
+    // }}}
 protected:
 private:
+    struct CachedStatement
+    {
+        sqlite3_stmt* statement = nullptr;
+        std::list<std::string>::iterator lruIterator;
+    };
+
+    struct StatementCache
+    {
+        std::unordered_map<std::string, CachedStatement> statements;
+        std::list<std::string> lru;
+    };
+
+    struct ReadConnection
+    {
+        std::mutex mutex;
+        sqlite3* database = nullptr;
+        StatementCache statementCache;
+    };
+
     std::string _databasePath;
     std::string _databaseFilename;
     std::string _backupPath;
@@ -67,14 +215,156 @@ private:
     bool _databaseSynchronous = true;
     bool _databaseMemoryJournal = false;
     bool _databaseWALJournal = true;
+    std::string _synchronousMode;
+    std::string _volatileDatabaseFilename;
+    std::string _volatileSynchronousMode;
+    std::string _volatileBackupFilename;
     sqlite3* _database = nullptr;
     std::mutex _databaseMutex;
 
+    // {{{ Prepared statement cache, protected by _databaseMutex
+    const size_t _statementCacheMaxSize = 200;
+    StatementCache _statementCache;
+    std::atomic<uint64_t> _statementCacheHits{0};
+    std::atomic<uint64_t> _statementCacheMisses{0};
+    // }}}
+
+    // {{{ Online backup
+    /**
+     * Only one backup can run at a time.
+     */
+    std::mutex _backupMutex;
+
+    /**
+     * The running online backup, protected by _databaseMutex. closeDatabase() aborts it and sets it to nullptr.
+     */
+    sqlite3_backup* _backup = nullptr;
+    int32_t _backupPagesPerStep = 100;
+    int32_t _backupStepInterval = 10;
+
+    /**
+     * The maximum time in milliseconds backup steps are skipped in a row because of open transactions. After that the
+     * next step is executed anyway, so constant write load can't stall the backup.
+     */
+    static constexpr int64_t _backupMaxDeferTime = 10000;
+    // }}}
+
+    // {{{ Read connection pool
+    /**
+     * Only resized while the database is closed. Every connection is protected by its own mutex.
+     */
+    std::vector<std::unique_ptr<ReadConnection>> _readConnections;
+    std::atomic<uint32_t> _nextReadConnection{0};
+
+    /**
+     * Set while the main connection has an open transaction. Reads are executed on the main connection then, so they
+     * see uncommitted changes. The group transaction is the exception: its writes are only read through the data caches
+     * until they are committed.
+     */
+    std::atomic_bool _transactionActive{false};
+    std::atomic_bool _groupTransactionOpen{false};
+    std::atomic<uint64_t> _readPoolReads{0};
+    std::atomic<uint64_t> _readPoolWaits{0};
+    std::atomic<uint64_t> _readPoolWaitTime{0};
+    std::atomic<uint64_t> _databaseLockWaits{0};
+    std::atomic<uint64_t> _databaseLockWaitTime{0};
+    // }}}
+
     bool checkIntegrity(std::string databasePath);
+
+    /**
+     * Executes a write on the main connection. Writes, which are not grouped, commit the group transaction first.
+     */
+    uint32_t executeWrite(const std::string& command, BaseLib::Database::DataRow& dataToEscape, bool grouped, int32_t* changes = nullptr);
+
+    /**
+     * Commits the group transaction. _databaseMutex must be locked.
+     */
+    bool commitGroupTransactionInternal();
+
+    /**
+     * Checks a closed database file for integrity and restores it from the newest intact backup if it is corrupted or
+     * missing. Intact files are backed up.
+     *
+     * @return false when the file is corrupted and could not be restored.
+     */
+    bool checkDatabaseFile(const std::string& databaseFilename, const std::string& backupFilename);
+
+    /**
+     * Creates a backup of the open database without closing it. The backup is written to a temporary file and only
+     * replaces the newest backup after it passed the integrity check.
+     *
+     * @param schema The schema to back up, i. e. "main" or "volatile".
+     * @param backupFilename The filename of the backups in the backup path.
+     */
+    void onlineBackup(const std::string& schema, const std::string& backupFilename);
+
+    /**
+     * Shifts the existing backup files by one, deleting the oldest one, so that index 0 is free for a new backup.
+     */
+    void rotateBackups(const std::string& backupFilename);
+
+    /**
+     * Attaches the volatile database to a connection.
+     */
+    bool attachVolatileDatabase(sqlite3* database);
     void openDatabase(bool lockMutex);
     void closeDatabase(bool lockMutex);
+    void openReadConnections();
+    void closeReadConnections();
     void getDataRows(sqlite3_stmt* statement, std::shared_ptr<BaseLib::Database::DataTable>& dataRows);
+    void stepRows(sqlite3_stmt* statement, const RowCallback& callback);
     void bindData(sqlite3_stmt* statement, BaseLib::Database::DataRow& dataToEscape);
+
+    /**
+     * Locks _databaseMutex and counts the lock as contended when it is held by another thread.
+     */
+    void lockDatabaseMutex(std::unique_lock<std::mutex>& databaseGuard);
+
+    /**
+     * Executes a SELECT command on one of the read connections.
+     *
+     * @return false when no read connection could be used. The command needs to be executed on the main connection then.
+     */
+    bool executeReadCommand(const std::string& command, BaseLib::Database::DataRow& dataToEscape, const std::function<void(sqlite3_stmt* statement)>& processRows);
+
+    /**
+     * Executes a command on a read connection if possible or on the main connection otherwise. "processRows" is called
+     * with the bound statement and needs to step through it. It may throw on errors.
+     */
+    void executeStatement(const std::string& command, BaseLib::Database::DataRow& dataToEscape, const std::function<void(sqlite3_stmt* statement)>& processRows);
+
+    /**
+     * Returns a prepared statement for "command". Statements are kept in a bounded LRU cache and reused after being reset.
+     * Schema changing commands and commands without parameters are never cached. The mutex of the connection needs to be
+     * locked when calling this method.
+     *
+     * @param database The connection to prepare the statement on.
+     * @param statementCache The cache of this connection.
+     * @param command The SQL command to prepare.
+     * @param[out] cached Set to true when the returned statement is owned by the cache.
+     * @return The prepared statement or nullptr on error.
+     */
+    sqlite3_stmt* prepareStatement(sqlite3* database, StatementCache& statementCache, const std::string& command, bool& cached);
+
+    /**
+     * Resets a statement returned by prepareStatement() so it can be reused or finalizes it if it isn't cached.
+     */
+    int32_t releaseStatement(sqlite3_stmt* statement, bool cached);
+
+    /**
+     * Finalizes all cached statements. Needs to be called before a connection is closed and after the schema changed.
+     * The mutex of the connection needs to be locked when calling this method.
+     */
+    static void clearStatementCache(StatementCache& statementCache);
+
+    /**
+     * Checks if the first word of "command" is "keyword". Leading whitespace is skipped and the comparison is case
+     * insensitive. "keyword" needs to be upper case.
+     */
+    static bool startsWithKeyword(const std::string& command, const std::string& keyword);
+
+    static bool isSchemaCommand(const std::string& command);
 };
 
 }
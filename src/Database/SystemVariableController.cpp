@@ -1036,6 +1036,8 @@ BaseLib::PVariable SystemVariableController::setValue(BaseLib::PRpcClientInfo cl
             return result;
         }
 
+        if(GD::variableHistory) GD::variableHistory->record(0, -1, std::vector<std::string>{variableId}, std::vector<BaseLib::PVariable>{value});
+
 #ifdef EVENTHANDLER
         GD::eventHandler->trigger(variableId, value);
 #endif
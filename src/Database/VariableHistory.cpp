@@ -0,0 +1,646 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "../GD/GD.h"
+#include "VariableHistory.h"
+
+#include <cstring>
+
+namespace Homegear
+{
+
+VariableHistory::VariableHistory()
+{
+}
+
+VariableHistory::~VariableHistory()
+{
+    dispose();
+}
+
+void VariableHistory::init(DatabaseSettings& settings, const std::string& databasePath)
+{
+    try
+    {
+        if(_enabled || !settings.historyEnabled()) return;
+
+        _blockSize = settings.historyBlockSize();
+        _flushInterval = (int64_t)settings.historyFlushInterval() * 1000;
+        _retention = settings.historyRetention();
+        _historyVariables = settings.historyVariables();
+
+        //History data is not critical, so we trade durability for write performance. WAL with synchronous set to "normal"
+        //never corrupts the database.
+        _db.setSynchronousMode("normal");
+        _db.setReadConnectionCount(1);
+        _db.init(databasePath, "history.db", false, false, true);
+        if(!_db.isOpen())
+        {
+            GD::out.printError("Error: Could not open history database. Variable history is disabled.");
+            return;
+        }
+        _db.executeCommand("CREATE TABLE IF NOT EXISTS history (peerID INTEGER NOT NULL, peerChannel INTEGER NOT NULL, variable TEXT NOT NULL, startTime INTEGER NOT NULL, endTime INTEGER NOT NULL, count INTEGER NOT NULL, type INTEGER NOT NULL, data BLOB NOT NULL)");
+        _db.executeCommand("CREATE INDEX IF NOT EXISTS historyIndex ON history (peerID, peerChannel, variable, endTime)");
+
+        _enabled = true;
+        _stopFlushThread = false;
+        GD::bl->threadManager.start(_flushThread, true, &VariableHistory::flushThread, this);
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+void VariableHistory::dispose()
+{
+    try
+    {
+        if(!_enabled) return;
+        {
+            std::lock_guard<std::mutex> flushThreadGuard(_flushThreadMutex);
+            _stopFlushThread = true;
+        }
+        _flushThreadConditionVariable.notify_all();
+        GD::bl->threadManager.join(_flushThread);
+
+        {
+            std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+            _enabled = false;
+            closeBlocks(true);
+        }
+        writeBlocks();
+        _db.dispose();
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+int32_t VariableHistory::getRetention(uint64_t peerId, int32_t channel, const std::string& variable)
+{
+    for(auto& historyVariable : _historyVariables)
+    {
+        if(!historyVariable.anyPeer && historyVariable.peerId != peerId) continue;
+        if(!historyVariable.anyChannel && historyVariable.channel != channel) continue;
+        if(!historyVariable.variable.empty() && historyVariable.variable != variable) continue;
+        return historyVariable.retention;
+    }
+    return -1;
+}
+
+void VariableHistory::record(uint64_t peerId, int32_t channel, const std::vector<std::string>& variables, const std::vector<BaseLib::PVariable>& values)
+{
+    try
+    {
+        if(!_enabled) return;
+        int64_t time = BaseLib::HelperFunctions::getTime();
+
+        std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+        if(!_enabled) return;
+        for(size_t i = 0; i < variables.size() && i < values.size(); i++)
+        {
+            auto& value = values.at(i);
+            if(!value) continue;
+
+            ValueType type = ValueType::none;
+            int64_t integerValue = 0;
+            double floatValue = 0;
+            switch(value->type)
+            {
+                case BaseLib::VariableType::tBoolean:
+                    type = ValueType::boolean;
+                    integerValue = value->booleanValue;
+                    break;
+                case BaseLib::VariableType::tInteger:
+                    type = ValueType::integer;
+                    integerValue = value->integerValue;
+                    break;
+                case BaseLib::VariableType::tInteger64:
+                    type = ValueType::integer;
+                    integerValue = value->integerValue64;
+                    break;
+                case BaseLib::VariableType::tFloat:
+                    type = ValueType::floatingPoint;
+                    floatValue = value->floatValue;
+                    break;
+                default:
+                    continue;
+            }
+
+            //Only recorded variables get a series, so unrecorded ones don't fill the map.
+            std::string key = std::to_string(peerId) + '.' + std::to_string(channel) + '.' + variables.at(i);
+            auto seriesIterator = _series.find(key);
+            if(seriesIterator == _series.end())
+            {
+                int32_t retention = getRetention(peerId, channel, variables.at(i));
+                bool recorded = retention > 0 || (retention == -1 && _historyVariables.empty());
+                if(!recorded) continue;
+                seriesIterator = _series.emplace(key, std::make_shared<Series>()).first;
+            }
+            auto& series = seriesIterator->second;
+
+            if(series->block && series->block->type != type)
+            {
+                _pendingBlocks.push_back(series->block);
+                series->block.reset();
+            }
+            if(!series->block)
+            {
+                series->block = std::make_shared<Block>();
+                series->block->peerId = peerId;
+                series->block->channel = channel;
+                series->block->variable = variables.at(i);
+                series->block->type = type;
+            }
+
+            appendSample(*series->block, time, integerValue, floatValue);
+            _recordedValues++;
+
+            if(series->block->count >= (uint32_t)_blockSize)
+            {
+                _pendingBlocks.push_back(series->block);
+                series->block.reset();
+            }
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+BaseLib::PVariable VariableHistory::getHistory(uint64_t peerId, int32_t channel, const std::string& variable, int64_t startTime, int64_t endTime, int64_t interval)
+{
+    try
+    {
+        if(!_enabled) return BaseLib::Variable::createError(-1, "Variable history is not enabled.");
+        if(endTime < startTime) return BaseLib::Variable::createError(-1, "End time is before start time.");
+        if(interval < 0) return BaseLib::Variable::createError(-1, "Interval is negative.");
+
+        int64_t queryStartTime = BaseLib::HelperFunctions::getTimeMicroseconds();
+        auto result = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+
+        std::vector<Sample> samples;
+        samples.reserve(_blockSize);
+
+        //Downsampling state
+        int64_t bucket = 0;
+        uint32_t bucketCount = 0;
+        double bucketSum = 0;
+        double bucketMin = 0;
+        double bucketMax = 0;
+
+        //The result is limited, as it is held in memory completely.
+        bool tooManyValues = false;
+        auto flushBucket = [&]()
+        {
+            if(bucketCount == 0) return;
+            if(result->arrayValue->size() >= _maxQueryValues)
+            {
+                tooManyValues = true;
+                bucketCount = 0;
+                return;
+            }
+            auto entry = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+            entry->arrayValue->reserve(4);
+            entry->arrayValue->push_back(std::make_shared<BaseLib::Variable>(bucket));
+            entry->arrayValue->push_back(std::make_shared<BaseLib::Variable>(bucketSum / bucketCount));
+            entry->arrayValue->push_back(std::make_shared<BaseLib::Variable>(bucketMin));
+            entry->arrayValue->push_back(std::make_shared<BaseLib::Variable>(bucketMax));
+            result->arrayValue->push_back(entry);
+            bucketCount = 0;
+        };
+
+        auto processBlock = [&](ValueType type, uint32_t count, const std::vector<char>& data)
+        {
+            if(tooManyValues) return;
+            samples.clear();
+            if(!decodeBlock(type, count, data, samples)) GD::out.printWarning("Warning: Corrupted block in history of variable " + variable + " of peer " + std::to_string(peerId) + ".");
+
+            for(auto& sample : samples)
+            {
+                if(sample.time < startTime || sample.time > endTime) continue;
+
+                if(interval == 0)
+                {
+                    if(result->arrayValue->size() >= _maxQueryValues)
+                    {
+                        tooManyValues = true;
+                        return;
+                    }
+                    auto entry = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+                    entry->arrayValue->reserve(2);
+                    entry->arrayValue->push_back(std::make_shared<BaseLib::Variable>(sample.time));
+                    if(type == ValueType::boolean) entry->arrayValue->push_back(std::make_shared<BaseLib::Variable>((bool)sample.integerValue));
+                    else if(type == ValueType::integer) entry->arrayValue->push_back(std::make_shared<BaseLib::Variable>(sample.integerValue));
+                    else entry->arrayValue->push_back(std::make_shared<BaseLib::Variable>(sample.floatValue));
+                    result->arrayValue->push_back(entry);
+                    continue;
+                }
+
+                double value = type == ValueType::floatingPoint ? sample.floatValue : (double)sample.integerValue;
+                int64_t sampleBucket = startTime + ((sample.time - startTime) / interval) * interval;
+                if(bucketCount > 0 && sampleBucket != bucket) flushBucket();
+                if(bucketCount == 0)
+                {
+                    bucket = sampleBucket;
+                    bucketSum = 0;
+                    bucketMin = value;
+                    bucketMax = value;
+                }
+                bucketCount++;
+                bucketSum += value;
+                if(value < bucketMin) bucketMin = value;
+                if(value > bucketMax) bucketMax = value;
+            }
+        };
+
+        std::string key = std::to_string(peerId) + '.' + std::to_string(channel) + '.' + variable;
+
+        //Prevents blocks from moving from memory to the database while we read them.
+        std::lock_guard<std::mutex> flushGuard(_flushMutex);
+
+        std::vector<PBlock> memoryBlocks;
+        {
+            std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+            for(auto& block : _pendingBlocks)
+            {
+                if(block->peerId == peerId && block->channel == channel && block->variable == variable) memoryBlocks.push_back(std::make_shared<Block>(*block));
+            }
+            auto seriesIterator = _series.find(key);
+            if(seriesIterator != _series.end() && seriesIterator->second->block) memoryBlocks.push_back(std::make_shared<Block>(*seriesIterator->second->block));
+        }
+
+        BaseLib::Database::DataRow data;
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(peerId));
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(channel));
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(variable));
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(startTime));
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(endTime));
+        std::vector<char> blob;
+        if(!_db.executeQuery("SELECT type, count, data FROM history WHERE peerID=? AND peerChannel=? AND variable=? AND endTime>=? AND startTime<=? ORDER BY endTime", data, [&](SQLite3::Row& row)
+        {
+            row.getBlob(2, blob);
+            processBlock((ValueType)row.getInteger(0), (uint32_t)row.getInteger(1), blob);
+            return !tooManyValues;
+        }))
+        {
+            return BaseLib::Variable::createError(-1, "Could not read from database.");
+        }
+
+        for(auto& block : memoryBlocks)
+        {
+            if(block->maxTime < startTime || block->minTime > endTime) continue;
+            processBlock(block->type, block->count, block->data);
+        }
+        flushBucket();
+        if(tooManyValues)
+        {
+            return BaseLib::Variable::createError(-1, "The time range contains more than " + std::to_string(_maxQueryValues) + " values. Please request a shorter time range or a larger interval.");
+        }
+
+        _queries++;
+        _queryTime += BaseLib::HelperFunctions::getTimeMicroseconds() - queryStartTime;
+
+        return result;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable VariableHistory::getMetrics()
+{
+    try
+    {
+        auto metrics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        metrics->structValue->emplace("historyEnabled", std::make_shared<BaseLib::Variable>((bool)_enabled));
+        metrics->structValue->emplace("historyRecordedValues", std::make_shared<BaseLib::Variable>((int64_t)_recordedValues));
+        metrics->structValue->emplace("historyWrittenBlocks", std::make_shared<BaseLib::Variable>((int64_t)_writtenBlocks));
+        metrics->structValue->emplace("historyWrittenBytes", std::make_shared<BaseLib::Variable>((int64_t)_writtenBytes));
+        metrics->structValue->emplace("historyQueries", std::make_shared<BaseLib::Variable>((int64_t)_queries));
+        metrics->structValue->emplace("historyQueryTime", std::make_shared<BaseLib::Variable>((int64_t)_queryTime));
+        {
+            std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+            metrics->structValue->emplace("historyPendingBlocks", std::make_shared<BaseLib::Variable>((int64_t)_pendingBlocks.size()));
+        }
+        return metrics;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+void VariableHistory::flushThread()
+{
+    while(!_stopFlushThread)
+    {
+        try
+        {
+            {
+                std::unique_lock<std::mutex> waitLock(_flushThreadMutex);
+                _flushThreadConditionVariable.wait_for(waitLock, std::chrono::milliseconds(1000), [&]
+                {
+                    return (bool)_stopFlushThread;
+                });
+            }
+            if(_stopFlushThread) break;
+
+            {
+                std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+                closeBlocks(false);
+            }
+            writeBlocks();
+
+            int64_t time = BaseLib::HelperFunctions::getTime();
+            if(time - _lastRetentionCheck >= 3600000)
+            {
+                _lastRetentionCheck = time;
+                deleteExpiredBlocks();
+            }
+        }
+        catch(const std::exception& ex)
+        {
+            GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+        }
+    }
+}
+
+void VariableHistory::closeBlocks(bool all)
+{
+    int64_t time = BaseLib::HelperFunctions::getTime();
+    for(auto& series : _series)
+    {
+        auto& block = series.second->block;
+        if(!block) continue;
+        if(all || time - block->minTime >= _flushInterval)
+        {
+            _pendingBlocks.push_back(block);
+            block.reset();
+        }
+    }
+}
+
+void VariableHistory::writeBlocks()
+{
+    try
+    {
+        std::lock_guard<std::mutex> flushGuard(_flushMutex);
+
+        std::vector<PBlock> blocks;
+        {
+            std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+            blocks.insert(blocks.end(), _pendingBlocks.begin(), _pendingBlocks.end());
+        }
+        if(blocks.empty()) return;
+
+        //On errors the transaction is rolled back and the blocks stay pending, so they are written with the next flush.
+        BaseLib::Database::DataRow data;
+        int32_t changes = 0;
+        _db.executeWriteCommand("BEGIN", data, &changes);
+        if(changes == -1)
+        {
+            GD::out.printError("Error: Could not write variable history. Keeping " + std::to_string(blocks.size()) + " blocks in memory.");
+            return;
+        }
+        bool success = true;
+        uint64_t writtenBytes = 0;
+        for(auto& block : blocks)
+        {
+            data.clear();
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>(block->peerId));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>(block->channel));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>(block->variable));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>(block->minTime));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>(block->maxTime));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>(block->count));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>((int32_t)block->type));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>(block->data));
+            _db.executeWriteCommand("INSERT INTO history VALUES(?, ?, ?, ?, ?, ?, ?, ?)", data, &changes);
+            if(changes != 1)
+            {
+                success = false;
+                break;
+            }
+            writtenBytes += block->data.size();
+        }
+        data.clear();
+        if(success)
+        {
+            _db.executeWriteCommand("COMMIT", data, &changes);
+            success = changes != -1;
+        }
+        if(!success)
+        {
+            _db.executeWriteCommand("ROLLBACK", data);
+            GD::out.printError("Error: Could not write variable history. Keeping " + std::to_string(blocks.size()) + " blocks in memory.");
+            return;
+        }
+        _writtenBlocks += blocks.size();
+        _writtenBytes += writtenBytes;
+
+        std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+        _pendingBlocks.erase(_pendingBlocks.begin(), _pendingBlocks.begin() + blocks.size());
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+void VariableHistory::deleteExpiredBlocks()
+{
+    try
+    {
+        struct SeriesId
+        {
+            uint64_t peerId;
+            int32_t channel;
+            std::string variable;
+        };
+        std::vector<SeriesId> seriesIds;
+        if(!_db.executeQuery("SELECT DISTINCT peerID, peerChannel, variable FROM history", [&](SQLite3::Row& row)
+        {
+            seriesIds.push_back(SeriesId{(uint64_t)row.getInteger(0), (int32_t)row.getInteger(1), row.getText(2)});
+            return true;
+        }))
+        {
+            return;
+        }
+
+        int64_t time = BaseLib::HelperFunctions::getTime();
+        for(auto& seriesId : seriesIds)
+        {
+            int32_t retention = getRetention(seriesId.peerId, seriesId.channel, seriesId.variable);
+            if(retention <= 0) retention = _retention;
+            if(retention <= 0) continue;
+
+            BaseLib::Database::DataRow data;
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>(seriesId.peerId));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>(seriesId.channel));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>(seriesId.variable));
+            data.push_back(std::make_shared<BaseLib::Database::DataColumn>(time - (int64_t)retention * 86400000));
+            _db.executeWriteCommand("DELETE FROM history WHERE peerID=? AND peerChannel=? AND variable=? AND endTime<?", data);
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+// {{{ Encoding
+void VariableHistory::appendVarint(std::vector<char>& data, uint64_t value)
+{
+    while(value >= 0x80)
+    {
+        data.push_back((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    data.push_back((char)value);
+}
+
+bool VariableHistory::readVarint(const std::vector<char>& data, size_t& position, uint64_t& value)
+{
+    value = 0;
+    for(int32_t shift = 0; shift < 64 && position < data.size(); shift += 7)
+    {
+        uint8_t byte = (uint8_t)data[position++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+void VariableHistory::appendSample(Block& block, int64_t time, int64_t integerValue, double floatValue)
+{
+    if(block.count == 0)
+    {
+        appendVarint(block.data, zigzagEncode(time));
+        block.minTime = time;
+        block.maxTime = time;
+    }
+    else
+    {
+        int64_t timeDelta = time - block.lastTime;
+        appendVarint(block.data, zigzagEncode(timeDelta - block.lastTimeDelta));
+        block.lastTimeDelta = timeDelta;
+        if(time < block.minTime) block.minTime = time;
+        if(time > block.maxTime) block.maxTime = time;
+    }
+    block.lastTime = time;
+
+    if(block.type == ValueType::floatingPoint)
+    {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &floatValue, sizeof(bits));
+        uint64_t xorValue = bits ^ block.lastFloat;
+        block.lastFloat = bits;
+        if(xorValue == 0) block.data.push_back(0);
+        else
+        {
+            //Similar values share sign, exponent and the upper bits of the mantissa, values with few decimal places
+            //end with zero bytes. Only the bytes in between are stored.
+            int32_t leadingZeroBytes = __builtin_clzll(xorValue) / 8;
+            int32_t trailingZeroBytes = __builtin_ctzll(xorValue) / 8;
+            block.data.push_back((char)(0x40 | (leadingZeroBytes << 3) | trailingZeroBytes));
+            for(int32_t i = 7 - leadingZeroBytes; i >= trailingZeroBytes; i--)
+            {
+                block.data.push_back((char)(xorValue >> (i * 8)));
+            }
+        }
+    }
+    else
+    {
+        appendVarint(block.data, zigzagEncode(integerValue - block.lastInteger));
+        block.lastInteger = integerValue;
+    }
+
+    block.count++;
+}
+
+bool VariableHistory::decodeBlock(ValueType type, uint32_t count, const std::vector<char>& data, std::vector<Sample>& samples)
+{
+    size_t position = 0;
+    int64_t time = 0;
+    int64_t timeDelta = 0;
+    int64_t integerValue = 0;
+    uint64_t floatBits = 0;
+    uint64_t value = 0;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if(!readVarint(data, position, value)) return false;
+        if(i == 0) time = zigzagDecode(value);
+        else
+        {
+            timeDelta += zigzagDecode(value);
+            time += timeDelta;
+        }
+
+        Sample sample;
+        sample.time = time;
+        if(type == ValueType::floatingPoint)
+        {
+            if(position >= data.size()) return false;
+            uint8_t control = (uint8_t)data[position++];
+            if(control != 0)
+            {
+                int32_t leadingZeroBytes = (control >> 3) & 7;
+                int32_t trailingZeroBytes = control & 7;
+                int32_t byteCount = 8 - leadingZeroBytes - trailingZeroBytes;
+                if(byteCount <= 0 || position + byteCount > data.size()) return false;
+                uint64_t xorValue = 0;
+                for(int32_t j = 0; j < byteCount; j++)
+                {
+                    xorValue = (xorValue << 8) | (uint8_t)data[position++];
+                }
+                floatBits ^= xorValue << (trailingZeroBytes * 8);
+            }
+            std::memcpy(&sample.floatValue, &floatBits, sizeof(floatBits));
+        }
+        else
+        {
+            if(!readVarint(data, position, value)) return false;
+            integerValue += zigzagDecode(value);
+            sample.integerValue = integerValue;
+        }
+        samples.push_back(sample);
+    }
+    return true;
+}
+// }}}
+
+}
@@ -0,0 +1,238 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef VARIABLEHISTORY_H_
+#define VARIABLEHISTORY_H_
+
+#include "SQLite3.h"
+#include "DatabaseSettings.h"
+
+#include <homegear-base/BaseLib.h>
+
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Homegear
+{
+
+/**
+ * Records the values of peer and system variables in a separate database. Values are collected per variable in
+ * delta-encoded blocks, which are written to the database when they are full or after "historyFlushInterval".
+ */
+class VariableHistory
+{
+public:
+    VariableHistory();
+
+    virtual ~VariableHistory();
+
+    /**
+     * Opens "history.db" in "databasePath" and starts the flush thread. Does nothing when "historyEnabled" is not set.
+     */
+    void init(DatabaseSettings& settings, const std::string& databasePath);
+
+    /**
+     * Writes all values still held in memory and closes the database.
+     */
+    void dispose();
+
+    bool enabled() { return _enabled; }
+
+    /**
+     * Records changed values. Values that are not boolean, integer or float are ignored.
+     *
+     * @param peerId The peer ID. 0 for system variables.
+     * @param channel The channel. -1 for system variables.
+     * @param variables The names of the changed variables.
+     * @param values The new values in the same order as "variables".
+     */
+    void record(uint64_t peerId, int32_t channel, const std::vector<std::string>& variables, const std::vector<BaseLib::PVariable>& values);
+
+    /**
+     * Returns the recorded values of a variable.
+     *
+     * @param peerId The peer ID. 0 for system variables.
+     * @param channel The channel. -1 for system variables.
+     * @param variable The name of the variable.
+     * @param startTime The start of the time range as Unix time in milliseconds.
+     * @param endTime The end of the time range as Unix time in milliseconds.
+     * @param interval When 0, all values are returned as arrays of time and value. Otherwise the values are grouped into
+     * buckets of "interval" milliseconds and arrays of bucket start time, average, minimum and maximum are returned.
+     * @return An array of arrays ordered by time or an error when there are more than 100000 entries.
+     */
+    BaseLib::PVariable getHistory(uint64_t peerId, int32_t channel, const std::string& variable, int64_t startTime, int64_t endTime, int64_t interval);
+
+    /**
+     * Returns statistics about recorded values and written blocks.
+     */
+    BaseLib::PVariable getMetrics();
+private:
+    enum class ValueType : int32_t
+    {
+        none = 0,
+        boolean = 1,
+        integer = 2,
+        floatingPoint = 3
+    };
+
+    /**
+     * A block of values of one variable. The first time stamp is stored as is, every further time stamp as the zigzag
+     * encoded difference between its delta and the previous delta. Integers and booleans are
+     * stored as zigzag encoded deltas, floats as XOR with the previous value with zero bytes removed.
+     */
+    struct Block
+    {
+        uint64_t peerId = 0;
+        int32_t channel = -1;
+        std::string variable;
+        ValueType type = ValueType::none;
+        int64_t minTime = 0;
+        int64_t maxTime = 0;
+        uint32_t count = 0;
+        std::vector<char> data;
+
+        // {{{ Encoder state
+        int64_t lastTime = 0;
+        int64_t lastTimeDelta = 0;
+        int64_t lastInteger = 0;
+        uint64_t lastFloat = 0;
+        // }}}
+    };
+    typedef std::shared_ptr<Block> PBlock;
+
+    struct Series
+    {
+        PBlock block;
+    };
+    typedef std::shared_ptr<Series> PSeries;
+
+    /**
+     * One decoded value. Booleans and integers are stored in "integerValue".
+     */
+    struct Sample
+    {
+        int64_t time = 0;
+        int64_t integerValue = 0;
+        double floatValue = 0;
+    };
+
+    /**
+     * The maximum number of entries getHistory() returns.
+     */
+    static constexpr size_t _maxQueryValues = 100000;
+
+    bool _enabled = false;
+    int32_t _blockSize = 256;
+    int64_t _flushInterval = 600000;
+    int32_t _retention = 365;
+    std::vector<DatabaseSettings::HistoryVariable> _historyVariables;
+    SQLite3 _db;
+
+    /**
+     * Protects _series and _pendingBlocks.
+     */
+    std::mutex _seriesMutex;
+    std::unordered_map<std::string, PSeries> _series;
+
+    /**
+     * Full blocks waiting to be written to the database.
+     */
+    std::deque<PBlock> _pendingBlocks;
+
+    /**
+     * Held while pending blocks are written and removed, so queries never see a block twice or miss it.
+     */
+    std::mutex _flushMutex;
+
+    std::atomic_bool _stopFlushThread{false};
+    std::mutex _flushThreadMutex;
+    std::condition_variable _flushThreadConditionVariable;
+    std::thread _flushThread;
+    int64_t _lastRetentionCheck = 0;
+
+    // {{{ Metrics
+    std::atomic<uint64_t> _recordedValues{0};
+    std::atomic<uint64_t> _writtenBlocks{0};
+    std::atomic<uint64_t> _writtenBytes{0};
+    std::atomic<uint64_t> _queries{0};
+    std::atomic<uint64_t> _queryTime{0};
+    // }}}
+
+    /**
+     * Returns the retention in days of the first matching "historyVariable" entry.
+     *
+     * @return The retention or -1 when no entry matches.
+     */
+    int32_t getRetention(uint64_t peerId, int32_t channel, const std::string& variable);
+
+    void flushThread();
+
+    /**
+     * Moves the open blocks older than "historyFlushInterval" to _pendingBlocks. _seriesMutex needs to be locked.
+     *
+     * @param all Moves all open blocks regardless of their age.
+     */
+    void closeBlocks(bool all);
+
+    /**
+     * Writes all pending blocks to the database.
+     */
+    void writeBlocks();
+
+    /**
+     * Deletes blocks older than their variable's retention.
+     */
+    void deleteExpiredBlocks();
+
+    // {{{ Encoding
+    static void appendVarint(std::vector<char>& data, uint64_t value);
+    static bool readVarint(const std::vector<char>& data, size_t& position, uint64_t& value);
+    static uint64_t zigzagEncode(int64_t value) { return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63); }
+    static int64_t zigzagDecode(uint64_t value) { return (int64_t)(value >> 1) ^ -(int64_t)(value & 1); }
+    static void appendSample(Block& block, int64_t time, int64_t integerValue, double floatValue);
+
+    /**
+     * Decodes all values of a block.
+     *
+     * @return false when the block is corrupted. "samples" contains the values decoded until then.
+     */
+    static bool decodeBlock(ValueType type, uint32_t count, const std::vector<char>& data, std::vector<Sample>& samples);
+    // }}}
+};
+
+}
+
+#endif
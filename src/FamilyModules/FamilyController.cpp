@@ -245,6 +245,7 @@ void FamilyController::onEvent(std::string source, uint64_t peerID, int32_t chan
         GD::scriptEngineServer->broadcastEvent(source, peerID, channel, variables, values);
 #endif
         if(GD::ipcServer) GD::ipcServer->broadcastEvent(source, peerID, channel, variables, values);
+        if(GD::variableHistory && variables && values) GD::variableHistory->record(peerID, channel, *variables, *values);
     }
     catch(const std::exception& ex)
     {
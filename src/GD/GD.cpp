@@ -52,6 +52,12 @@ std::unique_ptr<Rpc::Client> GD::rpcClient;
 int32_t GD::rpcLogLevel = 1;
 BaseLib::Rpc::ServerInfo GD::serverInfo;
 Rpc::ClientSettings GD::clientSettings;
+Rpc::RpcSettings GD::rpcSettings;
+Rpc::ResponseCache GD::rpcResponseCache;
+Rpc::RpcMetrics GD::rpcMetrics;
+Rpc::RateLimiter GD::rpcRateLimiter;
+Rpc::AclCache GD::aclCache;
+std::unique_ptr<Rpc::MulticallPool> GD::multicallPool;
 std::map<int32_t, std::unique_ptr<BaseLib::Licensing::Licensing>> GD::licensingModules;
 std::unique_ptr<UPnP> GD::uPnP(new UPnP());
 std::unique_ptr<Mqtt> GD::mqtt;
@@ -65,6 +71,7 @@ std::unique_ptr<ScriptEngine::ScriptEngineServer> GD::scriptEngineServer;
 std::unique_ptr<IpcServer> GD::ipcServer;
 std::unique_ptr<NodeBlue::NodeBlueServer> GD::nodeBlueServer;
 std::unique_ptr<SystemVariableController> GD::systemVariableController;
+std::unique_ptr<VariableHistory> GD::variableHistory;
 std::unique_ptr<IpcLogger> GD::ipcLogger;
 
 }
\ No newline at end of file
@@ -45,9 +45,15 @@
 #include "../UI/UiController.h"
 #include "../RPC/RpcServer.h"
 #include "../RPC/Client.h"
+#include "../RPC/RpcSettings.h"
+#include "../RPC/ResponseCache.h"
+#include "../RPC/RpcMetrics.h"
+#include "../RPC/AclCache.h"
+#include "../RPC/MulticallPool.h"
 #include "../MQTT/Mqtt.h"
 #include "../IpcLogger.h"
 #include "../Database/SystemVariableController.h"
+#include "../Database/VariableHistory.h"
 #include <homegear-base/BaseLib.h>
 
 #include <vector>
@@ -88,12 +94,19 @@ public:
 	static std::unique_ptr<NodeBlue::NodeBlueServer> nodeBlueServer;
 	static BaseLib::Rpc::ServerInfo serverInfo;
 	static Rpc::ClientSettings clientSettings;
+	static Rpc::RpcSettings rpcSettings;
+	static Rpc::ResponseCache rpcResponseCache;
+	static Rpc::RpcMetrics rpcMetrics;
+	static Rpc::RateLimiter rpcRateLimiter;
+	static Rpc::AclCache aclCache;
+	static std::unique_ptr<Rpc::MulticallPool> multicallPool;
 	static int32_t rpcLogLevel;
 	static std::map<int32_t, std::unique_ptr<BaseLib::Licensing::Licensing>> licensingModules;
 	static std::unique_ptr<UPnP> uPnP;
 	static std::unique_ptr<Mqtt> mqtt;
 	static std::unique_ptr<UiController> uiController;
     static std::unique_ptr<SystemVariableController> systemVariableController;
+	static std::unique_ptr<VariableHistory> variableHistory;
 	static std::unique_ptr<IpcLogger> ipcLogger;
 #ifdef EVENTHANDLER
 	static std::unique_ptr<EventHandler> eventHandler;
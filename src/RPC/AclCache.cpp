@@ -0,0 +1,212 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "../GD/GD.h"
+#include "AclCache.h"
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+uint64_t AclCache::currentVersion()
+{
+    return GD::rpcResponseCache.version() + _version;
+}
+
+int32_t AclCache::get(const std::shared_ptr<BaseLib::Security::Acls>& acls, const std::string& key)
+{
+    std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+    auto clientIterator = _clients.find(acls.get());
+    if(clientIterator == _clients.end() || clientIterator->second.version != currentVersion() || clientIterator->second.acls.lock() != acls)
+    {
+        _misses++;
+        return -1;
+    }
+    auto decisionIterator = clientIterator->second.decisions.find(key);
+    if(decisionIterator == clientIterator->second.decisions.end())
+    {
+        _misses++;
+        return -1;
+    }
+    _hits++;
+    return decisionIterator->second ? 1 : 0;
+}
+
+void AclCache::set(const std::shared_ptr<BaseLib::Security::Acls>& acls, const std::string& key, bool decision, uint64_t version)
+{
+    std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+    if(version != currentVersion()) return;
+
+    auto clientIterator = _clients.find(acls.get());
+    if(clientIterator == _clients.end())
+    {
+        //Remove clients which were destroyed without calling remove().
+        if(_clients.size() >= 1000)
+        {
+            for(auto i = _clients.begin(); i != _clients.end();)
+            {
+                if(i->second.acls.expired()) i = _clients.erase(i);
+                else ++i;
+            }
+        }
+        clientIterator = _clients.emplace(acls.get(), ClientDecisions()).first;
+    }
+    auto& client = clientIterator->second;
+    if(client.version != version || client.acls.lock() != acls || client.decisions.size() >= _maxDecisions)
+    {
+        client.acls = acls;
+        client.version = version;
+        client.decisions.clear();
+    }
+    client.decisions[key] = decision;
+}
+
+std::shared_ptr<BaseLib::Systems::Peer> AclCache::getPeer(uint64_t peerId)
+{
+    std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
+    for(std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>::iterator i = families.begin(); i != families.end(); ++i)
+    {
+        std::shared_ptr<BaseLib::Systems::ICentral> central = i->second->getCentral();
+        if(!central) continue;
+        auto peer = central->getPeer(peerId);
+        if(peer) return peer;
+    }
+    return std::shared_ptr<BaseLib::Systems::Peer>();
+}
+
+bool AclCache::checkVariableReadAccess(const std::shared_ptr<BaseLib::Security::Acls>& acls, uint64_t peerId, int32_t channel, const std::string& variableName, std::shared_ptr<BaseLib::Systems::Peer>& peer)
+{
+    try
+    {
+        std::string key = "r" + std::to_string(peerId) + "." + std::to_string(channel) + "." + variableName;
+        int32_t decision = get(acls, key);
+        if(decision != -1) return decision == 1;
+
+        uint64_t version = currentVersion();
+        if(!peer) peer = getPeer(peerId);
+        //Unknown peers are not cached, so the decision is made again once the peer exists.
+        if(!peer) return false;
+        bool access = acls->checkVariableReadAccess(peer, channel, variableName);
+        set(acls, key, access, version);
+        return access;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return false;
+}
+
+bool AclCache::checkVariableWriteAccess(const std::shared_ptr<BaseLib::Security::Acls>& acls, uint64_t peerId, int32_t channel, const std::string& variableName, std::shared_ptr<BaseLib::Systems::Peer>& peer)
+{
+    try
+    {
+        std::string key = "w" + std::to_string(peerId) + "." + std::to_string(channel) + "." + variableName;
+        int32_t decision = get(acls, key);
+        if(decision != -1) return decision == 1;
+
+        uint64_t version = currentVersion();
+        if(!peer) peer = getPeer(peerId);
+        if(!peer) return false;
+        bool access = acls->checkVariableWriteAccess(peer, channel, variableName);
+        set(acls, key, access, version);
+        return access;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return false;
+}
+
+bool AclCache::checkSystemVariableReadAccess(const std::shared_ptr<BaseLib::Security::Acls>& acls, const std::string& variableName)
+{
+    try
+    {
+        std::string key = "s" + variableName;
+        int32_t decision = get(acls, key);
+        if(decision != -1) return decision == 1;
+
+        uint64_t version = currentVersion();
+        auto systemVariable = GD::systemVariableController->getInternal(variableName);
+        if(!systemVariable) return false;
+        bool access = acls->checkSystemVariableReadAccess(systemVariable);
+        set(acls, key, access, version);
+        return access;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return false;
+}
+
+void AclCache::remove(const std::shared_ptr<BaseLib::Security::Acls>& acls)
+{
+    try
+    {
+        if(!acls) return;
+        std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+        _clients.erase(acls.get());
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+BaseLib::PVariable AclCache::getMetrics()
+{
+    try
+    {
+        auto metrics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        uint64_t hits = _hits;
+        uint64_t misses = _misses;
+        {
+            std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+            metrics->structValue->emplace("aclCacheClients", std::make_shared<BaseLib::Variable>((int64_t)_clients.size()));
+        }
+        metrics->structValue->emplace("aclCacheHits", std::make_shared<BaseLib::Variable>((int64_t)hits));
+        metrics->structValue->emplace("aclCacheMisses", std::make_shared<BaseLib::Variable>((int64_t)misses));
+        metrics->structValue->emplace("aclCacheHitRate", std::make_shared<BaseLib::Variable>(hits + misses > 0 ? (double)hits / (hits + misses) : 0.0));
+        return metrics;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+}
+
+}
@@ -0,0 +1,143 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef ACLCACHE_H_
+#define ACLCACHE_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+/**
+ * Caches the results of variable ACL checks per client, so the rules of a client don't have to be evaluated against
+ * the peer, its room, its categories and its roles on every call and every event. Clients are identified by their
+ * "Acls" object. The decisions of all clients are discarded when devices, their metadata or ACLs change, which is
+ * detected by the version of the RPC response cache, or when invalidate() is called. The class is thread safe.
+ */
+class AclCache
+{
+public:
+    /**
+     * Invalidates the cache when it goes out of scope. Used by RPC methods changing system variables, which don't affect
+     * the RPC response cache.
+     */
+    class InvalidationGuard
+    {
+    public:
+        explicit InvalidationGuard(AclCache& cache) : _cache(cache) {}
+
+        ~InvalidationGuard() { _cache.invalidate(); }
+    private:
+        AclCache& _cache;
+    };
+
+    AclCache() = default;
+
+    virtual ~AclCache() = default;
+
+    /**
+     * Checks if a client may read a variable of a peer.
+     *
+     * @param peer The peer if it is already known. If empty, it is looked up on a cache miss and returned, so it can be
+     *             reused for further checks.
+     */
+    bool checkVariableReadAccess(const std::shared_ptr<BaseLib::Security::Acls>& acls, uint64_t peerId, int32_t channel, const std::string& variableName, std::shared_ptr<BaseLib::Systems::Peer>& peer);
+
+    /**
+     * Checks if a client may write a variable of a peer. "peer" is handled like in checkVariableReadAccess().
+     */
+    bool checkVariableWriteAccess(const std::shared_ptr<BaseLib::Security::Acls>& acls, uint64_t peerId, int32_t channel, const std::string& variableName, std::shared_ptr<BaseLib::Systems::Peer>& peer);
+
+    /**
+     * Checks if a client may read a system variable.
+     */
+    bool checkSystemVariableReadAccess(const std::shared_ptr<BaseLib::Security::Acls>& acls, const std::string& variableName);
+
+    /**
+     * Removes the decisions of a client. Called when the client disconnects.
+     */
+    void remove(const std::shared_ptr<BaseLib::Security::Acls>& acls);
+
+    /**
+     * Discards the decisions of all clients.
+     */
+    void invalidate() { _version++; }
+
+    BaseLib::PVariable getMetrics();
+private:
+    /**
+     * Decisions are discarded, when a client has more.
+     */
+    static const size_t _maxDecisions = 10000;
+
+    struct ClientDecisions
+    {
+        std::weak_ptr<BaseLib::Security::Acls> acls;
+        uint64_t version = 0;
+        std::unordered_map<std::string, bool> decisions;
+    };
+
+    std::mutex _clientsMutex;
+    std::unordered_map<BaseLib::Security::Acls*, ClientDecisions> _clients;
+    std::atomic<uint64_t> _version{0};
+    std::atomic<uint64_t> _hits{0};
+    std::atomic<uint64_t> _misses{0};
+
+    /**
+     * Looks up a decision.
+     *
+     * @return 1 when access is granted, 0 when it is denied and -1 when the decision is not cached.
+     */
+    int32_t get(const std::shared_ptr<BaseLib::Security::Acls>& acls, const std::string& key);
+
+    void set(const std::shared_ptr<BaseLib::Security::Acls>& acls, const std::string& key, bool decision, uint64_t version);
+
+    /**
+     * Both versions only grow, so their sum changes whenever one of them does.
+     */
+    uint64_t currentVersion();
+
+    static std::shared_ptr<BaseLib::Systems::Peer> getPeer(uint64_t peerId);
+};
+
+}
+
+}
+
+#endif
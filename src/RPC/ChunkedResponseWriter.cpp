@@ -0,0 +1,118 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "ChunkedResponseWriter.h"
+
+#include <cstdint>
+#include <cstdio>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+ChunkedResponseWriter::ChunkedResponseWriter(Mode mode, const std::string& httpHeader, WriteCallback writeCallback, size_t chunkSize) : _mode(mode), _httpHeader(httpHeader), _writeCallback(std::move(writeCallback)), _chunkSize(chunkSize)
+{
+    _buffer.reserve(_chunkSize + 1024);
+    _output.reserve(_chunkSize + 1024);
+}
+
+bool ChunkedResponseWriter::write(const std::string& data)
+{
+    if(_finished) return false;
+    _buffer.insert(_buffer.end(), data.begin(), data.end());
+    if(_buffer.size() >= _chunkSize) return flush(false);
+    return true;
+}
+
+bool ChunkedResponseWriter::finish()
+{
+    if(_finished) return false;
+    return flush(true);
+}
+
+bool ChunkedResponseWriter::flush(bool final)
+{
+    _output.clear();
+    if(_mode == Mode::http)
+    {
+        if(!_started) _output.insert(_output.end(), _httpHeader.begin(), _httpHeader.end());
+        if(!_buffer.empty())
+        {
+            char chunkHeader[20];
+            int32_t headerSize = snprintf(chunkHeader, sizeof(chunkHeader), "%zx\r\n", _buffer.size());
+            _output.insert(_output.end(), chunkHeader, chunkHeader + headerSize);
+            _output.insert(_output.end(), _buffer.begin(), _buffer.end());
+            _output.push_back('\r');
+            _output.push_back('\n');
+        }
+        if(final)
+        {
+            const std::string lastChunk = "0\r\n\r\n";
+            _output.insert(_output.end(), lastChunk.begin(), lastChunk.end());
+        }
+    }
+    else
+    {
+        //The first frame has the opcode "text", all following frames are continuation frames. Only the last frame has FIN set.
+        _output.push_back((char)((final ? 0x80 : 0) | (_started ? 0 : 1)));
+        if(_buffer.size() < 126) _output.push_back((char)_buffer.size());
+        else if(_buffer.size() <= 0xFFFF)
+        {
+            _output.push_back((char)126);
+            _output.push_back((char)(_buffer.size() >> 8));
+            _output.push_back((char)(_buffer.size() & 0xFF));
+        }
+        else
+        {
+            _output.push_back((char)127);
+            for(int32_t i = 56; i >= 0; i -= 8)
+            {
+                _output.push_back((char)(((uint64_t)_buffer.size() >> i) & 0xFF));
+            }
+        }
+        _output.insert(_output.end(), _buffer.begin(), _buffer.end());
+    }
+    _buffer.clear();
+    _started = true;
+    if(final) _finished = true;
+    _bytesWritten += _output.size();
+    if(!_writeCallback(_output))
+    {
+        _finished = true;
+        return false;
+    }
+    return true;
+}
+
+}
+
+}
@@ -0,0 +1,106 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef CHUNKEDRESPONSEWRITER_H_
+#define CHUNKEDRESPONSEWRITER_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+/**
+ * Writes a response of unknown length in parts, either with HTTP chunked transfer encoding or as fragmented WebSocket
+ * text message. Data is collected until "chunkSize" bytes are available, so the encoded response never needs to be
+ * held in memory as a whole.
+ */
+class ChunkedResponseWriter
+{
+public:
+    enum class Mode
+    {
+        http,
+        webSocket
+    };
+
+    /**
+     * Called with every encoded part. Returns false when the data could not be written.
+     */
+    typedef std::function<bool(std::vector<char>& data)> WriteCallback;
+
+    /**
+     * @param httpHeader Written before the first chunk in HTTP mode. It needs to contain "Transfer-Encoding: chunked".
+     */
+    ChunkedResponseWriter(Mode mode, const std::string& httpHeader, WriteCallback writeCallback, size_t chunkSize = 65536);
+
+    virtual ~ChunkedResponseWriter() = default;
+
+    /**
+     * @return false when writing failed. The response can't be completed in that case.
+     */
+    bool write(const std::string& data);
+
+    /**
+     * Writes the remaining data and terminates the response.
+     *
+     * @return false when writing failed.
+     */
+    bool finish();
+
+    /**
+     * @return true when data was passed to the write callback already.
+     */
+    bool started() { return _started; }
+
+    size_t bytesWritten() { return _bytesWritten; }
+private:
+    Mode _mode = Mode::http;
+    std::string _httpHeader;
+    WriteCallback _writeCallback;
+    size_t _chunkSize = 65536;
+    std::vector<char> _buffer;
+    std::vector<char> _output;
+    bool _started = false;
+    bool _finished = false;
+    size_t _bytesWritten = 0;
+
+    bool flush(bool final);
+};
+
+}
+
+}
+
+#endif
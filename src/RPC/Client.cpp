@@ -241,6 +241,7 @@ void Client::broadcastEvent(const std::string& source, uint64_t id, int32_t chan
 
         if(GD::mqtt->enabled()) GD::mqtt->queueMessage(source, id, channel, *valueKeys, *values); //ACL check is in MQTT
         std::string methodName("event");
+        std::shared_ptr<BaseLib::Systems::Peer> peer; //Only looked up by the ACL cache on a cache miss.
         std::lock_guard<std::mutex> serversGuard(_serversMutex);
         for(std::map<int32_t, std::shared_ptr<RemoteRpcServer>>::const_iterator server = _servers.begin(); server != _servers.end(); ++server)
         {
@@ -251,17 +252,6 @@ void Client::broadcastEvent(const std::string& source, uint64_t id, int32_t chan
             if(id > 0 && server->second->subscribePeers && server->second->subscribedPeers.find(id) == server->second->subscribedPeers.end()) continue;
 
             bool checkAcls = server->second->getServerClientInfo()->acls->variablesRoomsCategoriesRolesDevicesReadSet();
-            std::shared_ptr<BaseLib::Systems::Peer> peer;
-            if(checkAcls)
-            {
-                std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
-                for(std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>::iterator i = families.begin(); i != families.end(); ++i)
-                {
-                    std::shared_ptr<BaseLib::Systems::ICentral> central = i->second->getCentral();
-                    if(central) peer = central->getPeer(id);
-                    if(peer) break;
-                }
-            }
 
             if(server->second->webSocket || server->second->json)
             {
@@ -274,11 +264,10 @@ void Client::broadcastEvent(const std::string& source, uint64_t id, int32_t chan
                         {
                             if(server->second->getServerClientInfo()->acls->variablesRoomsCategoriesRolesReadSet())
                             {
-                                auto systemVariable = GD::systemVariableController->getInternal(valueKeys->at(i));
-                                if(!systemVariable || !server->second->getServerClientInfo()->acls->checkSystemVariableReadAccess(systemVariable)) continue;
+                                if(!GD::aclCache.checkSystemVariableReadAccess(server->second->getServerClientInfo()->acls, valueKeys->at(i))) continue;
                             }
                         }
-                        else if(!peer || !server->second->getServerClientInfo()->acls->checkVariableReadAccess(peer, channel, valueKeys->at(i))) continue;
+                        else if(!GD::aclCache.checkVariableReadAccess(server->second->getServerClientInfo()->acls, id, channel, valueKeys->at(i), peer)) continue;
                     }
 
                     std::shared_ptr<std::list<BaseLib::PVariable>> parameters = std::make_shared<std::list<BaseLib::PVariable>>();
@@ -307,11 +296,10 @@ void Client::broadcastEvent(const std::string& source, uint64_t id, int32_t chan
                         {
                             if(server->second->getServerClientInfo()->acls->variablesRoomsCategoriesRolesReadSet())
                             {
-                                auto systemVariable = GD::systemVariableController->getInternal(valueKeys->at(i));
-                                if(!systemVariable || !server->second->getServerClientInfo()->acls->checkSystemVariableReadAccess(systemVariable)) continue;
+                                if(!GD::aclCache.checkSystemVariableReadAccess(server->second->getServerClientInfo()->acls, valueKeys->at(i))) continue;
                             }
                         }
-                        else if(!peer || !server->second->getServerClientInfo()->acls->checkVariableReadAccess(peer, channel, valueKeys->at(i))) continue;
+                        else if(!GD::aclCache.checkVariableReadAccess(server->second->getServerClientInfo()->acls, id, channel, valueKeys->at(i), peer)) continue;
                     }
 
                     method.reset(new BaseLib::Variable(BaseLib::VariableType::tStruct));
@@ -581,6 +569,7 @@ void Client::broadcastNewDevices(std::vector<uint64_t>& ids, BaseLib::PVariable
     try
     {
         if(!deviceDescriptions || ids.empty()) return;
+        GD::rpcResponseCache.invalidate();
         GD::nodeBlueServer->broadcastNewDevices(ids, deviceDescriptions);
 #ifndef NO_SCRIPTENGINE
         GD::scriptEngineServer->broadcastNewDevices(ids, deviceDescriptions);
@@ -668,6 +657,7 @@ void Client::broadcastDeleteDevices(std::vector<uint64_t>& ids, BaseLib::PVariab
     try
     {
         if(!deviceAddresses || !deviceInfo) return;
+        GD::rpcResponseCache.invalidate();
         GD::nodeBlueServer->broadcastDeleteDevices(deviceInfo);
 #ifndef NO_SCRIPTENGINE
         GD::scriptEngineServer->broadcastDeleteDevices(deviceInfo);
@@ -728,6 +718,7 @@ void Client::broadcastUpdateDevice(uint64_t id, int32_t channel, std::string add
     try
     {
         if(id == 0 || address.empty()) return;
+        GD::rpcResponseCache.invalidate();
         GD::nodeBlueServer->broadcastUpdateDevice(id, channel, hint);
 #ifndef NO_SCRIPTENGINE
         GD::scriptEngineServer->broadcastUpdateDevice(id, channel, hint);
@@ -992,7 +983,7 @@ std::shared_ptr<RemoteRpcServer> Client::addSingleConnectionServer(std::pair<std
     return std::make_shared<RemoteRpcServer>(_client, clientInfo);
 }
 
-std::shared_ptr<RemoteRpcServer> Client::addWebSocketServer(std::shared_ptr<BaseLib::TcpSocket> socket, std::string clientId, BaseLib::PRpcClientInfo clientInfo, std::string address, bool nodeEvents)
+std::shared_ptr<RemoteRpcServer> Client::addWebSocketServer(std::shared_ptr<BaseLib::TcpSocket> socket, std::string clientId, BaseLib::PRpcClientInfo clientInfo, std::string address, bool nodeEvents, std::shared_ptr<WebSocketDeflate> webSocketDeflate, int32_t eventBatchWindow, bool messagePack)
 {
     try
     {
@@ -1012,6 +1003,9 @@ std::shared_ptr<RemoteRpcServer> Client::addWebSocketServer(std::shared_ptr<Base
         server->hostname = address;
         server->uid = _serverId++;
         server->webSocket = true;
+        server->webSocketDeflate = webSocketDeflate;
+        server->eventBatchWindow = eventBatchWindow;
+        server->messagePack = messagePack;
         server->autoConnect = false;
         server->initialized = true;
         if(!clientInfo->sendEventsToRpcServer)
@@ -115,7 +115,7 @@ public:
 
 	std::shared_ptr<RemoteRpcServer> addSingleConnectionServer(std::pair<std::string, std::string> address, BaseLib::PRpcClientInfo clientInfo, std::string id);
 
-	std::shared_ptr<RemoteRpcServer> addWebSocketServer(std::shared_ptr<BaseLib::TcpSocket> socket, std::string clientId, BaseLib::PRpcClientInfo clientInfo, std::string address, bool nodeEvents);
+	std::shared_ptr<RemoteRpcServer> addWebSocketServer(std::shared_ptr<BaseLib::TcpSocket> socket, std::string clientId, BaseLib::PRpcClientInfo clientInfo, std::string address, bool nodeEvents, std::shared_ptr<WebSocketDeflate> webSocketDeflate = std::shared_ptr<WebSocketDeflate>(), int32_t eventBatchWindow = 0, bool messagePack = false);
 
 	void removeServer(std::pair<std::string, std::string> address);
 
@@ -0,0 +1,203 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "../GD/GD.h"
+#include "MessagePackDecoder.h"
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+uint64_t MessagePackDecoder::readBigEndian(const std::vector<char>& data, size_t& position, int32_t bytes)
+{
+    if(position + bytes > data.size()) throw MessagePackDecoderException("Unexpected end of data.");
+    uint64_t value = 0;
+    for(int32_t i = 0; i < bytes; i++)
+    {
+        value = (value << 8) | (uint8_t)data[position++];
+    }
+    return value;
+}
+
+std::string MessagePackDecoder::readString(const std::vector<char>& data, size_t& position, size_t size)
+{
+    if(size > data.size() - position) throw MessagePackDecoderException("Unexpected end of data.");
+    std::string value(data.data() + position, size);
+    position += size;
+    return value;
+}
+
+BaseLib::PVariable MessagePackDecoder::decodeVariable(const std::vector<char>& data, size_t& position, int32_t depth)
+{
+    if(depth > _maxDepth) throw MessagePackDecoderException("Data is nested too deeply.");
+    uint8_t type = (uint8_t)readBigEndian(data, position, 1);
+
+    int64_t integerValue = 0;
+    size_t size = 0;
+    if(type <= 0x7F) integerValue = type;
+    else if(type >= 0xE0) integerValue = (int8_t)type;
+    else if(type >= 0xA0 && type <= 0xBF) return std::make_shared<BaseLib::Variable>(readString(data, position, type & 0x1F));
+    else if((type >= 0x90 && type <= 0x9F) || type == 0xDC || type == 0xDD)
+    {
+        if(type == 0xDC) size = readBigEndian(data, position, 2);
+        else if(type == 0xDD) size = readBigEndian(data, position, 4);
+        else size = type & 0x0F;
+        //Every element needs at least one byte.
+        if(size > data.size() - position) throw MessagePackDecoderException("Unexpected end of data.");
+        auto array = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+        array->arrayValue->reserve(size);
+        for(size_t i = 0; i < size; i++)
+        {
+            array->arrayValue->push_back(decodeVariable(data, position, depth + 1));
+        }
+        return array;
+    }
+    else if((type >= 0x80 && type <= 0x8F) || type == 0xDE || type == 0xDF)
+    {
+        if(type == 0xDE) size = readBigEndian(data, position, 2);
+        else if(type == 0xDF) size = readBigEndian(data, position, 4);
+        else size = type & 0x0F;
+        auto map = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        for(size_t i = 0; i < size; i++)
+        {
+            auto key = decodeVariable(data, position, depth + 1);
+            std::string name;
+            if(key->type == BaseLib::VariableType::tString) name = key->stringValue;
+            else if(key->type == BaseLib::VariableType::tInteger) name = std::to_string(key->integerValue);
+            else if(key->type == BaseLib::VariableType::tInteger64) name = std::to_string(key->integerValue64);
+            else throw MessagePackDecoderException("Unsupported map key type.");
+            (*map->structValue)[name] = decodeVariable(data, position, depth + 1);
+        }
+        return map;
+    }
+    else
+    {
+        switch(type)
+        {
+            case 0xC0:
+                return std::make_shared<BaseLib::Variable>();
+            case 0xC2:
+                return std::make_shared<BaseLib::Variable>(false);
+            case 0xC3:
+                return std::make_shared<BaseLib::Variable>(true);
+            case 0xC4:
+            case 0xC5:
+            case 0xC6:
+            {
+                size = readBigEndian(data, position, type == 0xC4 ? 1 : (type == 0xC5 ? 2 : 4));
+                if(size > data.size() - position) throw MessagePackDecoderException("Unexpected end of data.");
+                std::vector<uint8_t> binary(data.begin() + position, data.begin() + position + size);
+                position += size;
+                return std::make_shared<BaseLib::Variable>(binary);
+            }
+            case 0xCA:
+            {
+                uint32_t bits = (uint32_t)readBigEndian(data, position, 4);
+                float value = 0;
+                std::memcpy(&value, &bits, sizeof(value));
+                return std::make_shared<BaseLib::Variable>((double)value);
+            }
+            case 0xCB:
+            {
+                uint64_t bits = readBigEndian(data, position, 8);
+                double value = 0;
+                std::memcpy(&value, &bits, sizeof(value));
+                return std::make_shared<BaseLib::Variable>(value);
+            }
+            case 0xCC:
+                integerValue = (int64_t)readBigEndian(data, position, 1);
+                break;
+            case 0xCD:
+                integerValue = (int64_t)readBigEndian(data, position, 2);
+                break;
+            case 0xCE:
+                integerValue = (int64_t)readBigEndian(data, position, 4);
+                break;
+            case 0xCF:
+            {
+                //Variables can't hold unsigned 64 bit integers. Casting would turn large values negative.
+                uint64_t value = readBigEndian(data, position, 8);
+                if(value > (uint64_t)INT64_MAX) throw MessagePackDecoderException("Unsigned integer " + std::to_string(value) + " is out of range.");
+                integerValue = (int64_t)value;
+                break;
+            }
+            case 0xD0:
+                integerValue = (int8_t)readBigEndian(data, position, 1);
+                break;
+            case 0xD1:
+                integerValue = (int16_t)readBigEndian(data, position, 2);
+                break;
+            case 0xD2:
+                integerValue = (int32_t)readBigEndian(data, position, 4);
+                break;
+            case 0xD3:
+                integerValue = (int64_t)readBigEndian(data, position, 8);
+                break;
+            case 0xD9:
+            case 0xDA:
+            case 0xDB:
+                size = readBigEndian(data, position, type == 0xD9 ? 1 : (type == 0xDA ? 2 : 4));
+                return std::make_shared<BaseLib::Variable>(readString(data, position, size));
+            default:
+                throw MessagePackDecoderException("Unsupported type " + BaseLib::HelperFunctions::getHexString((int32_t)type, 2) + ".");
+        }
+    }
+
+    if(integerValue >= INT32_MIN && integerValue <= INT32_MAX) return std::make_shared<BaseLib::Variable>((int32_t)integerValue);
+    return std::make_shared<BaseLib::Variable>(integerValue);
+}
+
+BaseLib::PVariable MessagePackDecoder::decode(const std::vector<char>& data)
+{
+    size_t position = 0;
+    return decodeVariable(data, position, 0);
+}
+
+BaseLib::PVariable MessagePackDecoder::decodeResponse(const std::vector<char>& data)
+{
+    BaseLib::PVariable response = decode(data);
+    if(response->type != BaseLib::VariableType::tStruct) return BaseLib::Variable::createError(-32700, "Response is no map.");
+    auto resultIterator = response->structValue->find("result");
+    if(resultIterator != response->structValue->end()) return resultIterator->second;
+    auto errorIterator = response->structValue->find("error");
+    if(errorIterator != response->structValue->end() && errorIterator->second->type == BaseLib::VariableType::tStruct)
+    {
+        auto codeIterator = errorIterator->second->structValue->find("code");
+        auto messageIterator = errorIterator->second->structValue->find("message");
+        return BaseLib::Variable::createError(codeIterator == errorIterator->second->structValue->end() ? -1 : codeIterator->second->integerValue, messageIterator == errorIterator->second->structValue->end() ? "" : messageIterator->second->stringValue);
+    }
+    return std::make_shared<BaseLib::Variable>();
+}
+
+}
+
+}
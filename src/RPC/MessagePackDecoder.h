@@ -0,0 +1,91 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef MESSAGEPACKDECODER_H_
+#define MESSAGEPACKDECODER_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <string>
+#include <vector>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+class MessagePackDecoderException : public BaseLib::Exception
+{
+public:
+    MessagePackDecoderException(std::string message) : BaseLib::Exception(message) {}
+};
+
+/**
+ * Decodes data in the MessagePack format. Extension types and unsigned integers above INT64_MAX are not supported.
+ */
+class MessagePackDecoder
+{
+public:
+    MessagePackDecoder() = default;
+
+    virtual ~MessagePackDecoder() = default;
+
+    /**
+     * Decodes one value.
+     *
+     * @throws MessagePackDecoderException
+     */
+    BaseLib::PVariable decode(const std::vector<char>& data);
+
+    /**
+     * Decodes a response in the structure of JSON-RPC 2.0 and returns its result. Errors are returned as error structs.
+     *
+     * @throws MessagePackDecoderException
+     */
+    BaseLib::PVariable decodeResponse(const std::vector<char>& data);
+private:
+    /**
+     * Limits the nesting of arrays and maps, so malformed data can't exhaust the stack.
+     */
+    static const int32_t _maxDepth = 100;
+
+    BaseLib::PVariable decodeVariable(const std::vector<char>& data, size_t& position, int32_t depth);
+
+    static uint64_t readBigEndian(const std::vector<char>& data, size_t& position, int32_t bytes);
+
+    static std::string readString(const std::vector<char>& data, size_t& position, size_t size);
+};
+
+}
+
+}
+
+#endif
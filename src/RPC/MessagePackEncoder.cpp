@@ -0,0 +1,214 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "../GD/GD.h"
+#include "MessagePackEncoder.h"
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+void MessagePackEncoder::appendBigEndian(uint64_t value, int32_t bytes, std::vector<char>& data)
+{
+    for(int32_t i = (bytes - 1) * 8; i >= 0; i -= 8)
+    {
+        data.push_back((char)((value >> i) & 0xFF));
+    }
+}
+
+void MessagePackEncoder::encodeHeader(size_t size, uint8_t fixType, uint8_t fixMaxSize, uint8_t type8, uint8_t type16, uint8_t type32, std::vector<char>& data)
+{
+    if(size <= fixMaxSize && fixType != 0) data.push_back((char)(fixType | size));
+    else if(size <= 0xFF && type8 != 0)
+    {
+        data.push_back((char)type8);
+        appendBigEndian(size, 1, data);
+    }
+    else if(size <= 0xFFFF)
+    {
+        data.push_back((char)type16);
+        appendBigEndian(size, 2, data);
+    }
+    else
+    {
+        data.push_back((char)type32);
+        appendBigEndian(size, 4, data);
+    }
+}
+
+void MessagePackEncoder::encodeInteger(int64_t value, std::vector<char>& data)
+{
+    if(value >= 0 && value <= 127) data.push_back((char)value);
+    else if(value < 0 && value >= -32) data.push_back((char)(0xE0 | (value + 32)));
+    else if(value >= INT8_MIN && value <= INT8_MAX)
+    {
+        data.push_back((char)0xD0);
+        appendBigEndian((uint64_t)value, 1, data);
+    }
+    else if(value >= INT16_MIN && value <= INT16_MAX)
+    {
+        data.push_back((char)0xD1);
+        appendBigEndian((uint64_t)value, 2, data);
+    }
+    else if(value >= INT32_MIN && value <= INT32_MAX)
+    {
+        data.push_back((char)0xD2);
+        appendBigEndian((uint64_t)value, 4, data);
+    }
+    else
+    {
+        data.push_back((char)0xD3);
+        appendBigEndian((uint64_t)value, 8, data);
+    }
+}
+
+void MessagePackEncoder::encodeString(const std::string& value, std::vector<char>& data)
+{
+    encodeHeader(value.size(), 0xA0, 31, 0xD9, 0xDA, 0xDB, data);
+    data.insert(data.end(), value.begin(), value.end());
+}
+
+void MessagePackEncoder::encodeVariable(const BaseLib::PVariable& variable, std::vector<char>& data)
+{
+    if(!variable)
+    {
+        data.push_back((char)0xC0);
+        return;
+    }
+    switch(variable->type)
+    {
+        case BaseLib::VariableType::tBoolean:
+            data.push_back(variable->booleanValue ? (char)0xC3 : (char)0xC2);
+            break;
+        case BaseLib::VariableType::tInteger:
+            encodeInteger(variable->integerValue, data);
+            break;
+        case BaseLib::VariableType::tInteger64:
+            encodeInteger(variable->integerValue64, data);
+            break;
+        case BaseLib::VariableType::tFloat:
+        {
+            uint64_t bits = 0;
+            double value = variable->floatValue;
+            std::memcpy(&bits, &value, sizeof(bits));
+            data.push_back((char)0xCB);
+            appendBigEndian(bits, 8, data);
+            break;
+        }
+        case BaseLib::VariableType::tString:
+        case BaseLib::VariableType::tBase64:
+            encodeString(variable->stringValue, data);
+            break;
+        case BaseLib::VariableType::tBinary:
+            encodeHeader(variable->binaryValue.size(), 0, 0, 0xC4, 0xC5, 0xC6, data);
+            data.insert(data.end(), variable->binaryValue.begin(), variable->binaryValue.end());
+            break;
+        case BaseLib::VariableType::tArray:
+            encodeHeader(variable->arrayValue->size(), 0x90, 15, 0, 0xDC, 0xDD, data);
+            for(auto& element : *variable->arrayValue)
+            {
+                encodeVariable(element, data);
+            }
+            break;
+        case BaseLib::VariableType::tStruct:
+            encodeHeader(variable->structValue->size(), 0x80, 15, 0, 0xDE, 0xDF, data);
+            for(auto& element : *variable->structValue)
+            {
+                encodeString(element.first, data);
+                encodeVariable(element.second, data);
+            }
+            break;
+        default:
+            data.push_back((char)0xC0);
+            break;
+    }
+}
+
+void MessagePackEncoder::encode(const BaseLib::PVariable& variable, std::vector<char>& data)
+{
+    try
+    {
+        data.clear();
+        data.reserve(1024);
+        encodeVariable(variable, data);
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+void MessagePackEncoder::encodeRequest(const std::string& methodName, const std::shared_ptr<std::list<BaseLib::PVariable>>& parameters, std::vector<char>& data)
+{
+    try
+    {
+        auto request = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        request->structValue->emplace("jsonrpc", std::make_shared<BaseLib::Variable>(std::string("2.0")));
+        request->structValue->emplace("method", std::make_shared<BaseLib::Variable>(methodName));
+        auto params = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+        if(parameters) params->arrayValue->insert(params->arrayValue->end(), parameters->begin(), parameters->end());
+        request->structValue->emplace("params", params);
+        request->structValue->emplace("id", std::make_shared<BaseLib::Variable>(_requestId++));
+        encode(request, data);
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+void MessagePackEncoder::encodeResponse(const BaseLib::PVariable& variable, int32_t id, std::vector<char>& data)
+{
+    try
+    {
+        auto response = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        response->structValue->emplace("jsonrpc", std::make_shared<BaseLib::Variable>(std::string("2.0")));
+        if(variable->errorStruct)
+        {
+            auto error = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+            error->structValue->emplace("code", variable->structValue->at("faultCode"));
+            error->structValue->emplace("message", variable->structValue->at("faultString"));
+            response->structValue->emplace("error", error);
+        }
+        else response->structValue->emplace("result", variable);
+        response->structValue->emplace("id", std::make_shared<BaseLib::Variable>(id));
+        encode(response, data);
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+}
+
+}
@@ -0,0 +1,81 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef MESSAGEPACKENCODER_H_
+#define MESSAGEPACKENCODER_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <atomic>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+/**
+ * Encodes variables in the MessagePack format. RPC requests and responses use the structure of JSON-RPC 2.0, so they
+ * only differ from JSON-RPC in their encoding.
+ */
+class MessagePackEncoder
+{
+public:
+    MessagePackEncoder() = default;
+
+    virtual ~MessagePackEncoder() = default;
+
+    void encode(const BaseLib::PVariable& variable, std::vector<char>& data);
+
+    void encodeRequest(const std::string& methodName, const std::shared_ptr<std::list<BaseLib::PVariable>>& parameters, std::vector<char>& data);
+
+    void encodeResponse(const BaseLib::PVariable& variable, int32_t id, std::vector<char>& data);
+private:
+    std::atomic<int32_t> _requestId{1};
+
+    void encodeVariable(const BaseLib::PVariable& variable, std::vector<char>& data);
+
+    static void encodeInteger(int64_t value, std::vector<char>& data);
+
+    static void encodeString(const std::string& value, std::vector<char>& data);
+
+    static void encodeHeader(size_t size, uint8_t fixType, uint8_t fixMaxSize, uint8_t type8, uint8_t type16, uint8_t type32, std::vector<char>& data);
+
+    static void appendBigEndian(uint64_t value, int32_t bytes, std::vector<char>& data);
+};
+
+}
+
+}
+
+#endif
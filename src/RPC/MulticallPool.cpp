@@ -0,0 +1,133 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "../GD/GD.h"
+#include "MulticallPool.h"
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+MulticallPool::MulticallPool() : IQueue(GD::bl.get(), 1, 1000)
+{
+}
+
+MulticallPool::~MulticallPool()
+{
+    stop();
+}
+
+void MulticallPool::start()
+{
+    try
+    {
+        std::lock_guard<std::mutex> startGuard(_startMutex);
+        if(_started || !GD::rpcSettings.multicallParallel() || GD::rpcSettings.multicallMaxConcurrency() < 2) return;
+        _threadCount = GD::rpcSettings.multicallMaxConcurrency() - 1;
+        startQueue(0, false, _threadCount, 0, SCHED_OTHER);
+        _started = true;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void MulticallPool::stop()
+{
+    try
+    {
+        std::lock_guard<std::mutex> startGuard(_startMutex);
+        if(!_started) return;
+        _started = false;
+        stopQueue(0);
+        _threadCount = 0;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+size_t MulticallPool::maxConcurrency()
+{
+    return _started ? _threadCount + 1 : 1;
+}
+
+bool MulticallPool::execute(std::function<void()> function)
+{
+    try
+    {
+        if(!_started) return false;
+        std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(std::move(function));
+        return enqueue(0, queueEntry);
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return false;
+}
+
+void MulticallPool::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueueEntry>& entry)
+{
+    try
+    {
+        std::shared_ptr<QueueEntry> queueEntry = std::dynamic_pointer_cast<QueueEntry>(entry);
+        if(!queueEntry || !queueEntry->function) return;
+        queueEntry->function();
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+}
+
+}
@@ -0,0 +1,91 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef MULTICALLPOOL_H_
+#define MULTICALLPOOL_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <functional>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+/**
+ * Worker threads shared by all calls to "system.multicall". The threads only help: the thread executing the multicall
+ * always works on its calls itself, so multicalls finish even when all workers are busy.
+ */
+class MulticallPool : public BaseLib::IQueue
+{
+public:
+    MulticallPool();
+    ~MulticallPool() override;
+
+    /**
+     * Starts "multicallMaxConcurrency - 1" threads when "multicallParallel" is enabled.
+     */
+    void start();
+    void stop();
+
+    /**
+     * Returns the maximum number of threads working on one multicall including the calling thread.
+     */
+    size_t maxConcurrency();
+
+    /**
+     * Queues "function" for execution by one of the worker threads.
+     *
+     * @return false when the pool is not running or the queue is full.
+     */
+    bool execute(std::function<void()> function);
+protected:
+    class QueueEntry : public BaseLib::IQueueEntry
+    {
+    public:
+        explicit QueueEntry(std::function<void()> function) : function(std::move(function)) {}
+
+        std::function<void()> function;
+    };
+
+    std::mutex _startMutex;
+    std::atomic_bool _started{false};
+    std::atomic<size_t> _threadCount{0};
+
+    void processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueueEntry>& entry) override;
+};
+
+}
+
+}
+
+#endif
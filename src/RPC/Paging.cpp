@@ -0,0 +1,218 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "../GD/GD.h"
+#include "Paging.h"
+
+#include <algorithm>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+std::mutex Paging::_peerOrdersMutex;
+std::map<std::string, Paging::PPeerOrder> Paging::_peerOrders;
+
+BaseLib::PVariable Paging::fromParameters(BaseLib::PArray& parameters, ItemType itemType, std::unique_ptr<Paging>& paging)
+{
+    paging.reset();
+    if(parameters->empty() || parameters->back()->type != BaseLib::VariableType::tStruct) return BaseLib::PVariable();
+    paging.reset(new Paging());
+    auto error = paging->parse(parameters->back(), itemType);
+    if(error) return error;
+    parameters = std::make_shared<BaseLib::Array>(parameters->begin(), parameters->end() - 1);
+    return BaseLib::PVariable();
+}
+
+BaseLib::PVariable Paging::parse(const BaseLib::PVariable& options, ItemType itemType)
+{
+    try
+    {
+        auto limitIterator = options->structValue->find("limit");
+        if(limitIterator == options->structValue->end() || limitIterator->second->integerValue64 < 1) return BaseLib::Variable::createError(-1, "\"limit\" is missing or smaller than 1.");
+        _limit = limitIterator->second->integerValue64 > 1000000 ? 1000000 : (int32_t)limitIterator->second->integerValue64;
+
+        auto cursorIterator = options->structValue->find("cursor");
+        if(cursorIterator == options->structValue->end() || cursorIterator->second->stringValue.empty()) return BaseLib::PVariable();
+
+        //Cursors are "p<family ID>,<peer ID>" for peers and "s<name>" for system variables.
+        std::string cursor;
+        BaseLib::Base64::decode(cursorIterator->second->stringValue, cursor);
+        if(cursor.size() > 1 && cursor.front() == 'p' && itemType == ItemType::peers)
+        {
+            auto parts = BaseLib::HelperFunctions::splitFirst(cursor.substr(1), ',');
+            if(parts.second.empty()) return BaseLib::Variable::createError(-1, "Invalid cursor.");
+            _familyId = BaseLib::Math::getNumber(parts.first);
+            _peerId = BaseLib::Math::getUnsignedNumber64(parts.second);
+        }
+        else if(cursor.size() > 1 && cursor.front() == 's' && itemType == ItemType::systemVariables) _name = cursor.substr(1);
+        else return BaseLib::Variable::createError(-1, "Invalid cursor.");
+        _hasCursor = true;
+        return BaseLib::PVariable();
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return BaseLib::Variable::createError(-1, "Invalid paging parameters.");
+}
+
+Paging::PPeerOrder Paging::takePeerOrder(int32_t familyId)
+{
+    if(_hasCursor)
+    {
+        std::lock_guard<std::mutex> peerOrdersGuard(_peerOrdersMutex);
+        auto peerOrderIterator = _peerOrders.find(std::to_string(familyId) + "/p" + std::to_string(_familyId) + "," + std::to_string(_peerId));
+        if(peerOrderIterator != _peerOrders.end())
+        {
+            auto peerOrder = peerOrderIterator->second;
+            _peerOrders.erase(peerOrderIterator);
+            if(BaseLib::HelperFunctions::getTime() - peerOrder->lastUse < _peerOrderTimeout) return peerOrder;
+        }
+    }
+
+    auto peerOrder = std::make_shared<PeerOrder>();
+    std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
+    for(auto& family : families)
+    {
+        if(familyId != -1 && family.first != familyId) continue;
+        std::shared_ptr<BaseLib::Systems::ICentral> central = family.second->getCentral();
+        if(!central) continue;
+
+        std::map<uint64_t, std::shared_ptr<BaseLib::Systems::Peer>> peers;
+        for(auto& peer : central->getPeers())
+        {
+            peers.emplace(peer->getID(), peer);
+        }
+        peerOrder->peers.reserve(peerOrder->peers.size() + peers.size());
+        for(auto& peer : peers)
+        {
+            PeerOrder::Entry entry;
+            entry.familyId = family.first;
+            entry.peerId = peer.first;
+            entry.peer = peer.second;
+            peerOrder->peers.push_back(std::move(entry));
+        }
+    }
+    return peerOrder;
+}
+
+void Paging::storePeerOrder(int32_t familyId, const std::string& cursor, const PPeerOrder& peerOrder)
+{
+    int64_t time = BaseLib::HelperFunctions::getTime();
+    peerOrder->lastUse = time;
+    std::lock_guard<std::mutex> peerOrdersGuard(_peerOrdersMutex);
+    for(auto peerOrderIterator = _peerOrders.begin(); peerOrderIterator != _peerOrders.end();)
+    {
+        if(time - peerOrderIterator->second->lastUse >= _peerOrderTimeout) peerOrderIterator = _peerOrders.erase(peerOrderIterator);
+        else ++peerOrderIterator;
+    }
+    //Without a stored order the next page builds a new one, so dropping it is safe.
+    if(_peerOrders.size() >= _maxPeerOrders) return;
+    _peerOrders[std::to_string(familyId) + "/" + cursor] = peerOrder;
+}
+
+std::string Paging::getPeerPage(const BaseLib::PRpcClientInfo& clientInfo, int32_t familyId, bool checkAcls, std::map<int32_t, std::vector<uint64_t>>& page)
+{
+    try
+    {
+        page.clear();
+        PPeerOrder peerOrder = takePeerOrder(familyId);
+        auto peerIterator = peerOrder->peers.begin();
+        if(_hasCursor)
+        {
+            peerIterator = std::upper_bound(peerOrder->peers.begin(), peerOrder->peers.end(), std::make_pair(_familyId, _peerId), [](const std::pair<int32_t, uint64_t>& cursor, const PeerOrder::Entry& entry)
+            {
+                return cursor.first < entry.familyId || (cursor.first == entry.familyId && cursor.second < entry.peerId);
+            });
+        }
+
+        int32_t count = 0;
+        for(; peerIterator != peerOrder->peers.end(); ++peerIterator)
+        {
+            std::shared_ptr<BaseLib::Systems::Peer> peer = peerIterator->peer.lock();
+            if(!peer) continue;
+            if(checkAcls && !clientInfo->acls->checkDeviceReadAccess(peer)) continue;
+            if(count == _limit)
+            {
+                //One more peer exists, so there is a next page.
+                std::string cursor = "p" + std::to_string(page.rbegin()->first) + "," + std::to_string(page.rbegin()->second.back());
+                storePeerOrder(familyId, cursor, peerOrder);
+                return cursor;
+            }
+            page[peerIterator->familyId].push_back(peerIterator->peerId);
+            count++;
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return "";
+}
+
+BaseLib::PVariable Paging::getStructPage(const BaseLib::PVariable& values)
+{
+    try
+    {
+        if(values->errorStruct) return values;
+        auto items = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        auto iterator = _hasCursor ? values->structValue->upper_bound(_name) : values->structValue->begin();
+        for(; iterator != values->structValue->end() && (int32_t)items->structValue->size() < _limit; ++iterator)
+        {
+            items->structValue->emplace_hint(items->structValue->end(), iterator->first, iterator->second);
+        }
+        return createResult(items, iterator == values->structValue->end() ? "" : "s" + items->structValue->rbegin()->first);
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable Paging::createResult(const BaseLib::PVariable& items, const std::string& cursor)
+{
+    auto result = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    result->structValue->emplace("items", items);
+    if(!cursor.empty())
+    {
+        std::string encodedCursor;
+        BaseLib::Base64::encode(cursor, encodedCursor);
+        result->structValue->emplace("cursor", std::make_shared<BaseLib::Variable>(encodedCursor));
+    }
+    return result;
+}
+
+}
+
+}
@@ -0,0 +1,166 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef PAGING_H_
+#define PAGING_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+/**
+ * Cursor based paging for methods returning large lists ("listDevices", "getAllConfig", "getAllValues" and
+ * "getAllSystemVariables").
+ * Clients pass a struct with "limit" and optionally "cursor" as last parameter. The methods then return a struct with
+ * the page in "items" and, when there are more items, an opaque "cursor" to pass to the next call.
+ *
+ * Devices are ordered by family ID and peer ID, system variables by name. Items the client has no access to are
+ * skipped before the page is cut, so every page contains "limit" items except the last one.
+ *
+ * The peer order is only built for the first page. It is kept under the returned cursor for the next page, so paging
+ * through all devices doesn't sort all peers for every page.
+ */
+class Paging
+{
+public:
+    /**
+     * The items a method pages through. Cursors are only accepted by methods paging through the same items.
+     */
+    enum class ItemType
+    {
+        peers,
+        systemVariables
+    };
+
+    Paging() = default;
+
+    virtual ~Paging() = default;
+
+    /**
+     * Removes the paging struct from the end of the parameters and parses it. "parameters" is replaced by a copy, so
+     * the caller's array stays unchanged.
+     *
+     * @param itemType The items the calling method pages through.
+     * @param[out] paging Set when the parameters end with a paging struct.
+     * @return An error variable when the struct is invalid, otherwise nullptr.
+     */
+    static BaseLib::PVariable fromParameters(BaseLib::PArray& parameters, ItemType itemType, std::unique_ptr<Paging>& paging);
+
+    /**
+     * Parses the paging struct.
+     *
+     * @param itemType The items the calling method pages through.
+     * @return An error variable when the struct is invalid or the cursor was returned for other items, otherwise nullptr.
+     */
+    BaseLib::PVariable parse(const BaseLib::PVariable& options, ItemType itemType);
+
+    int32_t limit() { return _limit; }
+
+    /**
+     * Selects the peers of the next page in the order family ID, peer ID.
+     *
+     * @param familyId Only consider peers of this family. -1 for all families.
+     * @param checkAcls Skip peers the client has no read access to.
+     * @param[out] page The selected peer IDs by family ID.
+     * @return The cursor for the next page or an empty string for the last page.
+     */
+    std::string getPeerPage(const BaseLib::PRpcClientInfo& clientInfo, int32_t familyId, bool checkAcls, std::map<int32_t, std::vector<uint64_t>>& page);
+
+    /**
+     * Cuts the next page out of a struct, which is ordered by name.
+     *
+     * @return The page in the format described above.
+     */
+    BaseLib::PVariable getStructPage(const BaseLib::PVariable& values);
+
+    /**
+     * Creates the response struct.
+     */
+    static BaseLib::PVariable createResult(const BaseLib::PVariable& items, const std::string& cursor);
+private:
+    /**
+     * All peers ordered by family ID and peer ID. Peers deleted after the order was built are skipped.
+     */
+    struct PeerOrder
+    {
+        struct Entry
+        {
+            int32_t familyId = -1;
+            uint64_t peerId = 0;
+            std::weak_ptr<BaseLib::Systems::Peer> peer;
+        };
+
+        int64_t lastUse = 0;
+        std::vector<Entry> peers;
+    };
+    typedef std::shared_ptr<PeerOrder> PPeerOrder;
+
+    /**
+     * Peer orders of unfinished paging sequences by family filter and the cursor of their next page. Entries not used
+     * for "_peerOrderTimeout" milliseconds are removed.
+     */
+    static std::mutex _peerOrdersMutex;
+    static std::map<std::string, PPeerOrder> _peerOrders;
+    static const int64_t _peerOrderTimeout = 60000;
+    static const size_t _maxPeerOrders = 100;
+
+    /**
+     * Returns the peer order stored for the current cursor and removes it from _peerOrders. A new order is built, when
+     * there is none.
+     */
+    PPeerOrder takePeerOrder(int32_t familyId);
+
+    /**
+     * Stores a peer order for the page starting after "cursor".
+     */
+    static void storePeerOrder(int32_t familyId, const std::string& cursor, const PPeerOrder& peerOrder);
+
+    int32_t _limit = 0;
+    bool _hasCursor = false;
+    int32_t _familyId = -1;
+    uint64_t _peerId = 0;
+    std::string _name;
+};
+
+}
+
+}
+
+#endif
@@ -33,6 +33,7 @@
 #include "RPCMethods.h"
 #include "../GD/GD.h"
 #include "Roles.h"
+#include "Paging.h"
 #include <sys/stat.h>
 #ifdef BSDSYSTEM
 #include <sys/wait.h>
@@ -227,6 +228,17 @@ BaseLib::PVariable RPCSystemMethodSignature::invoke(BaseLib::PRpcClientInfo clie
     return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+const std::unordered_set<std::string> RPCSystemMulticall::_readOnlyMethods
+{
+    "getAllConfig", "getAllMetadata", "getAllSystemVariables", "getAllValues", "getCategories", "getChannelsInCategory", "getChannelsInRoom", "getConfigParameter", "getData", "getDeviceDescription", "getDeviceInfo", "getDevicesInCategory", "getDevicesInRoom", "getLinkInfo", "getLinkPeers", "getLinks", "getMetadata", "getName", "getParamset", "getParamsetDescription", "getParamsetId", "getPeerId", "getRooms", "getServiceMessages", "getSystemVariable", "getSystemVariableFlags", "getValue", "getVariableDescription", "getVariableHistory", "listDevices", "listFamilies", "listInterfaces"
+};
+std::atomic<uint64_t> RPCSystemMulticall::_multicalls{0};
+std::atomic<uint64_t> RPCSystemMulticall::_parallelMulticalls{0};
+std::atomic<uint64_t> RPCSystemMulticall::_subCalls{0};
+std::atomic<int64_t> RPCSystemMulticall::_multicallTime{0};
+std::atomic<int64_t> RPCSystemMulticall::_multicallMaxTime{0};
+std::atomic<int64_t> RPCSystemMulticall::_subCallTime{0};
+
 BaseLib::PVariable RPCSystemMulticall::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
 {
     try
@@ -235,40 +247,99 @@ BaseLib::PVariable RPCSystemMulticall::invoke(BaseLib::PRpcClientInfo clientInfo
         ParameterError::Enum error = checkParameters(parameters, std::vector<BaseLib::VariableType>({BaseLib::VariableType::tArray}));
         if(error != ParameterError::Enum::noError) return getError(error);
 
-        BaseLib::PVariable returns(new BaseLib::Variable(BaseLib::VariableType::tArray));
-        returns->arrayValue->reserve(parameters->at(0)->arrayValue->size());
-        for(std::vector<BaseLib::PVariable>::iterator i = parameters->at(0)->arrayValue->begin(); i != parameters->at(0)->arrayValue->end(); ++i)
+        int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
+        std::vector<std::pair<std::string, BaseLib::PVariable>> calls;
+        std::vector<BaseLib::PVariable> results;
+        calls.reserve(parameters->at(0)->arrayValue->size());
+        results.resize(parameters->at(0)->arrayValue->size());
+
+        //Validate all calls and check the ACLs before executing anything
+        for(size_t i = 0; i < parameters->at(0)->arrayValue->size(); i++)
         {
-            if((*i)->type != BaseLib::VariableType::tStruct)
+            auto& call = parameters->at(0)->arrayValue->at(i);
+            calls.emplace_back();
+            if(call->type != BaseLib::VariableType::tStruct)
             {
-                returns->arrayValue->push_back(BaseLib::Variable::createError(-32602, "Array element is no struct."));
+                results.at(i) = BaseLib::Variable::createError(-32602, "Array element is no struct.");
                 continue;
             }
-            if((*i)->structValue->size() != 2)
+            if(call->structValue->size() != 2)
             {
-                returns->arrayValue->push_back(BaseLib::Variable::createError(-32602, "Struct has wrong size."));
+                results.at(i) = BaseLib::Variable::createError(-32602, "Struct has wrong size.");
                 continue;
             }
-            if((*i)->structValue->find("methodName") == (*i)->structValue->end() || (*i)->structValue->at("methodName")->type != BaseLib::VariableType::tString)
+            if(call->structValue->find("methodName") == call->structValue->end() || call->structValue->at("methodName")->type != BaseLib::VariableType::tString)
             {
-                returns->arrayValue->push_back(BaseLib::Variable::createError(-32602, "No method name provided."));
+                results.at(i) = BaseLib::Variable::createError(-32602, "No method name provided.");
                 continue;
             }
-            if((*i)->structValue->find("params") == (*i)->structValue->end() || (*i)->structValue->at("params")->type != BaseLib::VariableType::tArray)
+            if(call->structValue->find("params") == call->structValue->end() || call->structValue->at("params")->type != BaseLib::VariableType::tArray)
             {
-                returns->arrayValue->push_back(BaseLib::Variable::createError(-32602, "No parameters provided."));
+                results.at(i) = BaseLib::Variable::createError(-32602, "No parameters provided.");
                 continue;
             }
-            std::string methodName = (*i)->structValue->at("methodName")->stringValue;
+            std::string methodName = call->structValue->at("methodName")->stringValue;
             if(!clientInfo->acls->checkMethodAccess(methodName)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
-            auto parameters = (*i)->structValue->at("params");
+            if(methodName == "system.multicall")
+            {
+                results.at(i) = BaseLib::Variable::createError(-32602, "Recursive calls to system.multicall are not allowed.");
+                continue;
+            }
+            calls.back().first = methodName;
+            calls.back().second = call->structValue->at("params");
+        }
 
-            if(methodName == "system.multicall") returns->arrayValue->push_back(BaseLib::Variable::createError(-32602, "Recursive calls to system.multicall are not allowed."));
-            else
+        //Consecutive read-only calls are executed in parallel. All other calls are executed one after another, after all calls before them finished.
+        bool parallel = GD::multicallPool && GD::multicallPool->maxConcurrency() > 1;
+        bool parallelBatch = false;
+        int64_t callTime = 0;
+        size_t callIndex = 0;
+        while(callIndex < calls.size())
+        {
+            auto batch = std::make_shared<MulticallBatch>();
+            batch->clientInfo = clientInfo;
+            batch->calls = &calls;
+            batch->results = &results;
+            for(; callIndex < calls.size(); callIndex++)
+            {
+                if(calls.at(callIndex).first.empty()) continue;
+                if(!parallel || _readOnlyMethods.find(calls.at(callIndex).first) == _readOnlyMethods.end()) break;
+                batch->callIndexes.push_back(callIndex);
+            }
+            if(callIndex < calls.size())
             {
-                returns->arrayValue->push_back(GD::rpcServers.begin()->second->callMethod(clientInfo, methodName, parameters));
+                //The call ending the batch is executed after the batch.
+                executeBatch(batch);
+                callTime += batch->callTime;
+                if(batch->callIndexes.size() > 1) parallelBatch = true;
+                batch = std::make_shared<MulticallBatch>();
+                batch->clientInfo = clientInfo;
+                batch->calls = &calls;
+                batch->results = &results;
+                batch->callIndexes.push_back(callIndex);
+                callIndex++;
             }
+            if(batch->callIndexes.size() > 1) parallelBatch = true;
+            executeBatch(batch);
+            callTime += batch->callTime;
         }
+        if(parallelBatch) _parallelMulticalls++;
+
+        BaseLib::PVariable returns = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+        returns->arrayValue->reserve(results.size());
+        for(auto& result : results)
+        {
+            returns->arrayValue->push_back(result ? result : BaseLib::Variable::createError(-32500, "Unknown application error."));
+        }
+
+        int64_t duration = BaseLib::HelperFunctions::getTimeMicroseconds() - startTime;
+        _multicalls++;
+        _subCalls += calls.size();
+        _multicallTime += duration;
+        _subCallTime += callTime;
+        int64_t maxTime = _multicallMaxTime;
+        while(duration > maxTime && !_multicallMaxTime.compare_exchange_weak(maxTime, duration));
+        if(GD::bl->debugLevel >= 5) GD::out.printDebug("Debug: system.multicall with " + std::to_string(calls.size()) + " calls took " + std::to_string(duration) + "us (summed call time: " + std::to_string(callTime) + "us).");
 
         return returns;
     }
@@ -283,6 +354,136 @@ BaseLib::PVariable RPCSystemMulticall::invoke(BaseLib::PRpcClientInfo clientInfo
     return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+void RPCSystemMulticall::executeBatch(std::shared_ptr<MulticallBatch>& batch)
+{
+    try
+    {
+        if(batch->callIndexes.empty()) return;
+        if(batch->callIndexes.size() > 1 && GD::multicallPool)
+        {
+            size_t helperCount = std::min(GD::multicallPool->maxConcurrency(), batch->callIndexes.size()) - 1;
+            for(size_t i = 0; i < helperCount; i++)
+            {
+                if(!GD::multicallPool->execute(std::bind(&RPCSystemMulticall::helpWithBatch, batch))) break;
+            }
+        }
+
+        executeCalls(batch, batch->clientInfo);
+
+        //Workers, that didn't start yet, find no calls left and return without touching the batch.
+        std::unique_lock<std::mutex> workersGuard(batch->workersMutex);
+        batch->workersConditionVariable.wait(workersGuard, [&] { return batch->activeWorkers == 0; });
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void RPCSystemMulticall::helpWithBatch(std::shared_ptr<MulticallBatch> batch)
+{
+    {
+        std::lock_guard<std::mutex> workersGuard(batch->workersMutex);
+        if(batch->nextCall >= batch->callIndexes.size()) return;
+        batch->activeWorkers++;
+    }
+
+    try
+    {
+        auto clientInfo = copyClientInfo(batch->clientInfo);
+        executeCalls(batch, clientInfo);
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+
+    std::lock_guard<std::mutex> workersGuard(batch->workersMutex);
+    batch->activeWorkers--;
+    batch->workersConditionVariable.notify_all();
+}
+
+void RPCSystemMulticall::executeCalls(std::shared_ptr<MulticallBatch>& batch, BaseLib::PRpcClientInfo& clientInfo)
+{
+    for(size_t i = batch->nextCall++; i < batch->callIndexes.size(); i = batch->nextCall++)
+    {
+        size_t callIndex = batch->callIndexes.at(i);
+        auto& call = batch->calls->at(callIndex);
+        int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
+        try
+        {
+            batch->results->at(callIndex) = GD::rpcServers.begin()->second->callMethod(clientInfo, call.first, call.second);
+        }
+        catch(const std::exception& ex)
+        {
+            GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+        }
+        catch(...)
+        {
+            GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+        }
+        batch->callTime += BaseLib::HelperFunctions::getTimeMicroseconds() - startTime;
+    }
+}
+
+BaseLib::PRpcClientInfo RPCSystemMulticall::copyClientInfo(BaseLib::PRpcClientInfo& clientInfo)
+{
+    auto copy = std::make_shared<BaseLib::RpcClientInfo>();
+    copy->address = clientInfo->address;
+    copy->port = clientInfo->port;
+    copy->user = clientInfo->user;
+    copy->acls = clientInfo->acls;
+    copy->clientType = clientInfo->clientType;
+    copy->language = clientInfo->language;
+    copy->flowsServer = clientInfo->flowsServer;
+    copy->scriptEngineServer = clientInfo->scriptEngineServer;
+    copy->initInterfaceId = clientInfo->initInterfaceId;
+    copy->initUrl = clientInfo->initUrl;
+    copy->initJsonMode = clientInfo->initJsonMode;
+    copy->initBinaryMode = clientInfo->initBinaryMode;
+    copy->initNewFormat = clientInfo->initNewFormat;
+    copy->initKeepAlive = clientInfo->initKeepAlive;
+    copy->initSubscribePeers = clientInfo->initSubscribePeers;
+    copy->initSendNewDevices = clientInfo->initSendNewDevices;
+    return copy;
+}
+
+BaseLib::PVariable RPCSystemMulticall::getMetrics()
+{
+    try
+    {
+        auto metrics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        uint64_t multicalls = _multicalls;
+        metrics->structValue->emplace("multicalls", std::make_shared<BaseLib::Variable>((int64_t)multicalls));
+        metrics->structValue->emplace("multicallParallel", std::make_shared<BaseLib::Variable>(GD::rpcSettings.multicallParallel()));
+        metrics->structValue->emplace("multicallMaxConcurrency", std::make_shared<BaseLib::Variable>(GD::rpcSettings.multicallMaxConcurrency()));
+        metrics->structValue->emplace("parallelMulticalls", std::make_shared<BaseLib::Variable>((int64_t)_parallelMulticalls));
+        metrics->structValue->emplace("multicallSubCalls", std::make_shared<BaseLib::Variable>((int64_t)_subCalls));
+        metrics->structValue->emplace("multicallAverageLatency", std::make_shared<BaseLib::Variable>((int64_t)(multicalls > 0 ? _multicallTime / (int64_t)multicalls : 0)));
+        metrics->structValue->emplace("multicallMaxLatency", std::make_shared<BaseLib::Variable>((int64_t)_multicallMaxTime));
+        metrics->structValue->emplace("multicallTime", std::make_shared<BaseLib::Variable>((int64_t)_multicallTime));
+        metrics->structValue->emplace("multicallSubCallTime", std::make_shared<BaseLib::Variable>((int64_t)_subCallTime));
+        return metrics;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable RPCAbortEventReset::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
 {
 #ifdef EVENTHANDLER
@@ -338,6 +539,7 @@ BaseLib::PVariable RPCActivateLinkParamset::invoke(BaseLib::PRpcClientInfo clien
     try
     {
         if(!clientInfo || !clientInfo->acls->checkMethodAccess("activateLinkParamset")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tString, BaseLib::VariableType::tString}),
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tString, BaseLib::VariableType::tString, BaseLib::VariableType::tBoolean}),
@@ -413,6 +615,7 @@ BaseLib::PVariable RPCAddCategoryToChannel::invoke(BaseLib::PRpcClientInfo clien
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -456,6 +659,7 @@ BaseLib::PVariable RPCAddCategoryToDevice::invoke(BaseLib::PRpcClientInfo client
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -499,6 +703,7 @@ BaseLib::PVariable RPCAddRoleToVariable::invoke(BaseLib::PRpcClientInfo clientIn
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger, BaseLib::VariableType::tString, BaseLib::VariableType::tInteger}),
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger, BaseLib::VariableType::tString, BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger}),
@@ -611,6 +816,7 @@ BaseLib::PVariable RPCAddCategoryToSystemVariable::invoke(BaseLib::PRpcClientInf
 {
     try
     {
+        AclCache::InvalidationGuard aclCacheInvalidationGuard(GD::aclCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tString, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -645,6 +851,7 @@ BaseLib::PVariable RPCAddCategoryToVariable::invoke(BaseLib::PRpcClientInfo clie
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger, BaseLib::VariableType::tString, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -707,6 +914,7 @@ BaseLib::PVariable RPCAddChannelToRoom::invoke(BaseLib::PRpcClientInfo clientInf
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -805,6 +1013,7 @@ BaseLib::PVariable RPCAddDeviceToRoom::invoke(BaseLib::PRpcClientInfo clientInfo
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -875,6 +1084,7 @@ BaseLib::PVariable RPCAddLink::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLi
     try
     {
         if(!clientInfo || !clientInfo->acls->checkMethodAccess("addLink")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         bool checkAcls = clientInfo->acls->roomsCategoriesRolesDevicesWriteSet();
 
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
@@ -974,6 +1184,7 @@ BaseLib::PVariable RPCAddRoleToSystemVariable::invoke(BaseLib::PRpcClientInfo cl
 {
     try
     {
+        AclCache::InvalidationGuard aclCacheInvalidationGuard(GD::aclCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tString, BaseLib::VariableType::tInteger}),
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tString, BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger}),
@@ -1085,6 +1296,7 @@ BaseLib::PVariable RPCAddSystemVariableToRoom::invoke(BaseLib::PRpcClientInfo cl
 {
     try
     {
+        AclCache::InvalidationGuard aclCacheInvalidationGuard(GD::aclCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tString, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -1156,6 +1368,7 @@ BaseLib::PVariable RPCAddVariableToRoom::invoke(BaseLib::PRpcClientInfo clientIn
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger, BaseLib::VariableType::tString, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -1216,6 +1429,7 @@ BaseLib::PVariable RPCAggregateRoles::invoke(BaseLib::PRpcClientInfo clientInfo,
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
             std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger}),
             std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tArray}),
@@ -1321,6 +1535,7 @@ BaseLib::PVariable RPCCopyConfig::invoke(BaseLib::PRpcClientInfo clientInfo, Bas
     try
     {
         if(!clientInfo || !clientInfo->acls->checkMethodAccess("copyConfig")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         bool checkAcls = clientInfo->acls->variablesRoomsCategoriesRolesDevicesWriteSet();
 
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
@@ -1579,6 +1794,7 @@ BaseLib::PVariable RPCDeleteCategory::invoke(BaseLib::PRpcClientInfo clientInfo,
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -1802,6 +2018,7 @@ BaseLib::PVariable RPCDeleteRole::invoke(BaseLib::PRpcClientInfo clientInfo, Bas
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -1846,6 +2063,7 @@ BaseLib::PVariable RPCDeleteRoom::invoke(BaseLib::PRpcClientInfo clientInfo, Bas
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -1925,6 +2143,7 @@ BaseLib::PVariable RPCDeleteSystemVariable::invoke(BaseLib::PRpcClientInfo clien
     try
     {
         if(!clientInfo || !clientInfo->acls->checkMethodAccess("deleteSystemVariable")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+        AclCache::InvalidationGuard aclCacheInvalidationGuard(GD::aclCache);
         bool checkAcls = clientInfo->acls->variablesRoomsCategoriesRolesReadSet();
         ParameterError::Enum error = checkParameters(parameters, std::vector<BaseLib::VariableType>({BaseLib::VariableType::tString}));
         if(error != ParameterError::Enum::noError) return getError(error);
@@ -2052,6 +2271,9 @@ BaseLib::PVariable RPCGetAllConfig::invoke(BaseLib::PRpcClientInfo clientInfo, B
     {
         if(!clientInfo || !clientInfo->acls->checkMethodAccess("getAllConfig")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
         bool checkAcls = clientInfo->acls->roomsCategoriesRolesDevicesReadSet();
+        std::unique_ptr<Paging> paging;
+        auto pagingError = Paging::fromParameters(parameters, Paging::ItemType::peers, paging);
+        if(pagingError) return pagingError;
         if(parameters->size() > 0)
         {
             ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
@@ -2063,6 +2285,31 @@ BaseLib::PVariable RPCGetAllConfig::invoke(BaseLib::PRpcClientInfo clientInfo, B
         uint64_t peerId = 0;
         if(parameters->size() > 0) peerId = parameters->at(0)->integerValue64;
 
+        if(paging)
+        {
+            if(peerId > 0) return BaseLib::Variable::createError(-1, "Paging is only supported when the configuration of all devices is requested.");
+            std::map<int32_t, std::vector<uint64_t>> page;
+            std::string cursor = paging->getPeerPage(clientInfo, -1, checkAcls, page);
+            BaseLib::PVariable config(new BaseLib::Variable(BaseLib::VariableType::tArray));
+            for(auto& familyPage : page)
+            {
+                auto family = GD::familyController->getFamily(familyPage.first);
+                std::shared_ptr<BaseLib::Systems::ICentral> central = family ? family->getCentral() : std::shared_ptr<BaseLib::Systems::ICentral>();
+                if(!central) continue;
+                for(auto pagePeerId : familyPage.second)
+                {
+                    BaseLib::PVariable result = central->getAllConfig(clientInfo, pagePeerId, checkAcls);
+                    if(!result || result->errorStruct) continue;
+                    config->arrayValue->insert(config->arrayValue->end(), result->arrayValue->begin(), result->arrayValue->end());
+                }
+            }
+            return Paging::createResult(config, cursor);
+        }
+
+        uint64_t cacheVersion = 0;
+        auto cachedResponse = GD::rpcResponseCache.get("getAllConfig", clientInfo, parameters, cacheVersion);
+        if(cachedResponse) return cachedResponse;
+
         BaseLib::PVariable config(new BaseLib::Variable(BaseLib::VariableType::tArray));
         std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
         for(std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>::iterator i = families.begin(); i != families.end(); ++i)
@@ -2090,6 +2337,7 @@ BaseLib::PVariable RPCGetAllConfig::invoke(BaseLib::PRpcClientInfo clientInfo, B
         }
 
         if(config->arrayValue->empty() && peerId > 0) return BaseLib::Variable::createError(-2, "Unknown device.");
+        GD::rpcResponseCache.set("getAllConfig", clientInfo, parameters, cacheVersion, config);
         return config;
     }
     catch(const std::exception& ex)
@@ -2277,6 +2525,9 @@ BaseLib::PVariable RPCGetAllSystemVariables::invoke(BaseLib::PRpcClientInfo clie
         if(!clientInfo || !clientInfo->acls->checkMethodAccess("getAllSystemVariables")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
         bool checkAcls = clientInfo->acls->variablesRoomsCategoriesRolesReadSet();
         bool returnRoomsCategoriesFlags = false;
+        std::unique_ptr<Paging> paging;
+        auto pagingError = Paging::fromParameters(parameters, Paging::ItemType::systemVariables, paging);
+        if(pagingError) return pagingError;
         if(parameters->size() > 0)
         {
             ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
@@ -2287,7 +2538,9 @@ BaseLib::PVariable RPCGetAllSystemVariables::invoke(BaseLib::PRpcClientInfo clie
             returnRoomsCategoriesFlags = parameters->at(0)->booleanValue;
         }
 
-        return GD::systemVariableController->getAll(clientInfo, returnRoomsCategoriesFlags, checkAcls);
+        auto systemVariables = GD::systemVariableController->getAll(clientInfo, returnRoomsCategoriesFlags, checkAcls);
+        if(paging) return paging->getStructPage(systemVariables);
+        return systemVariables;
     }
     catch(const std::exception& ex)
     {
@@ -2330,6 +2583,9 @@ BaseLib::PVariable RPCGetAllValues::invoke(BaseLib::PRpcClientInfo clientInfo, B
     {
         if(!clientInfo || !clientInfo->acls->checkMethodAccess("getAllValues")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
         bool checkAcls = clientInfo->acls->variablesRoomsCategoriesRolesDevicesReadSet();
+        std::unique_ptr<Paging> paging;
+        auto pagingError = Paging::fromParameters(parameters, Paging::ItemType::peers, paging);
+        if(pagingError) return pagingError;
         if(parameters->size() > 0)
         {
             ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
@@ -2367,10 +2623,19 @@ BaseLib::PVariable RPCGetAllValues::invoke(BaseLib::PRpcClientInfo clientInfo, B
             isArray = true;
         }
 
+        std::map<int32_t, std::vector<uint64_t>> page;
+        std::string cursor;
+        if(paging)
+        {
+            if(peerId > 0 || isArray) return BaseLib::Variable::createError(-1, "Paging is only supported when the values of all devices are requested.");
+            cursor = paging->getPeerPage(clientInfo, -1, clientInfo->acls->roomsCategoriesRolesDevicesReadSet(), page);
+        }
+
         BaseLib::PVariable values(new BaseLib::Variable(BaseLib::VariableType::tArray));
         std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
         for(std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>::iterator i = families.begin(); i != families.end(); ++i)
         {
+            if(paging && page.find(i->first) == page.end()) continue;
             std::shared_ptr<BaseLib::Systems::ICentral> central = i->second->getCentral();
             if(!central) continue;
             if(peerId > 0)
@@ -2389,6 +2654,15 @@ BaseLib::PVariable RPCGetAllValues::invoke(BaseLib::PRpcClientInfo clientInfo, B
             {
                 auto peerIds = std::make_shared<BaseLib::Array>();
                 if(peerId > 0) peerIds->push_back(std::make_shared<BaseLib::Variable>(peerId));
+                else if(paging)
+                {
+                    auto& pagePeerIds = page.at(i->first);
+                    peerIds->reserve(pagePeerIds.size());
+                    for(auto pagePeerId : pagePeerIds)
+                    {
+                        peerIds->push_back(std::make_shared<BaseLib::Variable>(pagePeerId));
+                    }
+                }
                 result = central->getAllValues(clientInfo, peerIds, returnWriteOnly, checkAcls);
             }
             if(result && result->errorStruct)
@@ -2402,6 +2676,7 @@ BaseLib::PVariable RPCGetAllValues::invoke(BaseLib::PRpcClientInfo clientInfo, B
         }
 
         if(values->arrayValue->empty() && peerId > 0) return BaseLib::Variable::createError(-2, "Unknown device.");
+        if(paging) return Paging::createResult(values, cursor);
         return values;
     }
     catch(const std::exception& ex)
@@ -2739,6 +3014,10 @@ BaseLib::PVariable RPCGetDeviceDescription::invoke(BaseLib::PRpcClientInfo clien
             }
         }
 
+        uint64_t cacheVersion = 0;
+        auto response = GD::rpcResponseCache.get("getDeviceDescription", clientInfo, parameters, cacheVersion);
+        if(response) return response;
+
         std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
         for(std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>::iterator i = families.begin(); i != families.end(); ++i)
         {
@@ -2747,7 +3026,12 @@ BaseLib::PVariable RPCGetDeviceDescription::invoke(BaseLib::PRpcClientInfo clien
             {
                 if(useSerialNumber)
                 {
-                    if(central->peerExists(serialNumber)) return central->getDeviceDescription(clientInfo, serialNumber, channel, fields);
+                    if(central->peerExists(serialNumber))
+                    {
+                        response = central->getDeviceDescription(clientInfo, serialNumber, channel, fields);
+                        GD::rpcResponseCache.set("getDeviceDescription", clientInfo, parameters, cacheVersion, response);
+                        return response;
+                    }
                 }
                 else
                 {
@@ -2759,7 +3043,9 @@ BaseLib::PVariable RPCGetDeviceDescription::invoke(BaseLib::PRpcClientInfo clien
                         if(!peer || !clientInfo->acls->checkDeviceReadAccess(peer)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
                     }
 
-                    return central->getDeviceDescription(clientInfo, parameters->at(0)->integerValue64, parameters->at(1)->integerValue, fields);
+                    response = central->getDeviceDescription(clientInfo, parameters->at(0)->integerValue64, parameters->at(1)->integerValue, fields);
+                    GD::rpcResponseCache.set("getDeviceDescription", clientInfo, parameters, cacheVersion, response);
+                    return response;
                 }
             }
         }
@@ -3642,11 +3928,17 @@ BaseLib::PVariable RPCGetParamsetDescription::invoke(BaseLib::PRpcClientInfo cli
                                                                                                                  }));
         if(error != ParameterError::Enum::noError) return getError(error);
 
+        uint64_t cacheVersion = 0;
+        auto response = GD::rpcResponseCache.get("getParamsetDescription", clientInfo, parameters, cacheVersion);
+        if(response) return response;
+
         if(parameters->size() == 5)
         {
             std::shared_ptr<BaseLib::Systems::DeviceFamily> family = GD::familyController->getFamily(parameters->at(0)->integerValue);
             if(!family) return BaseLib::Variable::createError(-2, "Device family not found.");
-            return family->getParamsetDescription(clientInfo, parameters->at(1)->integerValue, parameters->at(2)->integerValue, parameters->at(3)->integerValue, BaseLib::DeviceDescription::ParameterGroup::typeFromString(parameters->at(4)->stringValue));
+            response = family->getParamsetDescription(clientInfo, parameters->at(1)->integerValue, parameters->at(2)->integerValue, parameters->at(3)->integerValue, BaseLib::DeviceDescription::ParameterGroup::typeFromString(parameters->at(4)->stringValue));
+            GD::rpcResponseCache.set("getParamsetDescription", clientInfo, parameters, cacheVersion, response);
+            return response;
         }
         else
         {
@@ -3706,7 +3998,12 @@ BaseLib::PVariable RPCGetParamsetDescription::invoke(BaseLib::PRpcClientInfo cli
                 if(!central) continue;
                 if(useSerialNumber)
                 {
-                    if(central->peerExists(serialNumber)) return central->getParamsetDescription(clientInfo, serialNumber, channel, type, remoteSerialNumber, remoteChannel);
+                    if(central->peerExists(serialNumber))
+                    {
+                        response = central->getParamsetDescription(clientInfo, serialNumber, channel, type, remoteSerialNumber, remoteChannel);
+                        GD::rpcResponseCache.set("getParamsetDescription", clientInfo, parameters, cacheVersion, response);
+                        return response;
+                    }
                 }
                 else
                 {
@@ -3724,7 +4021,9 @@ BaseLib::PVariable RPCGetParamsetDescription::invoke(BaseLib::PRpcClientInfo cli
                         }
                     }
 
-                    return central->getParamsetDescription(clientInfo, (uint64_t) parameters->at(0)->integerValue64, parameters->at(1)->integerValue, type, remoteId, remoteChannel, checkAcls);
+                    response = central->getParamsetDescription(clientInfo, (uint64_t) parameters->at(0)->integerValue64, parameters->at(1)->integerValue, type, remoteId, remoteChannel, checkAcls);
+                    GD::rpcResponseCache.set("getParamsetDescription", clientInfo, parameters, cacheVersion, response);
+                    return response;
                 }
             }
         }
@@ -4235,6 +4534,39 @@ BaseLib::PVariable RPCGetRoomUiElements::invoke(BaseLib::PRpcClientInfo clientIn
     return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+BaseLib::PVariable RPCGetRpcMetrics::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
+{
+    try
+    {
+        if(!clientInfo || !clientInfo->acls->checkMethodAccess("getRpcMetrics")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+        ParameterError::Enum error = checkParameters(parameters, std::vector<BaseLib::VariableType>());
+        if(error != ParameterError::Enum::noError) return getError(error);
+
+        auto metrics = GD::rpcMetrics.getMetrics();
+        if(metrics->errorStruct) return metrics;
+        auto multicallMetrics = RPCSystemMulticall::getMetrics();
+        if(!multicallMetrics->errorStruct) metrics->structValue->insert(multicallMetrics->structValue->begin(), multicallMetrics->structValue->end());
+        auto cacheMetrics = GD::rpcResponseCache.getMetrics();
+        if(!cacheMetrics->errorStruct) metrics->structValue->insert(cacheMetrics->structValue->begin(), cacheMetrics->structValue->end());
+        auto aclCacheMetrics = GD::aclCache.getMetrics();
+        if(!aclCacheMetrics->errorStruct) metrics->structValue->insert(aclCacheMetrics->structValue->begin(), aclCacheMetrics->structValue->end());
+        auto webSocketMetrics = WebSocketDeflate::getMetrics();
+        if(!webSocketMetrics->errorStruct) metrics->structValue->insert(webSocketMetrics->structValue->begin(), webSocketMetrics->structValue->end());
+        webSocketMetrics = RemoteRpcServer::getEventBatchingMetrics();
+        if(!webSocketMetrics->errorStruct) metrics->structValue->insert(webSocketMetrics->structValue->begin(), webSocketMetrics->structValue->end());
+        return metrics;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable RPCGetServiceMessages::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
 {
     try
@@ -4819,8 +5151,8 @@ BaseLib::PVariable RPCGetValue::invoke(BaseLib::PRpcClientInfo clientInfo, BaseL
 
                     if(checkAcls)
                     {
-                        auto peer = central->getPeer((uint64_t) parameters->at(0)->integerValue64);
-                        if(!peer || !clientInfo->acls->checkVariableReadAccess(peer, channel, parameters->at(2)->stringValue)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+                        std::shared_ptr<BaseLib::Systems::Peer> peer;
+                        if(!GD::aclCache.checkVariableReadAccess(clientInfo->acls, peerId, channel, parameters->at(2)->stringValue, peer)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
                     }
 
                     return central->getValue(clientInfo, peerId, channel, parameters->at(2)->stringValue, requestFromDevice, asynchronously);
@@ -4882,8 +5214,8 @@ BaseLib::PVariable RPCGetVariableDescription::invoke(BaseLib::PRpcClientInfo cli
                 {
                     if(checkAcls)
                     {
-                        auto peer = central->getPeer((uint64_t) parameters->at(0)->integerValue64);
-                        if(!peer || !clientInfo->acls->checkVariableReadAccess(peer, parameters->at(1)->integerValue, parameters->at(2)->stringValue)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+                        std::shared_ptr<BaseLib::Systems::Peer> peer;
+                        if(!GD::aclCache.checkVariableReadAccess(clientInfo->acls, (uint64_t) parameters->at(0)->integerValue64, parameters->at(1)->integerValue, parameters->at(2)->stringValue, peer)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
                     }
 
                     return central->getVariableDescription(clientInfo, parameters->at(0)->integerValue64, parameters->at(1)->integerValue, parameters->at(2)->stringValue, fields);
@@ -4904,6 +5236,64 @@ BaseLib::PVariable RPCGetVariableDescription::invoke(BaseLib::PRpcClientInfo cli
     return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+BaseLib::PVariable RPCGetVariableHistory::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
+{
+    try
+    {
+        if(!clientInfo || !clientInfo->acls->checkMethodAccess("getVariableHistory")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+
+        ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
+                                                                                                                         std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger, BaseLib::VariableType::tString, BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger64}),
+                                                                                                                         std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger, BaseLib::VariableType::tString, BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger64})
+                                                                                                                 }));
+        if(error != ParameterError::Enum::noError) return getError(error);
+
+        if(!GD::variableHistory || !GD::variableHistory->enabled()) return BaseLib::Variable::createError(-1, "Variable history is not enabled.");
+
+        uint64_t peerId = parameters->at(0)->integerValue64;
+        int32_t channel = parameters->at(1)->integerValue;
+        std::string& variable = parameters->at(2)->stringValue;
+        int64_t interval = parameters->size() == 6 ? parameters->at(5)->integerValue64 : 0;
+
+        if(peerId == 0 && channel < 0)
+        {
+            //System variable
+            if(clientInfo->acls->variablesRoomsCategoriesRolesReadSet())
+            {
+                auto systemVariable = GD::systemVariableController->getInternal(variable);
+                if(!systemVariable || !clientInfo->acls->checkSystemVariableReadAccess(systemVariable)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+            }
+        }
+        else if(clientInfo->acls->variablesRoomsCategoriesRolesDevicesReadSet())
+        {
+            //Device variable
+            std::shared_ptr<BaseLib::Systems::Peer> peer;
+            std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
+            for(std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>::iterator i = families.begin(); i != families.end(); ++i)
+            {
+                std::shared_ptr<BaseLib::Systems::ICentral> central = i->second->getCentral();
+                if(central && central->peerExists(peerId))
+                {
+                    peer = central->getPeer(peerId);
+                    break;
+                }
+            }
+            if(!peer || !clientInfo->acls->checkVariableReadAccess(peer, channel, variable)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+        }
+
+        return GD::variableHistory->getHistory(peerId, channel, variable, parameters->at(3)->integerValue64, parameters->at(4)->integerValue64, interval);
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable RPCGetVersion::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
 {
     try
@@ -5322,6 +5712,11 @@ BaseLib::PVariable RPCListDevices::invoke(BaseLib::PRpcClientInfo clientInfo, Ba
     {
         if(!clientInfo || !clientInfo->acls->checkMethodAccess("listDevices")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
         bool checkAcls = clientInfo->acls->roomsCategoriesRolesDevicesReadSet();
+        //The cache key includes the paging struct, so every page is cached separately.
+        auto cacheParameters = parameters;
+        std::unique_ptr<Paging> paging;
+        auto pagingError = Paging::fromParameters(parameters, Paging::ItemType::peers, paging);
+        if(pagingError) return pagingError;
 
         if(parameters->size() > 0)
         {
@@ -5353,14 +5748,35 @@ BaseLib::PVariable RPCListDevices::invoke(BaseLib::PRpcClientInfo clientInfo, Ba
             clientInfo->clientType = BaseLib::RpcClientType::homematicconfigurator;
         }
 
+        uint64_t cacheVersion = 0;
+        auto cachedResponse = GD::rpcResponseCache.get("listDevices", clientInfo, cacheParameters, cacheVersion);
+        if(cachedResponse) return cachedResponse;
+
+        std::map<int32_t, std::vector<uint64_t>> page;
+        std::string cursor;
+        if(paging) cursor = paging->getPeerPage(clientInfo, familyId, checkAcls, page);
+
         BaseLib::PVariable devices(new BaseLib::Variable(BaseLib::VariableType::tArray));
         std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
         for(std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>::iterator i = families.begin(); i != families.end(); ++i)
         {
             if(familyId != -1 && i->first != familyId) continue;
+            if(paging && page.find(i->first) == page.end()) continue;
             std::shared_ptr<BaseLib::Systems::ICentral> central = i->second->getCentral();
             if(!central) continue;
-            BaseLib::PVariable result = central->listDevices(clientInfo, channels, fields, checkAcls);
+            BaseLib::PVariable result;
+            if(paging)
+            {
+                //"listDevices" skips known devices, so all peers of the family not on this page are passed as known.
+                auto& pagePeerIds = page.at(i->first);
+                auto knownDevices = std::make_shared<std::set<uint64_t>>();
+                for(auto& peer : central->getPeers())
+                {
+                    if(!std::binary_search(pagePeerIds.begin(), pagePeerIds.end(), peer->getID())) knownDevices->insert(peer->getID());
+                }
+                result = central->listDevices(clientInfo, channels, fields, knownDevices, checkAcls);
+            }
+            else result = central->listDevices(clientInfo, channels, fields, checkAcls);
             if(result && result->errorStruct)
             {
                 GD::out.printWarning("Warning: Error calling method \"listDevices\" on device family " + i->second->getName() + ": " + result->structValue->at("faultString")->stringValue);
@@ -5369,6 +5785,8 @@ BaseLib::PVariable RPCListDevices::invoke(BaseLib::PRpcClientInfo clientInfo, Ba
             if(result && !result->arrayValue->empty()) devices->arrayValue->insert(devices->arrayValue->end(), result->arrayValue->begin(), result->arrayValue->end());
         }
 
+        if(paging) devices = Paging::createResult(devices, cursor);
+        GD::rpcResponseCache.set("listDevices", clientInfo, cacheParameters, cacheVersion, devices);
         return devices;
     }
     catch(const std::exception& ex)
@@ -5727,6 +6145,7 @@ BaseLib::PVariable RPCPutParamset::invoke(BaseLib::PRpcClientInfo clientInfo, Ba
     try
     {
         if(!clientInfo || !clientInfo->acls->checkMethodAccess("putParamset")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         bool checkAcls = clientInfo->acls->variablesRoomsCategoriesRolesDevicesWriteSet();
 
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
@@ -5837,6 +6256,7 @@ BaseLib::PVariable RPCRemoveCategoryFromChannel::invoke(BaseLib::PRpcClientInfo
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -5880,6 +6300,7 @@ BaseLib::PVariable RPCRemoveCategoryFromDevice::invoke(BaseLib::PRpcClientInfo c
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -5923,6 +6344,7 @@ BaseLib::PVariable RPCRemoveCategoryFromSystemVariable::invoke(BaseLib::PRpcClie
 {
     try
     {
+        AclCache::InvalidationGuard aclCacheInvalidationGuard(GD::aclCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tString, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -5957,6 +6379,7 @@ BaseLib::PVariable RPCRemoveCategoryFromVariable::invoke(BaseLib::PRpcClientInfo
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger, BaseLib::VariableType::tString, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -6019,6 +6442,7 @@ BaseLib::PVariable RPCRemoveChannelFromRoom::invoke(BaseLib::PRpcClientInfo clie
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -6062,6 +6486,7 @@ BaseLib::PVariable RPCRemoveDeviceFromRoom::invoke(BaseLib::PRpcClientInfo clien
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -6132,6 +6557,7 @@ BaseLib::PVariable RPCRemoveLink::invoke(BaseLib::PRpcClientInfo clientInfo, Bas
     try
     {
         if(!clientInfo || !clientInfo->acls->checkMethodAccess("removeLink")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         bool checkAcls = clientInfo->acls->roomsCategoriesRolesDevicesWriteSet();
 
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
@@ -6210,6 +6636,7 @@ BaseLib::PVariable RPCRemoveRoleFromSystemVariable::invoke(BaseLib::PRpcClientIn
 {
     try
     {
+        AclCache::InvalidationGuard aclCacheInvalidationGuard(GD::aclCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tString, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -6263,6 +6690,7 @@ BaseLib::PVariable RPCRemoveRoleFromVariable::invoke(BaseLib::PRpcClientInfo cli
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger, BaseLib::VariableType::tString, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -6369,6 +6797,7 @@ BaseLib::PVariable RPCRemoveSystemVariableFromRoom::invoke(BaseLib::PRpcClientIn
 {
     try
     {
+        AclCache::InvalidationGuard aclCacheInvalidationGuard(GD::aclCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tString, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -6428,6 +6857,7 @@ BaseLib::PVariable RPCRemoveVariableFromRoom::invoke(BaseLib::PRpcClientInfo cli
 {
     try
     {
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
                                                                                                                          std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger, BaseLib::VariableType::tInteger, BaseLib::VariableType::tString, BaseLib::VariableType::tInteger})
                                                                                                                  }));
@@ -6895,6 +7325,7 @@ BaseLib::PVariable RPCSetId::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib:
     try
     {
         if(!clientInfo || !clientInfo->acls->checkMethodAccess("setId")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         bool checkAcls = clientInfo->acls->roomsCategoriesRolesDevicesWriteSet();
 
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
@@ -7015,6 +7446,7 @@ BaseLib::PVariable RPCSetInterface::invoke(BaseLib::PRpcClientInfo clientInfo, B
     try
     {
         if(!clientInfo || !clientInfo->acls->checkMethodAccess("setInterface")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         bool checkAcls = clientInfo->acls->roomsCategoriesRolesDevicesWriteSet();
 
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
@@ -7084,6 +7516,7 @@ BaseLib::PVariable RPCSetLinkInfo::invoke(BaseLib::PRpcClientInfo clientInfo, Ba
     try
     {
         if(!clientInfo || !clientInfo->acls->checkMethodAccess("setLinkInfo")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         bool checkAcls = clientInfo->acls->roomsCategoriesRolesDevicesWriteSet();
 
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
@@ -7259,6 +7692,7 @@ BaseLib::PVariable RPCSetName::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLi
     try
     {
         if(!clientInfo || !clientInfo->acls->checkMethodAccess("setName")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+        ResponseCache::InvalidationGuard cacheInvalidationGuard(GD::rpcResponseCache);
         bool checkAcls = clientInfo->acls->roomsCategoriesRolesDevicesWriteSet();
 
         ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
@@ -7490,6 +7924,10 @@ BaseLib::PVariable RPCSetSystemVariable::invoke(BaseLib::PRpcClientInfo clientIn
         BaseLib::PVariable value = parameters->size() > 1 ? parameters->at(1) : std::make_shared<BaseLib::Variable>();
         int32_t flags = parameters->size() > 2 ? parameters->at(2)->integerValue : -1;
 
+        //Only new variables and changed flags can change ACL decisions, so plain value changes keep the cached decisions.
+        std::unique_ptr<AclCache::InvalidationGuard> aclCacheInvalidationGuard;
+        if(flags != -1 || !GD::systemVariableController->getInternal(parameters->at(0)->stringValue)) aclCacheInvalidationGuard.reset(new AclCache::InvalidationGuard(GD::aclCache));
+
         return GD::systemVariableController->setValue(clientInfo, parameters->at(0)->stringValue, value, flags, checkAcls);
     }
     catch(const std::exception& ex)
@@ -7728,8 +8166,8 @@ BaseLib::PVariable RPCSetValue::invoke(BaseLib::PRpcClientInfo clientInfo, BaseL
 
                     if(checkAcls)
                     {
-                        auto peer = central->getPeer(peerId);
-                        if(!peer || !clientInfo->acls->checkVariableWriteAccess(peer, channel, parameters->at(2)->stringValue)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+                        std::shared_ptr<BaseLib::Systems::Peer> peer;
+                        if(!GD::aclCache.checkVariableWriteAccess(clientInfo->acls, peerId, channel, parameters->at(2)->stringValue, peer)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
                     }
 
                     return central->setValue(clientInfo, peerId, channel, parameters->at(2)->stringValue, value, wait);
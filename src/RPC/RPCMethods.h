@@ -35,6 +35,10 @@
 
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_set>
 #include <cstdlib>
 
 namespace Homegear
@@ -115,6 +119,56 @@ public:
     }
 
     BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
+
+    /**
+     * Returns the number of multicalls and their execution times in microseconds since the start of Homegear.
+     */
+    static BaseLib::PVariable getMetrics();
+private:
+    /**
+     * Consecutive calls of read-only methods, that are executed in parallel.
+     */
+    struct MulticallBatch
+    {
+        BaseLib::PRpcClientInfo clientInfo;
+        std::vector<std::pair<std::string, BaseLib::PVariable>>* calls = nullptr;
+        std::vector<BaseLib::PVariable>* results = nullptr;
+        std::vector<size_t> callIndexes;
+        std::atomic<size_t> nextCall{0};
+        std::atomic<int64_t> callTime{0};
+        std::mutex workersMutex;
+        std::condition_variable workersConditionVariable;
+        int32_t activeWorkers = 0;
+    };
+
+    /**
+     * Methods that don't change anything. Only calls to these methods are executed in parallel.
+     */
+    static const std::unordered_set<std::string> _readOnlyMethods;
+
+    static std::atomic<uint64_t> _multicalls;
+    static std::atomic<uint64_t> _parallelMulticalls;
+    static std::atomic<uint64_t> _subCalls;
+    static std::atomic<int64_t> _multicallTime;
+    static std::atomic<int64_t> _multicallMaxTime;
+    static std::atomic<int64_t> _subCallTime;
+
+    /**
+     * Executes the calls of the batch with the help of the shared multicall pool and waits until all are done.
+     */
+    void executeBatch(std::shared_ptr<MulticallBatch>& batch);
+
+    /**
+     * Executed by the worker threads of the multicall pool. Every worker uses its own copy of the client info.
+     */
+    static void helpWithBatch(std::shared_ptr<MulticallBatch> batch);
+
+    static void executeCalls(std::shared_ptr<MulticallBatch>& batch, BaseLib::PRpcClientInfo& clientInfo);
+
+    /**
+     * Copies the fields of the client info RPC methods read.
+     */
+    static BaseLib::PRpcClientInfo copyClientInfo(BaseLib::PRpcClientInfo& clientInfo);
 };
 
 class RPCAbortEventReset : public BaseLib::Rpc::RpcMethod
@@ -639,6 +693,7 @@ public:
     {
         addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>());
         addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tInteger});
+        addSignature(BaseLib::VariableType::tStruct, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tStruct});
     }
 
     BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
@@ -664,6 +719,8 @@ public:
         addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tBoolean});
         addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tInteger});
         addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tInteger, BaseLib::VariableType::tBoolean});
+        addSignature(BaseLib::VariableType::tStruct, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tStruct});
+        addSignature(BaseLib::VariableType::tStruct, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tBoolean, BaseLib::VariableType::tStruct});
     }
 
     BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
@@ -676,6 +733,8 @@ public:
     {
         addSignature(BaseLib::VariableType::tVariant, std::vector<BaseLib::VariableType>());
         addSignature(BaseLib::VariableType::tVariant, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tBoolean});
+        addSignature(BaseLib::VariableType::tStruct, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tStruct});
+        addSignature(BaseLib::VariableType::tStruct, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tBoolean, BaseLib::VariableType::tStruct});
     }
 
     BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
@@ -1164,6 +1223,18 @@ public:
     BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
 };
 
+class RPCGetRpcMetrics : public BaseLib::Rpc::RpcMethod
+{
+public:
+    RPCGetRpcMetrics()
+    {
+        setHelp("Returns call counts and latencies of the RPC methods per method and client. Times are in microseconds.");
+        addSignature(BaseLib::VariableType::tStruct, std::vector<BaseLib::VariableType>());
+    }
+
+    BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
+};
+
 class RPCGetServiceMessages : public BaseLib::Rpc::RpcMethod
 {
 public:
@@ -1360,6 +1431,18 @@ public:
     BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
 };
 
+class RPCGetVariableHistory : public BaseLib::Rpc::RpcMethod
+{
+public:
+    RPCGetVariableHistory()
+    {
+        addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger, BaseLib::VariableType::tString, BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger64});
+        addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger, BaseLib::VariableType::tString, BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger64});
+    }
+
+    BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
+};
+
 class RPCGetVersion : public BaseLib::Rpc::RpcMethod
 {
 public:
@@ -1445,6 +1528,9 @@ public:
         addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>());
         addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>({BaseLib::VariableType::tBoolean, BaseLib::VariableType::tArray}));
         addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>({BaseLib::VariableType::tBoolean, BaseLib::VariableType::tArray, BaseLib::VariableType::tInteger}));
+        addSignature(BaseLib::VariableType::tStruct, std::vector<BaseLib::VariableType>({BaseLib::VariableType::tStruct}));
+        addSignature(BaseLib::VariableType::tStruct, std::vector<BaseLib::VariableType>({BaseLib::VariableType::tBoolean, BaseLib::VariableType::tArray, BaseLib::VariableType::tStruct}));
+        addSignature(BaseLib::VariableType::tStruct, std::vector<BaseLib::VariableType>({BaseLib::VariableType::tBoolean, BaseLib::VariableType::tArray, BaseLib::VariableType::tInteger, BaseLib::VariableType::tStruct}));
     }
 
     BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
@@ -0,0 +1,99 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "../GD/GD.h"
+#include "RateLimiter.h"
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+int64_t TokenBucket::consume(uint32_t rate, uint32_t burst, uint32_t cost, int64_t now)
+{
+    int64_t retryAfter = check(rate, burst, cost, now);
+    if(retryAfter == 0) _tokens -= cost;
+    return retryAfter;
+}
+
+int64_t TokenBucket::check(uint32_t rate, uint32_t burst, uint32_t cost, int64_t now)
+{
+    if(burst < cost) burst = cost;
+    if(_tokens < 0 || now < _lastRefill) _tokens = burst;
+    else _tokens = std::min((double)burst, _tokens + ((double)(now - _lastRefill) * rate) / 1000);
+    _lastRefill = now;
+
+    if(_tokens >= cost) return 0;
+    return (int64_t)(((cost - _tokens) * 1000) / rate) + 1;
+}
+
+int64_t RateLimiter::acquire(TokenBucket& clientBucket, const std::string& user, const std::string& methodName, const BaseLib::PArray& parameters)
+{
+    try
+    {
+        uint32_t clientRate = GD::rpcSettings.clientRateLimit();
+        uint32_t userRate = user.empty() ? 0 : GD::rpcSettings.userRateLimit();
+        if(clientRate == 0 && userRate == 0) return 0;
+
+        uint32_t cost = 1;
+        if(methodName == "system.multicall")
+        {
+            if(!parameters->empty() && parameters->at(0)->type == BaseLib::VariableType::tArray && !parameters->at(0)->arrayValue->empty()) cost = parameters->at(0)->arrayValue->size();
+        }
+        else cost = GD::rpcSettings.methodCost(methodName);
+        if(cost == 0) return 0;
+
+        int64_t now = BaseLib::HelperFunctions::getTime();
+        //The client bucket is only checked first, so a call rejected by the user bucket doesn't use up its tokens.
+        if(clientRate > 0)
+        {
+            int64_t retryAfter = clientBucket.check(clientRate, GD::rpcSettings.clientRateLimitBurst(), cost, now);
+            if(retryAfter > 0) return retryAfter;
+        }
+        if(userRate > 0)
+        {
+            std::lock_guard<std::mutex> userBucketsGuard(_userBucketsMutex);
+            int64_t retryAfter = _userBuckets[user].consume(userRate, GD::rpcSettings.userRateLimitBurst(), cost, now);
+            if(retryAfter > 0) return retryAfter;
+        }
+        //Can't fail, as the bucket is only used by this thread and was checked at the same time.
+        if(clientRate > 0) clientBucket.consume(clientRate, GD::rpcSettings.clientRateLimitBurst(), cost, now);
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return 0;
+}
+
+}
+
+}
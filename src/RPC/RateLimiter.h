@@ -0,0 +1,100 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef RATELIMITER_H_
+#define RATELIMITER_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+/**
+ * Token bucket refilled with "rate" tokens per second up to "burst" tokens. The class is not thread safe.
+ */
+class TokenBucket
+{
+public:
+    /**
+     * Takes "cost" tokens from the bucket.
+     *
+     * @param now The current time in milliseconds.
+     * @return 0 when enough tokens were available, otherwise the time in milliseconds until they are. No tokens are
+     * taken in that case.
+     */
+    int64_t consume(uint32_t rate, uint32_t burst, uint32_t cost, int64_t now);
+
+    /**
+     * Like consume(), but no tokens are taken.
+     */
+    int64_t check(uint32_t rate, uint32_t burst, uint32_t cost, int64_t now);
+private:
+    double _tokens = -1;
+    int64_t _lastRefill = 0;
+};
+
+/**
+ * Limits the request rate of RPC clients per connection and per user as configured in "rpc.conf".
+ */
+class RateLimiter
+{
+public:
+    RateLimiter() = default;
+
+    virtual ~RateLimiter() = default;
+
+    /**
+     * Takes the tokens for one method call from the connection's and the user's bucket. When one of the buckets
+     * rejects the call, no tokens are taken from either of them.
+     *
+     * @param clientBucket The bucket of the connection. Must only be used by one thread at a time.
+     * @param user The name of the authenticated user or an empty string.
+     * @param methodName The called method. Used to determine the cost of the call.
+     * @param parameters The parameters of the call. The cost of "system.multicall" is the number of calls.
+     * @return 0 when the call is allowed, otherwise the time in milliseconds until the client should retry.
+     */
+    int64_t acquire(TokenBucket& clientBucket, const std::string& user, const std::string& methodName, const BaseLib::PArray& parameters);
+private:
+    std::mutex _userBucketsMutex;
+    std::unordered_map<std::string, TokenBucket> _userBuckets;
+};
+
+}
+
+}
+
+#endif
@@ -37,6 +37,9 @@ namespace Homegear
 namespace Rpc
 {
 
+std::atomic<uint64_t> RemoteRpcServer::_batchedEvents{0};
+std::atomic<uint64_t> RemoteRpcServer::_eventBatches{0};
+
 RemoteRpcServer::RemoteRpcServer(BaseLib::PRpcClientInfo& serverClientInfo)
 {
 	_serverClientInfo = serverClientInfo;
@@ -45,6 +48,7 @@ RemoteRpcServer::RemoteRpcServer(BaseLib::PRpcClientInfo& serverClientInfo)
 	{
 		_rpcEncoder = std::make_shared<BaseLib::Rpc::RpcEncoder>(GD::bl.get(), true, true);
 		_jsonEncoder = std::make_shared<BaseLib::Rpc::JsonEncoder>(GD::bl.get());
+		_messagePackEncoder = std::make_shared<MessagePackEncoder>();
 		_xmlRpcEncoder = std::make_shared<BaseLib::Rpc::XmlrpcEncoder>(GD::bl.get());
 	}
 	else
@@ -148,11 +152,12 @@ void RemoteRpcServer::processMethods()
 
 			while(_methodBufferHead != _methodBufferTail)
 			{
-				std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>> message = _methodBuffer[_methodBufferTail];
-				_methodBuffer[_methodBufferTail].reset();
-				_methodBufferTail++;
-				if(_methodBufferTail >= _methodBufferSize) _methodBufferTail = 0;
-				if(_methodBufferHead == _methodBufferTail) _methodProcessingMessageAvailable = false; //Set here, because otherwise it might be set to "true" in publish and then set to false again after the while loop
+				std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>> message = dequeueMethod();
+				if(eventBatchWindow > 0 && webSocket && message->first == "event")
+				{
+					auto parameters = collectEventBatch(message, lock);
+					if(parameters) message = std::make_shared<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>>("system.multicall", parameters);
+				}
 				lock.unlock();
 				if(!removed)
 				{
@@ -176,6 +181,73 @@ void RemoteRpcServer::processMethods()
 	}
 }
 
+std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>> RemoteRpcServer::dequeueMethod()
+{
+	std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>> message = _methodBuffer[_methodBufferTail];
+	_methodBuffer[_methodBufferTail].reset();
+	_methodBufferTail++;
+	if(_methodBufferTail >= _methodBufferSize) _methodBufferTail = 0;
+	if(_methodBufferHead == _methodBufferTail) _methodProcessingMessageAvailable = false; //Set here, because otherwise it might be set to "true" in publish and then set to false again after the while loop
+	return message;
+}
+
+std::shared_ptr<std::list<BaseLib::PVariable>> RemoteRpcServer::collectEventBatch(std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>>& event, std::unique_lock<std::mutex>& lock)
+{
+	try
+	{
+		auto calls = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(eventBatchWindow);
+		while(true)
+		{
+			auto call = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+			call->structValue->emplace("methodName", std::make_shared<BaseLib::Variable>(event->first));
+			auto params = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+			params->arrayValue->insert(params->arrayValue->end(), event->second->begin(), event->second->end());
+			call->structValue->emplace("params", params);
+			calls->arrayValue->push_back(call);
+
+			if(calls->arrayValue->size() >= _maxEventBatchSize || _stopMethodProcessingThread) break;
+			if(_methodBufferHead == _methodBufferTail)
+			{
+				_methodProcessingConditionVariable.wait_until(lock, deadline, [&] { return _methodBufferHead != _methodBufferTail || _stopMethodProcessingThread; });
+				if(_methodBufferHead == _methodBufferTail || _stopMethodProcessingThread) break;
+			}
+			if(_methodBuffer[_methodBufferTail]->first != "event") break;
+			event = dequeueMethod();
+		}
+
+		//A single event is sent as is.
+		if(calls->arrayValue->size() == 1) return std::shared_ptr<std::list<BaseLib::PVariable>>();
+
+		_batchedEvents += calls->arrayValue->size();
+		_eventBatches++;
+		auto parameters = std::make_shared<std::list<BaseLib::PVariable>>();
+		parameters->push_back(calls);
+		return parameters;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return std::shared_ptr<std::list<BaseLib::PVariable>>();
+}
+
+BaseLib::PVariable RemoteRpcServer::getEventBatchingMetrics()
+{
+	try
+	{
+		auto metrics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+		metrics->structValue->emplace("webSocketBatchedEvents", std::make_shared<BaseLib::Variable>((int64_t)_batchedEvents.load()));
+		metrics->structValue->emplace("webSocketEventBatches", std::make_shared<BaseLib::Variable>((int64_t)_eventBatches.load()));
+		return metrics;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable RemoteRpcServer::invoke(std::string& methodName, std::shared_ptr<std::list<BaseLib::PVariable>>& parameters)
 {
 	if(_serverClientInfo->sendEventsToRpcServer) return invokeClientMethod(methodName, parameters);
@@ -220,9 +292,12 @@ BaseLib::PVariable RemoteRpcServer::invokeClientMethod(std::string& methodName,
 		}
 		else if(webSocket)
 		{
-			std::vector<char> json;
-			_jsonEncoder->encodeRequest(methodName, parameters, json);
-			BaseLib::WebSocket::encode(json, BaseLib::WebSocket::Header::Opcode::text, encodedPacket);
+			std::vector<char> payload;
+			if(messagePack) _messagePackEncoder->encodeRequest(methodName, parameters, payload);
+			else _jsonEncoder->encodeRequest(methodName, parameters, payload);
+			auto opcode = messagePack ? BaseLib::WebSocket::Header::Opcode::binary : BaseLib::WebSocket::Header::Opcode::text;
+			if(webSocketDeflate) webSocketDeflate->encode(payload, opcode, encodedPacket);
+			else BaseLib::WebSocket::encode(payload, opcode, encodedPacket);
 		}
 		else
 		{
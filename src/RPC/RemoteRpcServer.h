@@ -34,6 +34,8 @@
 #include <homegear-base/BaseLib.h>
 #include "Auth.h"
 #include "ClientSettings.h"
+#include "MessagePackEncoder.h"
+#include "WebSocketDeflate.h"
 
 #include <string>
 #include <memory>
@@ -82,6 +84,18 @@ public:
 	std::mutex sendMutex;
 	int32_t lastPacketSent = -1;
 	std::set<uint64_t> subscribedPeers;
+	std::shared_ptr<WebSocketDeflate> webSocketDeflate;
+
+	/**
+	 * Time in milliseconds events are collected for before they are sent in one "system.multicall". Only used for
+	 * WebSocket clients. 0 disables batching.
+	 */
+	int32_t eventBatchWindow = 0;
+
+	/**
+	 * Set when the WebSocket client requested MessagePack instead of JSON.
+	 */
+	bool messagePack = false;
 
 	BaseLib::PRpcClientInfo& getServerClientInfo() { return _serverClientInfo; }
 
@@ -106,11 +120,13 @@ public:
      */
 	BaseLib::PVariable invoke(std::string& methodName, std::shared_ptr<std::list<BaseLib::PVariable>>& parameters);
 
+	static BaseLib::PVariable getEventBatchingMetrics();
 private:
 	std::shared_ptr<RpcClient> _client;
 	BaseLib::PRpcClientInfo _serverClientInfo;
 	std::shared_ptr<BaseLib::Rpc::RpcEncoder> _rpcEncoder;
 	std::shared_ptr<BaseLib::Rpc::JsonEncoder> _jsonEncoder;
+	std::shared_ptr<MessagePackEncoder> _messagePackEncoder;
 	std::shared_ptr<BaseLib::Rpc::XmlrpcEncoder> _xmlRpcEncoder;
 
 	//{{{ Method queue
@@ -128,8 +144,27 @@ private:
 	std::atomic<int64_t> _lastQueueFullError;
 	//}}}
 
+	//{{{ Event batching
+	static const size_t _maxEventBatchSize = 100;
+	static std::atomic<uint64_t> _batchedEvents;
+	static std::atomic<uint64_t> _eventBatches;
+	//}}}
+
 	void processMethods();
 
+	/**
+	 * Removes the next method from the queue. "_methodProcessingThreadMutex" needs to be locked.
+	 */
+	std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>> dequeueMethod();
+
+	/**
+	 * Collects the events queued within "eventBatchWindow" milliseconds after "event" into the parameters of one
+	 * "system.multicall". Stops at the first queued method which is not an event.
+	 *
+	 * @param lock The locked "_methodProcessingThreadMutex".
+	 */
+	std::shared_ptr<std::list<BaseLib::PVariable>> collectEventBatch(std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>>& event, std::unique_lock<std::mutex>& lock);
+
 	BaseLib::PVariable invokeClientMethod(std::string& methodName, std::shared_ptr<std::list<BaseLib::PVariable>>& parameters);
 };
 
@@ -0,0 +1,237 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "../GD/GD.h"
+#include "ResponseCache.h"
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+bool ResponseCache::getKey(const std::string& methodName, const BaseLib::PRpcClientInfo& clientInfo, const BaseLib::PArray& parameters, std::string& key)
+{
+    key.clear();
+    if(!clientInfo || !clientInfo->acls) return false;
+    key.reserve(methodName.size() + 128);
+    key.append(methodName);
+    key.push_back('\0');
+    //Responses only depend on the ACLs when read ACLs are set. In that case the ACLs are identified by the user. Clients
+    //without user name (e. g. IPC clients) get their ACLs from groups, so their responses are not cached.
+    if(clientInfo->acls->variablesRoomsCategoriesRolesDevicesReadSet())
+    {
+        if(clientInfo->user.empty()) return false;
+        key.append(clientInfo->user);
+    }
+    key.push_back('\0');
+    key.append(std::to_string((int32_t)clientInfo->clientType));
+    key.push_back(clientInfo->initNewFormat ? '1' : '0');
+    key.append(clientInfo->language);
+    key.push_back('\0');
+    for(auto& parameter : *parameters)
+    {
+        appendKey(parameter, key);
+    }
+    return true;
+}
+
+void ResponseCache::appendKey(const BaseLib::PVariable& variable, std::string& key)
+{
+    if(!variable)
+    {
+        key.push_back('n');
+        return;
+    }
+    switch(variable->type)
+    {
+        case BaseLib::VariableType::tInteger:
+            key.append("i" + std::to_string(variable->integerValue));
+            break;
+        case BaseLib::VariableType::tInteger64:
+            key.append("i" + std::to_string(variable->integerValue64));
+            break;
+        case BaseLib::VariableType::tBoolean:
+            key.append(variable->booleanValue ? "b1" : "b0");
+            break;
+        case BaseLib::VariableType::tString:
+            key.append("s" + std::to_string(variable->stringValue.size()) + ":" + variable->stringValue);
+            break;
+        case BaseLib::VariableType::tArray:
+            key.append("a" + std::to_string(variable->arrayValue->size()) + ":");
+            for(auto& element : *variable->arrayValue)
+            {
+                appendKey(element, key);
+            }
+            break;
+        case BaseLib::VariableType::tStruct:
+            key.append("t" + std::to_string(variable->structValue->size()) + ":");
+            for(auto& element : *variable->structValue)
+            {
+                key.append(std::to_string(element.first.size()) + ":" + element.first);
+                appendKey(element.second, key);
+            }
+            break;
+        default:
+            std::string value = variable->toString();
+            key.append("v" + std::to_string((int32_t)variable->type) + ":" + std::to_string(value.size()) + ":" + value);
+            break;
+    }
+    key.push_back(',');
+}
+
+BaseLib::PVariable ResponseCache::get(const std::string& methodName, const BaseLib::PRpcClientInfo& clientInfo, const BaseLib::PArray& parameters, uint64_t& version)
+{
+    try
+    {
+        version = _version;
+        if(GD::rpcSettings.responseCacheSize() == 0) return BaseLib::PVariable();
+        std::string key;
+        if(!getKey(methodName, clientInfo, parameters, key)) return BaseLib::PVariable();
+
+        std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+        version = _version;
+        auto entriesIterator = _entries.find(key);
+        if(entriesIterator == _entries.end())
+        {
+            _misses++;
+            return BaseLib::PVariable();
+        }
+        _lru.splice(_lru.end(), _lru, entriesIterator->second.lruIterator);
+        _hits++;
+        return entriesIterator->second.response;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return BaseLib::PVariable();
+}
+
+bool ResponseCache::contains(const std::string& methodName, const BaseLib::PRpcClientInfo& clientInfo, const BaseLib::PArray& parameters)
+{
+    try
+    {
+        if(GD::rpcSettings.responseCacheSize() == 0) return false;
+        std::string key;
+        if(!getKey(methodName, clientInfo, parameters, key)) return false;
+
+        std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+        return _entries.find(key) != _entries.end();
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return false;
+}
+
+void ResponseCache::set(const std::string& methodName, const BaseLib::PRpcClientInfo& clientInfo, const BaseLib::PArray& parameters, uint64_t version, const BaseLib::PVariable& response)
+{
+    try
+    {
+        if(!response || response->errorStruct) return;
+        uint32_t maxEntries = GD::rpcSettings.responseCacheSize();
+        if(maxEntries == 0) return;
+        std::string key;
+        if(!getKey(methodName, clientInfo, parameters, key)) return;
+
+        std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+        if(version != _version) return;
+        auto entriesIterator = _entries.find(key);
+        if(entriesIterator != _entries.end())
+        {
+            entriesIterator->second.response = response;
+            _lru.splice(_lru.end(), _lru, entriesIterator->second.lruIterator);
+            return;
+        }
+
+        while(_entries.size() >= maxEntries && !_lru.empty())
+        {
+            _entries.erase(_lru.front());
+            _lru.pop_front();
+            _evictions++;
+        }
+
+        Entry entry;
+        entry.response = response;
+        entry.lruIterator = _lru.insert(_lru.end(), key);
+        _entries.emplace(key, std::move(entry));
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+void ResponseCache::invalidate()
+{
+    try
+    {
+        std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+        _version++;
+        _invalidations++;
+        _entries.clear();
+        _lru.clear();
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+BaseLib::PVariable ResponseCache::getMetrics()
+{
+    try
+    {
+        auto metrics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        uint64_t hits = _hits;
+        uint64_t misses = _misses;
+        {
+            std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+            metrics->structValue->emplace("responseCacheEntries", std::make_shared<BaseLib::Variable>((int64_t)_entries.size()));
+        }
+        metrics->structValue->emplace("responseCacheHits", std::make_shared<BaseLib::Variable>((int64_t)hits));
+        metrics->structValue->emplace("responseCacheMisses", std::make_shared<BaseLib::Variable>((int64_t)misses));
+        metrics->structValue->emplace("responseCacheHitRate", std::make_shared<BaseLib::Variable>(hits + misses > 0 ? (double)hits / (hits + misses) : 0.0));
+        metrics->structValue->emplace("responseCacheInvalidations", std::make_shared<BaseLib::Variable>((int64_t)_invalidations));
+        metrics->structValue->emplace("responseCacheEvictions", std::make_shared<BaseLib::Variable>((int64_t)_evictions));
+        return metrics;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+}
+
+}
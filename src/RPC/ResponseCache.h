@@ -0,0 +1,135 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef RESPONSECACHE_H_
+#define RESPONSECACHE_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+/**
+ * Caches the responses of RPC methods returning device metadata like "listDevices" or "getParamsetDescription". Entries
+ * are keyed by method name, parameters and the client's ACLs. The whole cache is invalidated when devices are added,
+ * deleted or reconfigured. When the cache is full, the least recently used entries are evicted. The class is thread
+ * safe.
+ */
+class ResponseCache
+{
+public:
+    /**
+     * Invalidates the cache when it goes out of scope. Used by RPC methods changing device metadata, so all of their
+     * return paths invalidate the cache after the change is done.
+     */
+    class InvalidationGuard
+    {
+    public:
+        explicit InvalidationGuard(ResponseCache& cache) : _cache(cache) {}
+
+        ~InvalidationGuard() { _cache.invalidate(); }
+    private:
+        ResponseCache& _cache;
+    };
+
+    ResponseCache() = default;
+
+    virtual ~ResponseCache() = default;
+
+    /**
+     * Looks up the cached response of a method call.
+     *
+     * @param version Set to the current cache version. Pass it to set() when no response is cached.
+     * @return The cached response or nullptr. Cached responses are shared between clients and must not be modified.
+     */
+    BaseLib::PVariable get(const std::string& methodName, const BaseLib::PRpcClientInfo& clientInfo, const BaseLib::PArray& parameters, uint64_t& version);
+
+    /**
+     * Stores the response of a method call. Errors are not cached. The response is dropped, when the cache was
+     * invalidated after "version" was returned by get().
+     */
+    void set(const std::string& methodName, const BaseLib::PRpcClientInfo& clientInfo, const BaseLib::PArray& parameters, uint64_t version, const BaseLib::PVariable& response);
+
+    /**
+     * Checks if the response of a method call is cached without counting a hit or miss.
+     */
+    bool contains(const std::string& methodName, const BaseLib::PRpcClientInfo& clientInfo, const BaseLib::PArray& parameters);
+
+    /**
+     * Removes all entries.
+     */
+    void invalidate();
+
+    /**
+     * Returns the current cache version. It is incremented on every invalidation.
+     */
+    uint64_t version() { return _version; }
+
+    BaseLib::PVariable getMetrics();
+private:
+    struct Entry
+    {
+        BaseLib::PVariable response;
+        std::list<std::string>::iterator lruIterator;
+    };
+
+    std::mutex _entriesMutex;
+    std::unordered_map<std::string, Entry> _entries;
+    std::list<std::string> _lru;
+    std::atomic<uint64_t> _version{1};
+    std::atomic<uint64_t> _hits{0};
+    std::atomic<uint64_t> _misses{0};
+    std::atomic<uint64_t> _invalidations{0};
+    std::atomic<uint64_t> _evictions{0};
+
+    /**
+     * Creates the cache key of a method call.
+     *
+     * @return false when the response can't be cached for this client.
+     */
+    static bool getKey(const std::string& methodName, const BaseLib::PRpcClientInfo& clientInfo, const BaseLib::PArray& parameters, std::string& key);
+
+    static void appendKey(const BaseLib::PVariable& variable, std::string& key);
+};
+
+}
+
+}
+
+#endif
@@ -53,6 +53,8 @@ RpcClient::RpcClient()
         _xmlRpcEncoder = std::unique_ptr<BaseLib::Rpc::XmlrpcEncoder>(new BaseLib::Rpc::XmlrpcEncoder(GD::bl.get()));
         _jsonDecoder = std::unique_ptr<BaseLib::Rpc::JsonDecoder>(new BaseLib::Rpc::JsonDecoder(GD::bl.get()));
         _jsonEncoder = std::unique_ptr<BaseLib::Rpc::JsonEncoder>(new BaseLib::Rpc::JsonEncoder(GD::bl.get()));
+        _messagePackDecoder = std::unique_ptr<MessagePackDecoder>(new MessagePackDecoder());
+        _messagePackEncoder = std::unique_ptr<MessagePackEncoder>(new MessagePackEncoder());
     }
     catch(const std::exception& ex)
     {
@@ -118,9 +120,12 @@ void RpcClient::invokeBroadcast(RemoteRpcServer* server, std::string methodName,
         if(server->binary) _rpcEncoder->encodeRequest(methodName, parameters, requestData);
         else if(server->webSocket)
         {
-            std::vector<char> json;
-            _jsonEncoder->encodeRequest(methodName, parameters, json);
-            BaseLib::WebSocket::encode(json, BaseLib::WebSocket::Header::Opcode::text, requestData);
+            std::vector<char> payload;
+            if(server->messagePack) _messagePackEncoder->encodeRequest(methodName, parameters, payload);
+            else _jsonEncoder->encodeRequest(methodName, parameters, payload);
+            auto opcode = server->messagePack ? BaseLib::WebSocket::Header::Opcode::binary : BaseLib::WebSocket::Header::Opcode::text;
+            if(server->webSocketDeflate) server->webSocketDeflate->encode(payload, opcode, requestData);
+            else BaseLib::WebSocket::encode(payload, opcode, requestData);
         }
         else if(server->json) _jsonEncoder->encodeRequest(methodName, parameters, requestData);
         else _xmlRpcEncoder->encodeRequest(methodName, parameters, requestData);
@@ -166,6 +171,7 @@ void RpcClient::invokeBroadcast(RemoteRpcServer* server, std::string methodName,
         }
         BaseLib::PVariable returnValue;
         if(server->binary) returnValue = _rpcDecoder->decodeResponse(responseData);
+        else if(server->webSocket && server->messagePack) returnValue = _messagePackDecoder->decodeResponse(responseData);
         else if(server->webSocket || server->json) returnValue = _jsonDecoder->decode(responseData);
         else returnValue = _xmlRpcDecoder->decodeResponse(responseData);
 
@@ -224,9 +230,12 @@ BaseLib::PVariable RpcClient::invoke(RemoteRpcServer* server, std::string method
         if(server->binary) _rpcEncoder->encodeRequest(methodName, parameters, requestData);
         else if(server->webSocket)
         {
-            std::vector<char> json;
-            _jsonEncoder->encodeRequest(methodName, parameters, json);
-            BaseLib::WebSocket::encode(json, BaseLib::WebSocket::Header::Opcode::text, requestData);
+            std::vector<char> payload;
+            if(server->messagePack) _messagePackEncoder->encodeRequest(methodName, parameters, payload);
+            else _jsonEncoder->encodeRequest(methodName, parameters, payload);
+            auto opcode = server->messagePack ? BaseLib::WebSocket::Header::Opcode::binary : BaseLib::WebSocket::Header::Opcode::text;
+            if(server->webSocketDeflate) server->webSocketDeflate->encode(payload, opcode, requestData);
+            else BaseLib::WebSocket::encode(payload, opcode, requestData);
         }
         else if(server->json) _jsonEncoder->encodeRequest(methodName, parameters, requestData);
         else _xmlRpcEncoder->encodeRequest(methodName, parameters, requestData);
@@ -264,6 +273,7 @@ BaseLib::PVariable RpcClient::invoke(RemoteRpcServer* server, std::string method
         }
         BaseLib::PVariable returnValue;
         if(server->binary) returnValue = _rpcDecoder->decodeResponse(responseData);
+        else if(server->webSocket && server->messagePack) returnValue = _messagePackDecoder->decodeResponse(responseData);
         else if(server->webSocket || server->json) returnValue = _jsonDecoder->decode(responseData);
         else returnValue = _xmlRpcDecoder->decodeResponse(responseData);
         if(returnValue->errorStruct)
@@ -570,6 +580,12 @@ void RpcClient::sendRequest(RemoteRpcServer* server, std::vector<char>& data, st
                               << std::string(buffer, receivedBytes) << std::endl;
                     return;
                 }
+                if(webSocket.isFinished() && webSocket.getHeader().rsv1 && (!server->webSocketDeflate || !server->webSocketDeflate->decode(webSocket.getContent())))
+                {
+                    server->socket->close();
+                    _out.printError("Error: Could not decompress WebSocket message from " + server->hostname + ".");
+                    return;
+                }
                 if(http.getContentSize() > 10485760 || http.getHeader().contentLength > 10485760)
                 {
                     if(!server->keepAlive) server->socket->close();
@@ -34,6 +34,7 @@
 #include "ClientSettings.h"
 #include <homegear-base/BaseLib.h>
 #include "Auth.h"
+#include "MessagePackDecoder.h"
 #include "RemoteRpcServer.h"
 
 #include <iostream>
@@ -82,6 +83,8 @@ protected:
     std::unique_ptr<BaseLib::Rpc::XmlrpcEncoder> _xmlRpcEncoder;
     std::unique_ptr<BaseLib::Rpc::JsonDecoder> _jsonDecoder;
     std::unique_ptr<BaseLib::Rpc::JsonEncoder> _jsonEncoder;
+    std::unique_ptr<MessagePackDecoder> _messagePackDecoder;
+    std::unique_ptr<MessagePackEncoder> _messagePackEncoder;
 
     std::pair<std::string, std::string> basicAuth(std::string& userName, std::string& password);
 
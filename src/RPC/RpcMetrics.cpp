@@ -0,0 +1,253 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "../GD/GD.h"
+#include "RpcMetrics.h"
+
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+const std::array<int64_t, 10> RpcMetrics::_bucketBounds{{100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000, 5000000}};
+
+void RpcMetrics::record(const std::string& methodName, const std::string& clientAddress, int64_t duration, bool error)
+{
+    try
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+            addSample(_methods[methodName], duration, error);
+            addSample(getClientSeries(clientAddress), duration, error);
+        }
+        _records++;
+        _recordTime += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+void RpcMetrics::recordThrottled(const std::string& methodName, const std::string& clientAddress)
+{
+    try
+    {
+        std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+        _methods[methodName].throttled++;
+        getClientSeries(clientAddress).throttled++;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+RpcMetrics::Series& RpcMetrics::getClientSeries(const std::string& clientAddress)
+{
+    const std::string& client = clientAddress.empty() ? "local" : clientAddress;
+    auto clientIterator = _clients.find(client);
+    if(clientIterator != _clients.end()) return clientIterator->second;
+    else if(_clients.size() < _maxClients) return _clients[client];
+    return _clients["other"];
+}
+
+void RpcMetrics::addSample(Series& series, int64_t duration, bool error)
+{
+    series.count++;
+    if(error) series.errors++;
+    series.time += duration;
+    if(duration > series.maxTime) series.maxTime = duration;
+    size_t bucket = 0;
+    while(bucket < _bucketBounds.size() && duration > _bucketBounds[bucket]) bucket++;
+    series.buckets[bucket]++;
+}
+
+std::string RpcMetrics::escapeLabel(const std::string& value)
+{
+    std::string escapedValue;
+    escapedValue.reserve(value.size());
+    for(auto character : value)
+    {
+        if(character == '\\') escapedValue.append("\\\\");
+        else if(character == '"') escapedValue.append("\\\"");
+        else if(character == '\n') escapedValue.append("\\n");
+        else escapedValue.push_back(character);
+    }
+    return escapedValue;
+}
+
+void RpcMetrics::appendHistogram(std::ostringstream& output, const std::string& name, const std::string& label, const std::unordered_map<std::string, Series>& series)
+{
+    output << "# HELP " << name << "_duration_seconds Execution time of RPC method calls." << "\n";
+    output << "# TYPE " << name << "_duration_seconds histogram" << "\n";
+    for(auto& element : series)
+    {
+        std::string labelValue = escapeLabel(element.first);
+        uint64_t count = 0;
+        for(size_t i = 0; i < _bucketBounds.size(); i++)
+        {
+            count += element.second.buckets[i];
+            output << name << "_duration_seconds_bucket{" << label << "=\"" << labelValue << "\",le=\"" << ((double)_bucketBounds[i] / 1000000) << "\"} " << count << "\n";
+        }
+        output << name << "_duration_seconds_bucket{" << label << "=\"" << labelValue << "\",le=\"+Inf\"} " << element.second.count << "\n";
+        output << name << "_duration_seconds_sum{" << label << "=\"" << labelValue << "\"} " << ((double)element.second.time / 1000000) << "\n";
+        output << name << "_duration_seconds_count{" << label << "=\"" << labelValue << "\"} " << element.second.count << "\n";
+    }
+    output << "# HELP " << name << "_errors_total RPC method calls returning an error." << "\n";
+    output << "# TYPE " << name << "_errors_total counter" << "\n";
+    for(auto& element : series)
+    {
+        output << name << "_errors_total{" << label << "=\"" << escapeLabel(element.first) << "\"} " << element.second.errors << "\n";
+    }
+    output << "# HELP " << name << "_throttled_total RPC method calls rejected by the rate limiter." << "\n";
+    output << "# TYPE " << name << "_throttled_total counter" << "\n";
+    for(auto& element : series)
+    {
+        output << name << "_throttled_total{" << label << "=\"" << escapeLabel(element.first) << "\"} " << element.second.throttled << "\n";
+    }
+}
+
+BaseLib::PVariable RpcMetrics::getMetrics()
+{
+    try
+    {
+        auto metrics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        auto methods = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        auto clients = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        {
+            std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+            for(int32_t i = 0; i < 2; i++)
+            {
+                auto& series = i == 0 ? _methods : _clients;
+                auto& target = i == 0 ? methods : clients;
+                for(auto& element : series)
+                {
+                    auto entry = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+                    entry->structValue->emplace("calls", std::make_shared<BaseLib::Variable>((int64_t)element.second.count));
+                    entry->structValue->emplace("errors", std::make_shared<BaseLib::Variable>((int64_t)element.second.errors));
+                    entry->structValue->emplace("throttled", std::make_shared<BaseLib::Variable>((int64_t)element.second.throttled));
+                    entry->structValue->emplace("time", std::make_shared<BaseLib::Variable>((int64_t)element.second.time));
+                    entry->structValue->emplace("averageLatency", std::make_shared<BaseLib::Variable>((int64_t)(element.second.count > 0 ? element.second.time / (int64_t)element.second.count : 0)));
+                    entry->structValue->emplace("maxLatency", std::make_shared<BaseLib::Variable>((int64_t)element.second.maxTime));
+                    target->structValue->emplace(element.first, entry);
+                }
+            }
+        }
+        metrics->structValue->emplace("methods", methods);
+        metrics->structValue->emplace("clients", clients);
+        uint64_t records = _records;
+        metrics->structValue->emplace("recordedCalls", std::make_shared<BaseLib::Variable>((int64_t)records));
+        metrics->structValue->emplace("averageRecordOverheadNs", std::make_shared<BaseLib::Variable>((int64_t)(records > 0 ? _recordTime / (int64_t)records : 0)));
+        return metrics;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+std::string RpcMetrics::getPrometheusMetrics()
+{
+    try
+    {
+        std::ostringstream output;
+        output << std::setprecision(9);
+        {
+            std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+            appendHistogram(output, "homegear_rpc_method", "method", _methods);
+            appendHistogram(output, "homegear_rpc_client", "client", _clients);
+        }
+
+        output << "# HELP homegear_rpc_server_connections Open connections of the RPC servers." << "\n";
+        output << "# TYPE homegear_rpc_server_connections gauge" << "\n";
+        for(auto& server : GD::rpcServers)
+        {
+            if(!server.second->isRunning()) continue;
+            output << "homegear_rpc_server_connections{port=\"" << server.second->getInfo()->port << "\"} " << server.second->connectionCount() << "\n";
+        }
+        output << "# HELP homegear_rpc_server_queue_size Connections waiting for a worker thread of the RPC servers." << "\n";
+        output << "# TYPE homegear_rpc_server_queue_size gauge" << "\n";
+        for(auto& server : GD::rpcServers)
+        {
+            if(!server.second->isRunning()) continue;
+            output << "homegear_rpc_server_queue_size{port=\"" << server.second->getInfo()->port << "\"} " << server.second->queueSize(0) << "\n";
+        }
+
+        auto databaseController = dynamic_cast<DatabaseController*>(GD::bl->db.get());
+        if(databaseController)
+        {
+            output << "# HELP homegear_database_queue_size Writes waiting in the database queue." << "\n";
+            output << "# TYPE homegear_database_queue_size gauge" << "\n";
+            output << "homegear_database_queue_size " << databaseController->queueSize(0) << "\n";
+        }
+
+        auto cacheMetrics = GD::rpcResponseCache.getMetrics();
+        output << "# HELP homegear_rpc_response_cache_hits_total Metadata responses served from the cache." << "\n";
+        output << "# TYPE homegear_rpc_response_cache_hits_total counter" << "\n";
+        output << "homegear_rpc_response_cache_hits_total " << cacheMetrics->structValue->at("responseCacheHits")->integerValue64 << "\n";
+        output << "# HELP homegear_rpc_response_cache_misses_total Metadata responses not found in the cache." << "\n";
+        output << "# TYPE homegear_rpc_response_cache_misses_total counter" << "\n";
+        output << "homegear_rpc_response_cache_misses_total " << cacheMetrics->structValue->at("responseCacheMisses")->integerValue64 << "\n";
+
+        auto aclCacheMetrics = GD::aclCache.getMetrics();
+        output << "# HELP homegear_rpc_acl_cache_hits_total ACL decisions served from the cache." << "\n";
+        output << "# TYPE homegear_rpc_acl_cache_hits_total counter" << "\n";
+        output << "homegear_rpc_acl_cache_hits_total " << aclCacheMetrics->structValue->at("aclCacheHits")->integerValue64 << "\n";
+        output << "# HELP homegear_rpc_acl_cache_misses_total ACL decisions not found in the cache." << "\n";
+        output << "# TYPE homegear_rpc_acl_cache_misses_total counter" << "\n";
+        output << "homegear_rpc_acl_cache_misses_total " << aclCacheMetrics->structValue->at("aclCacheMisses")->integerValue64 << "\n";
+
+        uint64_t records = _records;
+        output << "# HELP homegear_rpc_metrics_overhead_seconds_total Time spent recording RPC metrics." << "\n";
+        output << "# TYPE homegear_rpc_metrics_overhead_seconds_total counter" << "\n";
+        output << "homegear_rpc_metrics_overhead_seconds_total " << ((double)_recordTime / 1000000000) << "\n";
+        output << "# HELP homegear_rpc_metrics_records_total Recorded RPC method calls." << "\n";
+        output << "# TYPE homegear_rpc_metrics_records_total counter" << "\n";
+        output << "homegear_rpc_metrics_records_total " << records << "\n";
+        return output.str();
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return "";
+}
+
+}
+
+}
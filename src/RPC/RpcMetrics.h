@@ -0,0 +1,126 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef RPCMETRICS_H_
+#define RPCMETRICS_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+/**
+ * Collects call counts and latency histograms of the methods called on the RPC servers, per method and per client
+ * address. The metrics can be exported in the Prometheus text format. The class is thread safe.
+ */
+class RpcMetrics
+{
+public:
+    RpcMetrics() = default;
+
+    virtual ~RpcMetrics() = default;
+
+    /**
+     * Records a finished method call.
+     *
+     * @param methodName The name of the called method.
+     * @param clientAddress The address of the calling client. Empty for local callers.
+     * @param duration The execution time in microseconds.
+     * @param error Set to true when the method returned an error.
+     */
+    void record(const std::string& methodName, const std::string& clientAddress, int64_t duration, bool error);
+
+    /**
+     * Records a method call rejected by the rate limiter. A series is created for every method name, so names sent by
+     * clients need to be checked by the caller.
+     */
+    void recordThrottled(const std::string& methodName, const std::string& clientAddress);
+
+    /**
+     * Returns the metrics of all methods and clients. Times are in microseconds.
+     */
+    BaseLib::PVariable getMetrics();
+
+    /**
+     * Returns all metrics including connection counts and queue sizes in the Prometheus text exposition format.
+     */
+    std::string getPrometheusMetrics();
+private:
+    /**
+     * Upper bounds of the histogram buckets in microseconds. The last bucket is unbounded.
+     */
+    static const std::array<int64_t, 10> _bucketBounds;
+    /**
+     * Calls from more client addresses are counted as "other".
+     */
+    static const size_t _maxClients = 256;
+
+    struct Series
+    {
+        uint64_t count = 0;
+        uint64_t errors = 0;
+        uint64_t throttled = 0;
+        int64_t time = 0;
+        int64_t maxTime = 0;
+        std::array<uint64_t, 11> buckets{};
+    };
+
+    std::mutex _seriesMutex;
+    std::unordered_map<std::string, Series> _methods;
+    std::unordered_map<std::string, Series> _clients;
+    std::atomic<uint64_t> _records{0};
+    std::atomic<int64_t> _recordTime{0};
+
+    /**
+     * Returns the series of a client address. _seriesMutex must be locked.
+     */
+    Series& getClientSeries(const std::string& clientAddress);
+
+    static void addSample(Series& series, int64_t duration, bool error);
+
+    static std::string escapeLabel(const std::string& value);
+
+    static void appendHistogram(std::ostringstream& output, const std::string& name, const std::string& label, const std::unordered_map<std::string, Series>& series);
+};
+
+}
+
+}
+
+#endif
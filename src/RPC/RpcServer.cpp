@@ -33,6 +33,9 @@
 #include <homegear-base/BaseLib.h>
 #include <gnutls/gnutls.h>
 
+#include <sys/epoll.h>
+#include <fcntl.h>
+
 #if GNUTLS_VERSION_NUMBER < 0x030400
 int gnutls_system_recv_timeout(gnutls_transport_ptr_t ptr, unsigned int ms)
 {
@@ -75,15 +78,15 @@ RpcServer::Client::Client()
     socket = std::shared_ptr<BaseLib::TcpSocket>(new BaseLib::TcpSocket(GD::bl.get()));
     socketDescriptor = std::shared_ptr<BaseLib::FileDescriptor>(new BaseLib::FileDescriptor());
     waitForResponse = false;
+    binaryRpc.reset(new BaseLib::Rpc::BinaryRpc(GD::bl.get()));
 }
 
 RpcServer::Client::~Client()
 {
     GD::bl->fileDescriptorManager.shutdown(socketDescriptor);
-    GD::bl->threadManager.join(readThread);
 }
 
-RpcServer::RpcServer()
+RpcServer::RpcServer() : IQueue(GD::bl.get(), 2, 100000)
 {
     _out.init(GD::bl.get());
 
@@ -94,6 +97,8 @@ RpcServer::RpcServer()
     _xmlRpcEncoder = std::unique_ptr<BaseLib::Rpc::XmlrpcEncoder>(new BaseLib::Rpc::XmlrpcEncoder(GD::bl.get()));
     _jsonDecoder = std::unique_ptr<BaseLib::Rpc::JsonDecoder>(new BaseLib::Rpc::JsonDecoder(GD::bl.get()));
     _jsonEncoder = std::unique_ptr<BaseLib::Rpc::JsonEncoder>(new BaseLib::Rpc::JsonEncoder(GD::bl.get()));
+    _messagePackDecoder = std::unique_ptr<MessagePackDecoder>(new MessagePackDecoder());
+    _messagePackEncoder = std::unique_ptr<MessagePackEncoder>(new MessagePackEncoder());
 
     _info.reset(new BaseLib::Rpc::ServerInfo::Info());
     _serverFileDescriptor.reset(new BaseLib::FileDescriptor);
@@ -187,6 +192,7 @@ RpcServer::RpcServer()
     _rpcMethods->emplace("getRoomMetadata", std::make_shared<RPCGetRoomMetadata>());
     _rpcMethods->emplace("getRooms", std::make_shared<RPCGetRooms>());
     _rpcMethods->emplace("getRoomsInStory", std::make_shared<RPCGetRoomsInStory>());
+    _rpcMethods->emplace("getRpcMetrics", std::make_shared<RPCGetRpcMetrics>());
     _rpcMethods->emplace("getServiceMessages", std::make_shared<RPCGetServiceMessages>());
     _rpcMethods->emplace("getSniffedDevices", std::make_shared<RPCGetSniffedDevices>());
     _rpcMethods->emplace("getStories", std::make_shared<RPCGetStories>());
@@ -198,6 +204,7 @@ RpcServer::RpcServer()
     _rpcMethods->emplace("getUpdateStatus", std::make_shared<RPCGetUpdateStatus>());
     _rpcMethods->emplace("getValue", std::make_shared<RPCGetValue>());
     _rpcMethods->emplace("getVariableDescription", std::make_shared<RPCGetVariableDescription>());
+    _rpcMethods->emplace("getVariableHistory", std::make_shared<RPCGetVariableHistory>());
     _rpcMethods->emplace("getVariablesInCategory", std::make_shared<RPCGetVariablesInCategory>());
     _rpcMethods->emplace("getVariablesInRoom", std::make_shared<RPCGetVariablesInRoom>());
     _rpcMethods->emplace("getVersion", std::make_shared<RPCGetVersion>());
@@ -532,6 +539,20 @@ void RpcServer::start(BaseLib::Rpc::PServerInfo& info)
         }
         _webServer.reset(new WebServer::WebServer(_info));
         _restServer.reset(new RestServer(_info));
+        _epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+        if(_epollDescriptor == -1)
+        {
+            _out.printError("Error: Could not create epoll instance: " + std::string(strerror(errno)));
+            return;
+        }
+        //Sockets are read without blocking, so a few threads read all connections.
+        uint32_t readThreadCount = std::thread::hardware_concurrency();
+        if(readThreadCount < 2) readThreadCount = 2;
+        uint32_t workerThreadCount = std::thread::hardware_concurrency() * 2;
+        if(workerThreadCount < 10) workerThreadCount = 10;
+        startQueue(0, true, readThreadCount, _threadPriority, _threadPolicy);
+        startQueue(1, true, workerThreadCount, _threadPriority, _threadPolicy);
+        GD::bl->threadManager.start(_eventLoopThread, true, _threadPriority, _threadPolicy, &RpcServer::eventLoop, this);
         GD::bl->threadManager.start(_mainThread, true, _threadPriority, _threadPolicy, &RpcServer::mainThread, this);
         _stopped = false;
     }
@@ -553,6 +574,7 @@ void RpcServer::stop()
         _stopped = true;
         _stopServer = true;
         GD::bl->threadManager.join(_mainThread);
+        GD::bl->threadManager.join(_eventLoopThread);
         _out.printInfo("Info: Waiting for threads to finish.");
 
         {
@@ -562,6 +584,13 @@ void RpcServer::stop()
                 closeClientConnection(i->second);
             }
         }
+        stopQueue(0);
+        stopQueue(1);
+        if(_epollDescriptor != -1)
+        {
+            close(_epollDescriptor);
+            _epollDescriptor = -1;
+        }
 
         while(_clients.size() > 0)
         {
@@ -704,6 +733,7 @@ void RpcServer::mainThread()
                     client->socket->setWriteTimeout(15000000);
                     client->address = address;
                     client->port = port;
+                    setBlocking(client, false);
 
 #ifdef CCU2
                     if(client->address == "127.0.0.1")
@@ -713,7 +743,8 @@ void RpcServer::mainThread()
                     }
 #endif
 
-                    GD::bl->threadManager.start(client->readThread, false, _threadPriority, _threadPolicy, &RpcServer::readClient, this, client);
+                    _out.printDebug("Listening for incoming packets from client number " + std::to_string(client->socketDescriptor->id) + ".");
+                    watchClient(client);
                 }
                 catch(const std::exception& ex)
                 {
@@ -812,6 +843,7 @@ void RpcServer::analyzeRPC(std::shared_ptr<Client> client, const std::vector<cha
         else if(packetType == PacketType::Enum::xmlRequest) responseType = PacketType::Enum::xmlResponse;
         else if(packetType == PacketType::Enum::jsonRequest) responseType = PacketType::Enum::jsonResponse;
         else if(packetType == PacketType::Enum::webSocketRequest) responseType = PacketType::Enum::webSocketResponse;
+        else if(packetType == PacketType::Enum::messagePackRequest) responseType = PacketType::Enum::messagePackResponse;
 
         std::string methodName;
         int32_t messageId = 0;
@@ -827,11 +859,17 @@ void RpcServer::analyzeRPC(std::shared_ptr<Client> client, const std::vector<cha
             if(client->rpcType == BaseLib::RpcType::unknown) client->rpcType = BaseLib::RpcType::xml;
             parameters = _xmlRpcDecoder->decodeRequest(packet, methodName);
         }
-        else if(packetType == PacketType::Enum::jsonRequest || packetType == PacketType::Enum::webSocketRequest)
+        else if(packetType == PacketType::Enum::jsonRequest || packetType == PacketType::Enum::webSocketRequest || packetType == PacketType::Enum::messagePackRequest)
         {
             if(client->rpcType == BaseLib::RpcType::unknown) client->rpcType = BaseLib::RpcType::json;
-            BaseLib::PVariable result = _jsonDecoder->decode(packet);
-            if(result->type == BaseLib::VariableType::tStruct)
+            //MessagePack requests have the same structure as JSON-RPC requests.
+            BaseLib::PVariable result = (packetType == PacketType::Enum::messagePackRequest || (packetType == PacketType::Enum::webSocketRequest && client->messagePack)) ? _messagePackDecoder->decode(packet) : _jsonDecoder->decode(packet);
+            if(result->type == BaseLib::VariableType::tArray)
+            {
+                callJsonBatch(client, result, responseType, keepAlive);
+                return;
+            }
+            else if(result->type == BaseLib::VariableType::tStruct)
             {
                 if(result->structValue->find("user") != result->structValue->end())
                 {
@@ -850,7 +888,7 @@ void RpcServer::analyzeRPC(std::shared_ptr<Client> client, const std::vector<cha
                         sendRPCResponseToClient(client, BaseLib::Variable::createError(-32500, "Could not decode RPC packet. \"method\" and \"result\" not found in JSON."), messageId, responseType, keepAlive);
                         return;
                     }
-                    analyzeRPCResponse(client, packet, PacketType::Enum::webSocketResponse, keepAlive);
+                    analyzeRPCResponse(client, packet, packetType == PacketType::Enum::messagePackRequest ? PacketType::Enum::messagePackResponse : PacketType::Enum::webSocketResponse, keepAlive);
                     return;
                 }
                 methodName = methodIterator->second->stringValue;
@@ -922,11 +960,25 @@ void RpcServer::sendRPCResponseToClient(std::shared_ptr<Client> client, BaseLib:
                 _out.printDebug("Response packet: " + std::string(&data.at(0), data.size()));
             }
         }
+        else if(responseType == PacketType::Enum::messagePackResponse)
+        {
+            _messagePackEncoder->encodeResponse(variable, messageId, data);
+            std::string header = getHttpResponseHeader("application/msgpack", data.size(), !keepAlive);
+            data.insert(data.begin(), header.begin(), header.end());
+            if(GD::bl->debugLevel >= 5)
+            {
+                _out.printDebug("Response MessagePack packet: ");
+                _out.printBinary(data);
+            }
+        }
         else if(responseType == PacketType::Enum::webSocketResponse)
         {
-            std::vector<char> json;
-            _jsonEncoder->encodeResponse(variable, messageId, json);
-            BaseLib::WebSocket::encode(json, BaseLib::WebSocket::Header::Opcode::text, data);
+            std::vector<char> payload;
+            if(client->messagePack) _messagePackEncoder->encodeResponse(variable, messageId, payload);
+            else _jsonEncoder->encodeResponse(variable, messageId, payload);
+            auto opcode = client->messagePack ? BaseLib::WebSocket::Header::Opcode::binary : BaseLib::WebSocket::Header::Opcode::text;
+            if(client->webSocketDeflate) client->webSocketDeflate->encode(payload, opcode, data);
+            else BaseLib::WebSocket::encode(payload, opcode, data);
             if(GD::bl->debugLevel >= 5)
             {
                 _out.printDebug("Response WebSocket packet: ");
@@ -970,15 +1022,21 @@ BaseLib::PVariable RpcServer::callMethod(BaseLib::PRpcClientInfo clientInfo, std
     {
         if(!parameters) parameters = BaseLib::PVariable(new BaseLib::Variable(BaseLib::VariableType::tArray));
         if(GD::bl->shuttingDown) return BaseLib::Variable::createError(100000, "Server is stopped.");
+        int64_t startTime = GD::rpcSettings.metrics() ? BaseLib::HelperFunctions::getTimeMicroseconds() : 0;
         auto rpcMethodsIterator = _rpcMethods->find(methodName);
         if(rpcMethodsIterator == _rpcMethods->end())
         {
             if(_info->familyServer)
             {
                 auto result = GD::familyServer->callRpcMethod(clientInfo, methodName, parameters->arrayValue);
-                if(!result->errorStruct || result->structValue->at("faultCode")->integerValue != 32601) return result;
+                if(!result->errorStruct || result->structValue->at("faultCode")->integerValue != 32601)
+                {
+                    if(startTime != 0) recordCall(clientInfo, methodName, startTime, result);
+                    return result;
+                }
             }
             BaseLib::PVariable result = GD::ipcServer->callRpcMethod(clientInfo, methodName, parameters->arrayValue);
+            if(startTime != 0) recordCall(clientInfo, methodName, startTime, result);
             return result;
         }
 
@@ -997,6 +1055,7 @@ BaseLib::PVariable RpcServer::callMethod(BaseLib::PRpcClientInfo clientInfo, std
             }
         }
         BaseLib::PVariable ret = rpcMethodsIterator->second->invoke(clientInfo, parameters->arrayValue);
+        if(startTime != 0) recordCall(clientInfo, methodName, startTime, ret);
         if(GD::bl->debugLevel >= 5)
         {
             _out.printDebug("Response: ");
@@ -1026,18 +1085,40 @@ void RpcServer::callMethod(std::shared_ptr<Client> client, std::string methodNam
     {
         if(_stopped || GD::bl->shuttingDown) return;
 
+        if(streamResponse(client, methodName, parameters, messageId, responseType, keepAlive)) return;
+
+        BaseLib::PVariable ret = executeCall(client, methodName, parameters);
+        if(ret) sendRPCResponseToClient(client, ret, messageId, responseType, keepAlive);
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+BaseLib::PVariable RpcServer::executeCall(std::shared_ptr<Client>& client, std::string& methodName, std::shared_ptr<std::vector<BaseLib::PVariable>>& parameters)
+{
+    try
+    {
+        BaseLib::PVariable rateLimitError = checkRateLimit(client, methodName, parameters);
+        if(rateLimitError) return rateLimitError;
+
         if(methodName == "setClientType" && parameters->size() > 0)
         {
             if(parameters->at(0)->integerValue == 1)
             {
                 _out.printInfo("Info: Type of client " + std::to_string(client->id) + " set to addon.");
                 client->addon = true;
-                BaseLib::PVariable ret(new BaseLib::Variable());
-                sendRPCResponseToClient(client, ret, messageId, responseType, keepAlive);
+                return std::make_shared<BaseLib::Variable>();
             }
-            return;
+            return BaseLib::PVariable();
         }
 
+        int64_t startTime = GD::rpcSettings.metrics() ? BaseLib::HelperFunctions::getTimeMicroseconds() : 0;
         auto rpcMethodsIterator = _rpcMethods->find(methodName);
         if(rpcMethodsIterator == _rpcMethods->end())
         {
@@ -1046,13 +1127,13 @@ void RpcServer::callMethod(std::shared_ptr<Client> client, std::string methodNam
                 auto result = GD::familyServer->callRpcMethod(client, methodName, parameters);
                 if(!result->errorStruct || result->structValue->at("faultCode")->integerValue != 32601)
                 {
-                    sendRPCResponseToClient(client, result, messageId, responseType, keepAlive);
-                    return;
+                    if(startTime != 0) recordCall(client, methodName, startTime, result);
+                    return result;
                 }
             }
             BaseLib::PVariable result = GD::ipcServer->callRpcMethod(client, methodName, parameters);
-            sendRPCResponseToClient(client, result, messageId, responseType, keepAlive);
-            return;
+            if(startTime != 0) recordCall(client, methodName, startTime, result);
+            return result;
         }
 
         {
@@ -1070,17 +1151,18 @@ void RpcServer::callMethod(std::shared_ptr<Client> client, std::string methodNam
             }
         }
         BaseLib::PVariable ret = rpcMethodsIterator->second->invoke(client, parameters);
+        if(startTime != 0) recordCall(client, methodName, startTime, ret);
         if(GD::bl->debugLevel >= 5)
         {
             _out.printDebug("Response: ");
             ret->print(true, false);
         }
-        sendRPCResponseToClient(client, ret, messageId, responseType, keepAlive);
 
         {
             std::lock_guard<std::mutex> lifetick2Guard(_lifetick2Mutex);
             _lifetick2.second = true;
         }
+        return ret;
     }
     catch(const std::exception& ex)
     {
@@ -1090,6 +1172,293 @@ void RpcServer::callMethod(std::shared_ptr<Client> client, std::string methodNam
     {
         _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
+    return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+void RpcServer::callJsonBatch(std::shared_ptr<Client> client, BaseLib::PVariable& requests, PacketType::Enum responseType, bool keepAlive)
+{
+    try
+    {
+        //An empty batch is answered with a single error object instead of an array.
+        bool emptyBatch = requests->arrayValue->empty();
+        std::vector<BaseLib::PVariable> invalidEntry{std::make_shared<BaseLib::Variable>()};
+        std::vector<BaseLib::PVariable>& entries = emptyBatch ? invalidEntry : *requests->arrayValue;
+        auto responses = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+        responses->arrayValue->reserve(entries.size());
+        for(auto& request : entries)
+        {
+            if(_stopped || GD::bl->shuttingDown) return;
+
+            //Invalid requests are answered with their ID or null when they have none.
+            BaseLib::PVariable id = std::make_shared<BaseLib::Variable>();
+            BaseLib::PVariable result;
+            if(emptyBatch) result = BaseLib::Variable::createError(-32600, "Invalid request. The batch is empty.");
+            else if(request->type != BaseLib::VariableType::tStruct) result = BaseLib::Variable::createError(-32600, "Invalid request. The batch entry is no object.");
+            else
+            {
+                auto idIterator = request->structValue->find("id");
+                if(idIterator != request->structValue->end()) id = idIterator->second;
+                auto methodIterator = request->structValue->find("method");
+                if(methodIterator == request->structValue->end() || methodIterator->second->type != BaseLib::VariableType::tString) result = BaseLib::Variable::createError(-32600, "Invalid request. \"method\" not found.");
+                else
+                {
+                    //Valid requests without ID are notifications.
+                    if(idIterator == request->structValue->end()) id.reset();
+                    std::string methodName = methodIterator->second->stringValue;
+                    auto paramsIterator = request->structValue->find("params");
+                    std::shared_ptr<std::vector<BaseLib::PVariable>> parameters = paramsIterator == request->structValue->end() ? std::make_shared<std::vector<BaseLib::PVariable>>() : paramsIterator->second->arrayValue;
+                    result = executeCall(client, methodName, parameters);
+                    if(!result) result = std::make_shared<BaseLib::Variable>();
+                }
+            }
+            if(!id) continue;
+
+            auto response = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+            response->structValue->emplace("jsonrpc", std::make_shared<BaseLib::Variable>(std::string("2.0")));
+            if(result->errorStruct)
+            {
+                auto error = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+                error->structValue->emplace("code", result->structValue->at("faultCode"));
+                error->structValue->emplace("message", result->structValue->at("faultString"));
+                response->structValue->emplace("error", error);
+            }
+            else response->structValue->emplace("result", result);
+            response->structValue->emplace("id", id);
+            responses->arrayValue->push_back(response);
+        }
+
+        //A batch of notifications is not answered. HTTP clients still need a response.
+        bool messagePack = responseType == PacketType::Enum::messagePackResponse || (responseType == PacketType::Enum::webSocketResponse && client->messagePack);
+        std::vector<char> data;
+        if(!responses->arrayValue->empty())
+        {
+            if(emptyBatch) responses = responses->arrayValue->front();
+            if(messagePack) _messagePackEncoder->encode(responses, data);
+            else
+            {
+                std::string json;
+                _jsonEncoder->encode(responses, json);
+                data.insert(data.end(), json.begin(), json.end());
+            }
+        }
+        if(responseType == PacketType::Enum::webSocketResponse)
+        {
+            if(data.empty()) return;
+            std::vector<char> frame;
+            auto opcode = messagePack ? BaseLib::WebSocket::Header::Opcode::binary : BaseLib::WebSocket::Header::Opcode::text;
+            if(client->webSocketDeflate) client->webSocketDeflate->encode(data, opcode, frame);
+            else BaseLib::WebSocket::encode(data, opcode, frame);
+            sendRPCResponseToClient(client, frame, keepAlive);
+        }
+        else
+        {
+            if(!data.empty() && !messagePack)
+            {
+                data.push_back('\r');
+                data.push_back('\n');
+            }
+            std::string header = getHttpResponseHeader(messagePack ? "application/msgpack" : "application/json", data.size(), !keepAlive);
+            data.insert(data.begin(), header.begin(), header.end());
+            sendRPCResponseToClient(client, data, keepAlive);
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+BaseLib::PVariable RpcServer::checkRateLimit(std::shared_ptr<Client>& client, std::string& methodName, std::shared_ptr<std::vector<BaseLib::PVariable>>& parameters)
+{
+    try
+    {
+        client->requestCount++;
+        int64_t retryAfter = GD::rpcRateLimiter.acquire(client->rateLimitBucket, client->user, methodName, parameters);
+        if(retryAfter > 0)
+        {
+            //Like in recordCall(), unknown method names sent by clients don't get their own series.
+            if(GD::rpcSettings.metrics()) GD::rpcMetrics.recordThrottled(methodExists(client, methodName) ? methodName : "unknown", client->address);
+            if(GD::bl->debugLevel >= 5) _out.printDebug("Debug: Rate limit of client number " + std::to_string(client->id) + " exceeded. Rejecting call to " + methodName + ".");
+            return BaseLib::Variable::createError(-32010, "Rate limit exceeded. Retry in " + std::to_string(retryAfter) + " ms.");
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return BaseLib::PVariable();
+}
+
+bool RpcServer::streamResponse(std::shared_ptr<Client>& client, std::string& methodName, std::shared_ptr<std::vector<BaseLib::PVariable>>& parameters, int32_t messageId, PacketType::Enum responseType, bool keepAlive)
+{
+    try
+    {
+        uint32_t pageSize = GD::rpcSettings.streamingPageSize();
+        if(pageSize == 0 || (methodName != "getAllValues" && methodName != "getAllConfig")) return false;
+        //Data frames of other messages must not be sent between the fragments, so connections also receiving events are excluded.
+        if(responseType != PacketType::Enum::jsonResponse && (responseType != PacketType::Enum::webSocketResponse || client->messagePack || client->sendEventsToRpcServer)) return false;
+        //Chunked transfer encoding was introduced with HTTP/1.1.
+        if(responseType == PacketType::Enum::jsonResponse && client->http10) return false;
+        //Only calls for all devices are streamed.
+        if(!parameters->empty() && (methodName != "getAllValues" || parameters->size() != 1 || parameters->at(0)->type != BaseLib::VariableType::tBoolean)) return false;
+        auto rpcMethodsIterator = _rpcMethods->find(methodName);
+        if(rpcMethodsIterator == _rpcMethods->end()) return false;
+        //Sending the cached response is cheaper than collecting it again.
+        if(methodName == "getAllConfig" && GD::rpcResponseCache.contains(methodName, client, parameters)) return false;
+
+        auto pagingOptions = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        pagingOptions->structValue->emplace("limit", std::make_shared<BaseLib::Variable>((int32_t)pageSize));
+        auto pageParameters = std::make_shared<std::vector<BaseLib::PVariable>>(*parameters);
+        pageParameters->push_back(pagingOptions);
+
+        //The pages belong to one call, so it is rate limited and recorded in the metrics only once.
+        BaseLib::PVariable rateLimitError = checkRateLimit(client, methodName, parameters);
+        if(rateLimitError)
+        {
+            sendRPCResponseToClient(client, rateLimitError, messageId, responseType, keepAlive);
+            return true;
+        }
+        int64_t startTime = GD::rpcSettings.metrics() ? BaseLib::HelperFunctions::getTimeMicroseconds() : 0;
+        if(GD::bl->debugLevel >= 4) _out.printInfo("Info: Client number " + std::to_string(client->id) + " is calling RPC method: " + methodName + " (streamed)");
+
+        BaseLib::PVariable page = rpcMethodsIterator->second->invoke(client, pageParameters);
+        if(!page || page->errorStruct)
+        {
+            if(startTime != 0) recordCall(client, methodName, startTime, page);
+            if(page) sendRPCResponseToClient(client, page, messageId, responseType, keepAlive);
+            return true;
+        }
+
+        std::string httpHeader;
+        if(responseType == PacketType::Enum::jsonResponse)
+        {
+            httpHeader.append("HTTP/1.1 200 OK\r\n");
+            httpHeader.append("Connection: ");
+            httpHeader.append(keepAlive ? "Keep-Alive\r\n" : "close\r\n");
+            httpHeader.append("Content-Type: application/json\r\n");
+            httpHeader.append("Transfer-Encoding: chunked\r\n\r\n");
+        }
+        ChunkedResponseWriter writer(responseType == PacketType::Enum::webSocketResponse ? ChunkedResponseWriter::Mode::webSocket : ChunkedResponseWriter::Mode::http, httpHeader, [&](std::vector<char>& data)
+        {
+            try
+            {
+                client->socket->proofwrite(data);
+                return true;
+            }
+            catch(const BaseLib::SocketOperationException& ex)
+            {
+                _out.printError(std::string("Error: ") + ex.what());
+            }
+            return false;
+        });
+
+        bool success = writer.write("{\"jsonrpc\":\"2.0\",\"result\":[");
+        bool firstItem = true;
+        std::string json;
+        while(success)
+        {
+            for(auto& item : *page->structValue->at("items")->arrayValue)
+            {
+                _jsonEncoder->encode(item, json);
+                if((!firstItem && !writer.write(",")) || !writer.write(json))
+                {
+                    success = false;
+                    break;
+                }
+                firstItem = false;
+            }
+
+            auto cursorIterator = page->structValue->find("cursor");
+            if(!success || cursorIterator == page->structValue->end()) break;
+            if(_stopped || GD::bl->shuttingDown)
+            {
+                success = false;
+                break;
+            }
+            (*pagingOptions->structValue)["cursor"] = cursorIterator->second;
+            page = rpcMethodsIterator->second->invoke(client, pageParameters);
+            if(!page || page->errorStruct)
+            {
+                _out.printError("Error: Could not get next page of \"" + methodName + "\" for client number " + std::to_string(client->id) + (page ? ": " + page->structValue->at("faultString")->stringValue : "."));
+                success = false;
+            }
+        }
+        if(success) success = writer.write("],\"id\":" + std::to_string(messageId) + "}") && writer.finish();
+        if(startTime != 0) recordCall(client, methodName, startTime, success ? std::make_shared<BaseLib::Variable>() : BaseLib::Variable::createError(-32500, "Streaming failed."));
+        if(GD::bl->debugLevel >= 5) _out.printDebug("Debug: Streamed " + std::to_string(writer.bytesWritten()) + " bytes of \"" + methodName + "\" to client number " + std::to_string(client->id) + ".");
+
+        //A response that was cut off can't be completed, so the client needs to reconnect.
+        if(!success || !keepAlive) closeClientConnection(client);
+        return true;
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    closeClientConnection(client);
+    return true;
+}
+
+void RpcServer::recordCall(const BaseLib::PRpcClientInfo& clientInfo, const std::string& methodName, int64_t startTime, const BaseLib::PVariable& result)
+{
+    try
+    {
+        int64_t duration = BaseLib::HelperFunctions::getTimeMicroseconds() - startTime;
+        bool error = !result || result->errorStruct;
+        if(error && result)
+        {
+            //Don't create a series for every unknown method name sent by clients.
+            auto faultCodeIterator = result->structValue->find("faultCode");
+            if(faultCodeIterator != result->structValue->end() && (faultCodeIterator->second->integerValue == -32601 || faultCodeIterator->second->integerValue == 32601))
+            {
+                GD::rpcMetrics.record("unknown", clientInfo->address, duration, true);
+                return;
+            }
+        }
+        GD::rpcMetrics.record(methodName, clientInfo->address, duration, error);
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+void RpcServer::sendMetrics(std::shared_ptr<Client>& client, BaseLib::Http& http)
+{
+    try
+    {
+        std::vector<char> data;
+        bool keepAlive = http.getHeader().connection & BaseLib::Http::Connection::Enum::keepAlive;
+        if(!client->acls->checkMethodAccess("getRpcMetrics"))
+        {
+            _webServer->getError(403, "Forbidden", "You don't have permission to access the metrics.", data);
+            sendRPCResponseToClient(client, data, false);
+            return;
+        }
+
+        std::string content = GD::rpcMetrics.getPrometheusMetrics();
+        std::string header = getHttpResponseHeader("text/plain; version=0.0.4", content.size(), !keepAlive);
+        data.reserve(header.size() + content.size());
+        data.insert(data.end(), header.begin(), header.end());
+        if(http.getHeader().method != "HEAD") data.insert(data.end(), content.begin(), content.end());
+        sendRPCResponseToClient(client, data, keepAlive);
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
 }
 
 std::string RpcServer::getHttpResponseHeader(std::string contentType, uint32_t contentLength, bool closeConnection)
@@ -1118,6 +1487,10 @@ void RpcServer::analyzeRPCResponse(std::shared_ptr<Client> client, const std::ve
         {
             client->rpcResponse = _xmlRpcDecoder->decodeResponse(packet);
         }
+        else if(packetType == PacketType::Enum::messagePackResponse || (packetType == PacketType::Enum::webSocketResponse && client->messagePack))
+        {
+            client->rpcResponse = _messagePackDecoder->decodeResponse(packet);
+        }
         else if(packetType == PacketType::Enum::jsonResponse || packetType == PacketType::Enum::webSocketResponse)
         {
             auto jsonStruct = _jsonDecoder->decode(packet);
@@ -1142,8 +1515,8 @@ void RpcServer::packetReceived(std::shared_ptr<Client> client, const std::vector
 {
     try
     {
-        if(packetType == PacketType::Enum::binaryRequest || packetType == PacketType::Enum::xmlRequest || packetType == PacketType::Enum::jsonRequest || packetType == PacketType::Enum::webSocketRequest) analyzeRPC(client, packet, packetType, keepAlive);
-        else if(packetType == PacketType::Enum::binaryResponse || packetType == PacketType::Enum::xmlResponse || packetType == PacketType::Enum::jsonResponse) analyzeRPCResponse(client, packet, packetType, keepAlive);
+        if(packetType == PacketType::Enum::binaryRequest || packetType == PacketType::Enum::xmlRequest || packetType == PacketType::Enum::jsonRequest || packetType == PacketType::Enum::webSocketRequest || packetType == PacketType::Enum::messagePackRequest) analyzeRPC(client, packet, packetType, keepAlive);
+        else if(packetType == PacketType::Enum::binaryResponse || packetType == PacketType::Enum::xmlResponse || packetType == PacketType::Enum::jsonResponse || packetType == PacketType::Enum::messagePackResponse) analyzeRPCResponse(client, packet, packetType, keepAlive);
     }
     catch(const std::exception& ex)
     {
@@ -1189,6 +1562,251 @@ void RpcServer::removeWebserverEventHandler(BaseLib::PEventHandler eventHandler)
     if(_webServer) _webServer->removeEventHandler(eventHandler);
 }
 
+void RpcServer::eventLoop()
+{
+    try
+    {
+        std::array<epoll_event, 100> events{};
+        while(!_stopServer)
+        {
+            try
+            {
+                int32_t eventCount = epoll_wait(_epollDescriptor, events.data(), events.size(), 100);
+                if(eventCount == -1)
+                {
+                    if(errno == EINTR) continue;
+                    _out.printError("Error: epoll_wait failed: " + std::string(strerror(errno)));
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                    continue;
+                }
+
+                for(int32_t i = 0; i < eventCount; i++)
+                {
+                    std::shared_ptr<Client> client;
+                    {
+                        std::lock_guard<std::mutex> stateGuard(_stateMutex);
+                        auto clientIterator = _clients.find((int32_t)events[i].data.u64);
+                        if(clientIterator != _clients.end()) client = clientIterator->second;
+                    }
+                    if(!client || client->closed) continue;
+
+                    std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(client);
+                    if(!enqueue(0, queueEntry))
+                    {
+                        _out.printError("Error: Too many packets are queued to be processed. Closing connection to client number " + std::to_string(client->socketDescriptor->id) + ".");
+                        closeClientConnection(client);
+                    }
+                }
+            }
+            catch(const std::exception& ex)
+            {
+                _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+            }
+            catch(...)
+            {
+                _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+            }
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void RpcServer::watchClient(std::shared_ptr<Client>& client)
+{
+    try
+    {
+        if(client->socketDescriptor->tlsSession && gnutls_record_check_pending(client->socketDescriptor->tlsSession) > 0)
+        {
+            std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(client);
+            if(enqueue(0, queueEntry)) return;
+            _out.printError("Error: Too many packets are queued to be processed. Closing connection to client number " + std::to_string(client->socketDescriptor->id) + ".");
+            closeClientConnection(client);
+            return;
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        event.data.u64 = (uint32_t)client->id;
+        int32_t result = 0;
+        {
+            //Prevents the descriptor from being closed and reused by another connection in between.
+            auto fileDescriptorGuard = GD::bl->fileDescriptorManager.getLock();
+            fileDescriptorGuard.lock();
+            if(client->socketDescriptor->descriptor == -1) return;
+            result = epoll_ctl(_epollDescriptor, EPOLL_CTL_MOD, client->socketDescriptor->descriptor, &event);
+            if(result == -1 && errno == ENOENT) result = epoll_ctl(_epollDescriptor, EPOLL_CTL_ADD, client->socketDescriptor->descriptor, &event);
+        }
+        if(result == -1)
+        {
+            _out.printError("Error: Could not add client number " + std::to_string(client->socketDescriptor->id) + " to epoll: " + std::string(strerror(errno)));
+            closeClientConnection(client);
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+int32_t RpcServer::readAvailable(std::shared_ptr<Client>& client, char* buffer, size_t size)
+{
+    while(true)
+    {
+        ssize_t bytesRead = 0;
+        if(client->socketDescriptor->descriptor == -1) throw BaseLib::SocketClosedException("Connection to client number " + std::to_string(client->socketDescriptor->id) + " closed.");
+        if(client->socketDescriptor->tlsSession)
+        {
+            bytesRead = gnutls_record_recv(client->socketDescriptor->tlsSession, buffer, size);
+            //Also returned when only part of a TLS record was received.
+            if(bytesRead == GNUTLS_E_AGAIN) return 0;
+            if(bytesRead == GNUTLS_E_INTERRUPTED) continue;
+            if(bytesRead < 0) throw BaseLib::SocketOperationException("Error reading from TLS socket of client number " + std::to_string(client->socketDescriptor->id) + ": " + std::string(gnutls_strerror((int32_t)bytesRead)));
+        }
+        else
+        {
+            bytesRead = read(client->socketDescriptor->descriptor, buffer, size);
+            if(bytesRead == -1)
+            {
+                if(errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+                if(errno == EINTR) continue;
+                throw BaseLib::SocketOperationException("Error reading from socket of client number " + std::to_string(client->socketDescriptor->id) + ": " + std::string(strerror(errno)));
+            }
+        }
+        if(bytesRead == 0) throw BaseLib::SocketClosedException("Connection to client number " + std::to_string(client->socketDescriptor->id) + " closed.");
+        return (int32_t)bytesRead;
+    }
+}
+
+void RpcServer::setBlocking(std::shared_ptr<Client>& client, bool blocking)
+{
+    int32_t flags = fcntl(client->socketDescriptor->descriptor, F_GETFL);
+    if(flags == -1) throw BaseLib::Exception("Error: Could not get socket options: " + std::string(strerror(errno)));
+    flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+    if(fcntl(client->socketDescriptor->descriptor, F_SETFL, flags) == -1) throw BaseLib::Exception("Error: Could not set socket options: " + std::string(strerror(errno)));
+}
+
+void RpcServer::queuePacket(std::shared_ptr<Client>& client, const std::vector<char>& packet, PacketType::Enum packetType, bool keepAlive)
+{
+    if(packetType == PacketType::Enum::binaryResponse || packetType == PacketType::Enum::xmlResponse || packetType == PacketType::Enum::jsonResponse || packetType == PacketType::Enum::messagePackResponse)
+    {
+        packetReceived(client, packet, packetType, keepAlive);
+        return;
+    }
+    client->pendingRequests.emplace_back();
+    Client::PendingRequest& request = client->pendingRequests.back();
+    request.packet = packet;
+    request.packetType = packetType;
+    request.keepAlive = keepAlive;
+    request.http10 = client->http10;
+}
+
+void RpcServer::executeRequests(std::shared_ptr<Client>& client)
+{
+    try
+    {
+        uint64_t maxRequestCount = client->requestCount + (uint64_t)GD::rpcSettings.schedulingQuantum() * GD::rpcSettings.userWeight(client->user);
+        while(!client->pendingRequests.empty() && !_stopServer)
+        {
+            if(client->closed || !clientValid(client))
+            {
+                client->pendingRequests.clear();
+                break;
+            }
+            if(client->requestCount >= maxRequestCount)
+            {
+                //Let the other clients execute their requests first.
+                std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(client);
+                if(enqueue(1, queueEntry)) return;
+                _out.printError("Error: Too many requests are queued to be executed. Closing connection to client number " + std::to_string(client->socketDescriptor->id) + ".");
+                client->pendingRequests.clear();
+                closeClientConnection(client);
+                return;
+            }
+
+            Client::PendingRequest request = std::move(client->pendingRequests.front());
+            client->pendingRequests.pop_front();
+            if(request.handler == Client::PendingRequest::Handler::rpc)
+            {
+                client->http10 = request.http10;
+                packetReceived(client, request.packet, request.packetType, request.keepAlive);
+            }
+            else executeHttpRequest(client, request);
+        }
+
+        if(!_stopServer && !client->closed && clientValid(client))
+        {
+            watchClient(client);
+            return;
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    client->pendingRequests.clear();
+    closeClientConnection(client);
+}
+
+void RpcServer::executeHttpRequest(std::shared_ptr<Client>& client, Client::PendingRequest& request)
+{
+    try
+    {
+        BaseLib::Http& http = *request.http;
+        if(request.handler == Client::PendingRequest::Handler::metrics) sendMetrics(client, http);
+        else if(request.handler == Client::PendingRequest::Handler::restServer) _restServer->process(client, http, client->socket);
+        else if(request.handler == Client::PendingRequest::Handler::webServer)
+        {
+            if(http.getHeader().method == "POST" || http.getHeader().method == "PUT") _webServer->post(client, http, client->socket);
+            else if(http.getHeader().method == "GET" || http.getHeader().method == "HEAD") _webServer->get(client, http, client->socket, _info->cacheAssets);
+            else if(http.getHeader().method == "DELETE") _webServer->delete_(client, http, client->socket);
+            if(http.getHeader().connection & BaseLib::Http::Connection::Enum::close) closeClientConnection(client);
+            client->lastReceivedPacket = BaseLib::HelperFunctions::getTime();
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void RpcServer::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueueEntry>& entry)
+{
+    try
+    {
+        std::shared_ptr<QueueEntry> queueEntry = std::dynamic_pointer_cast<QueueEntry>(entry);
+        if(!queueEntry || !queueEntry->client) return;
+        if(index == 0) readClient(queueEntry->client);
+        else executeRequests(queueEntry->client);
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
 void RpcServer::collectGarbage()
 {
     try
@@ -1212,13 +1830,11 @@ void RpcServer::collectGarbage()
 
         for(auto& client : clientsToRemove)
         {
-            _out.printDebug("Debug: Joining read thread of client " + std::to_string(client->id));
-            GD::bl->threadManager.join(client->readThread);
-
             {
                 std::lock_guard<std::mutex> stateGuard(_stateMutex);
                 _clients.erase(client->id);
             }
+            GD::aclCache.remove(client->acls);
 
             _out.printDebug("Debug: Client " + std::to_string(client->id) + " removed.");
         }
@@ -1287,6 +1903,20 @@ void RpcServer::handleConnectionUpgrade(std::shared_ptr<Client> client, BaseLib:
             }
             BaseLib::HelperFunctions::toLower(client->webSocketClientId);
 
+            std::string extensions;
+            if(GD::rpcSettings.webSocketDeflate() && http.getHeader().fields.find("sec-websocket-extensions") != http.getHeader().fields.end())
+            {
+                //Connections of protocol "client" only receive events, which are sent one after another by the RPC client.
+                bool orderedWrites = protocol == "client" || pathProtocol == "client" || protocol == "nodeclient" || pathProtocol == "nodeclient";
+                client->webSocketDeflate = WebSocketDeflate::negotiate(http.getHeader().fields["sec-websocket-extensions"], orderedWrites, extensions);
+            }
+            for(auto& argument : BaseLib::HelperFunctions::splitAll(http.getHeader().args, '&'))
+            {
+                auto pair = BaseLib::HelperFunctions::splitFirst(argument, '=');
+                if(pair.first == "eventBatchWindow" && GD::rpcSettings.webSocketEventBatchMaxWindow() > 0) client->eventBatchWindow = std::min(std::max(BaseLib::Math::getNumber(pair.second, false), 0), GD::rpcSettings.webSocketEventBatchMaxWindow());
+                else if(pair.first == "encoding") client->messagePack = pair.second == "msgpack";
+            }
+
             if(protocol == "server" || pathProtocol == "server" || protocol == "server2" || pathProtocol == "server2" || protocol == "nodeserver" || pathProtocol == "nodeserver")
             {
                 client->rpcType = BaseLib::RpcType::websocket;
@@ -1302,6 +1932,7 @@ void RpcServer::handleConnectionUpgrade(std::shared_ptr<Client> client, BaseLib:
                 header.append("Upgrade: websocket\r\n");
                 header.append("Sec-WebSocket-Accept: ").append(websocketAccept).append("\r\n");
                 if(!protocol.empty()) header.append("Sec-WebSocket-Protocol: " + protocol + "\r\n");
+                if(!extensions.empty()) header.append("Sec-WebSocket-Extensions: " + extensions + "\r\n");
                 header.append("\r\n");
                 std::vector<char> data(header.begin(), header.end());
                 sendRPCResponseToClient(client, data, true);
@@ -1309,7 +1940,7 @@ void RpcServer::handleConnectionUpgrade(std::shared_ptr<Client> client, BaseLib:
                 {
                     client->sendEventsToRpcServer = true;
                     _out.printInfo("Info: Transferring client number " + std::to_string(client->id) + " to RPC client.");
-                    GD::rpcClient->addWebSocketServer(client->socket, client->webSocketClientId, client, client->address, client->nodeClient);
+                    GD::rpcClient->addWebSocketServer(client->socket, client->webSocketClientId, client, client->address, client->nodeClient, client->webSocketDeflate, client->eventBatchWindow, client->messagePack);
                 }
             }
             else if(protocol == "client" || pathProtocol == "client" || protocol == "nodeclient" || pathProtocol == "nodeclient")
@@ -1323,13 +1954,16 @@ void RpcServer::handleConnectionUpgrade(std::shared_ptr<Client> client, BaseLib:
                 header.append("Upgrade: websocket\r\n");
                 header.append("Sec-WebSocket-Accept: ").append(websocketAccept).append("\r\n");
                 if(!protocol.empty()) header.append("Sec-WebSocket-Protocol: " + protocol + "\r\n");
+                if(!extensions.empty()) header.append("Sec-WebSocket-Extensions: " + extensions + "\r\n");
                 header.append("\r\n");
                 std::vector<char> data(header.begin(), header.end());
                 sendRPCResponseToClient(client, data, true);
                 if(_info->websocketAuthType == BaseLib::Rpc::ServerInfo::Info::AuthType::none)
                 {
                     _out.printInfo("Info: Transferring client number " + std::to_string(client->id) + " to RPC client.");
-                    auto server = GD::rpcClient->addWebSocketServer(client->socket, client->webSocketClientId, client, client->address, client->nodeClient);
+                    //The RPC client reads the socket with blocking reads.
+                    setBlocking(client, true);
+                    auto server = GD::rpcClient->addWebSocketServer(client->socket, client->webSocketClientId, client, client->address, client->nodeClient, client->webSocketDeflate, client->eventBatchWindow, client->messagePack);
                     client->socketDescriptor.reset(new BaseLib::FileDescriptor());
                     client->socket.reset(new BaseLib::TcpSocket(GD::bl.get()));
                     client->closed = true;
@@ -1362,29 +1996,59 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
     try
     {
         if(!client) return;
-        std::array<char, 1025> buffer;
+        std::vector<char>& buffer = client->readBuffer;
+        if(buffer.size() < _minReadBufferSize + 1) buffer.resize(_minReadBufferSize + 1);
         //Make sure the buffer is null terminated.
         buffer.at(buffer.size() - 1) = '\0';
         int32_t processedBytes = 0;
         int32_t bytesRead = 0;
-        PacketType::Enum packetType = PacketType::binaryRequest;
-        BaseLib::Rpc::BinaryRpc binaryRpc(GD::bl.get());
-        BaseLib::Http http;
-        BaseLib::WebSocket webSocket;
+        size_t packetSizeHint = 0;
+        PacketType::Enum& packetType = client->packetType;
+        BaseLib::Rpc::BinaryRpc& binaryRpc = *client->binaryRpc;
+        BaseLib::Http& http = client->http;
+        BaseLib::WebSocket& webSocket = client->webSocket;
+
+        //Called when the socket is readable. Read until the socket would block, then hand the socket back to the event
+        //loop. As soon as complete requests were read, reading stops and the requests are executed on queue 1. After
+        //they are done, the socket is handed back to the event loop.
+        bool waitForData = false;
+        bool executeRequests = false;
+        for(uint32_t readCount = 0; !_stopServer; readCount++)
+        {
+            if(!client->pendingRequests.empty())
+            {
+                executeRequests = true;
+                break;
+            }
+            if(readCount == 16)
+            {
+                //Let the other clients read first, when a large packet is received.
+                waitForData = true;
+                break;
+            }
 
-        _out.printDebug("Listening for incoming packets from client number " + std::to_string(client->socketDescriptor->id) + ".");
-        while(!_stopServer)
-        {
-            try
+            //Grow the buffer when the last read filled it or the packet is known to be larger, so large packets are
+            //received with few reads. The packet parsers keep their state, so the buffer can change between reads.
+            size_t readSize = buffer.size() - 1;
+            if(readSize < GD::rpcSettings.readBufferMaxSize() && ((size_t)bytesRead == readSize || packetSizeHint > readSize))
             {
-                bytesRead = client->socket->proofread(buffer.data(), buffer.size() - 1);
-                //Some clients send only one byte in the first packet
-                if(bytesRead == 1 && !binaryRpc.processingStarted() && !http.headerProcessingStarted() && !webSocket.dataProcessingStarted()) bytesRead += client->socket->proofread(buffer.data() + 1, buffer.size() - 2);
-                buffer.at(buffer.size() - 1) = '\0'; //Even though it shouldn't matter, make sure there is a null termination.
+                readSize = std::min(std::max(readSize * 2, packetSizeHint), (size_t)GD::rpcSettings.readBufferMaxSize());
+                buffer.resize(readSize + 1);
+                buffer.at(buffer.size() - 1) = '\0';
             }
-            catch(const BaseLib::SocketTimeOutException& ex)
+            packetSizeHint = 0;
+
+            try
             {
-                continue;
+                bytesRead = readAvailable(client, buffer.data() + client->readBufferOffset, buffer.size() - 1 - client->readBufferOffset);
+                if(bytesRead == 0)
+                {
+                    waitForData = true;
+                    break;
+                }
+                bytesRead += client->readBufferOffset;
+                client->readBufferOffset = 0;
+                buffer.at(buffer.size() - 1) = '\0'; //Even though it shouldn't matter, make sure there is a null termination.
             }
             catch(const BaseLib::SocketClosedException& ex)
             {
@@ -1399,6 +2063,13 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
 
             if(!clientValid(client)) break;
 
+            //Some clients send only a few bytes in the first packet. Wait for enough data to tell the protocol.
+            if(bytesRead < 8 && client->rpcType != BaseLib::RpcType::websocket && !binaryRpc.processingStarted() && !http.headerProcessingStarted())
+            {
+                client->readBufferOffset = bytesRead;
+                continue;
+            }
+
             if(GD::bl->debugLevel >= 5)
             {
                 std::vector<uint8_t> rawPacket(buffer.begin(), buffer.begin() + bytesRead);
@@ -1409,6 +2080,12 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
             {
                 if(!_info->xmlrpcServer) continue;
 
+                //The header contains the size of the payload. Use it to size the buffer for the remaining data.
+                if(!binaryRpc.processingStarted() && bytesRead >= 8)
+                {
+                    packetSizeHint = 8 + (((size_t)(uint8_t)buffer.at(4) << 24) | ((size_t)(uint8_t)buffer.at(5) << 16) | ((size_t)(uint8_t)buffer.at(6) << 8) | (size_t)(uint8_t)buffer.at(7));
+                }
+
                 try
                 {
                     processedBytes = 0;
@@ -1456,7 +2133,7 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
 
                             packetType = (binaryRpc.getType() == BaseLib::Rpc::BinaryRpc::Type::request) ? PacketType::Enum::binaryRequest : PacketType::Enum::binaryResponse;
 
-                            packetReceived(client, binaryRpc.getData(), packetType, true);
+                            queuePacket(client, binaryRpc.getData(), packetType, true);
                             binaryRpc.reset();
                         }
                     }
@@ -1480,6 +2157,12 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
                     processedBytes += webSocket.process(buffer.data() + processedBytes, bytesRead - processedBytes);
                     if(webSocket.isFinished())
                     {
+                        if(webSocket.getHeader().rsv1 && (!client->webSocketDeflate || !client->webSocketDeflate->decode(webSocket.getContent())))
+                        {
+                            _out.printError("Error: Could not decompress WebSocket message from host " + client->address + ". Closing connection.");
+                            doBreak = true;
+                            break;
+                        }
                         if(webSocket.getHeader().close)
                         {
                             std::vector<char> response;
@@ -1517,7 +2200,9 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
                                     if(client->webSocketClient || client->sendEventsToRpcServer)
                                     {
                                         _out.printInfo("Info: Transferring client number " + std::to_string(client->id) + " to rpc client.");
-                                        GD::rpcClient->addWebSocketServer(client->socket, client->webSocketClientId, client, client->address, client->nodeClient);
+                                        //The RPC client reads the socket with blocking reads.
+                                        if(client->webSocketClient) setBlocking(client, true);
+                                        GD::rpcClient->addWebSocketServer(client->socket, client->webSocketClientId, client, client->address, client->nodeClient, client->webSocketDeflate, client->eventBatchWindow, client->messagePack);
                                         if(client->webSocketClient)
                                         {
                                             client->socketDescriptor.reset(new BaseLib::FileDescriptor());
@@ -1542,7 +2227,7 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
                         }
                         else
                         {
-                            packetReceived(client, webSocket.getContent(), packetType, true);
+                            queuePacket(client, webSocket.getContent(), packetType, true);
                         }
                         webSocket.reset();
                     }
@@ -1658,9 +2343,14 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
                                     http.reset();
                                     break;
                                 }
-                                if(_info->restServer && http.getHeader().path.compare(0, 5, "/api/") == 0)
+                                Client::PendingRequest::Handler handler = Client::PendingRequest::Handler::rpc;
+                                if(!GD::rpcSettings.metricsPath().empty() && http.getHeader().path == GD::rpcSettings.metricsPath() && (http.getHeader().method == "GET" || http.getHeader().method == "HEAD"))
                                 {
-                                    _restServer->process(client, http, client->socket);
+                                    handler = Client::PendingRequest::Handler::metrics;
+                                }
+                                else if(_info->restServer && http.getHeader().path.compare(0, 5, "/api/") == 0)
+                                {
+                                    handler = Client::PendingRequest::Handler::restServer;
                                 }
                                 else if(_info->webServer && (
                                     !_info->xmlrpcServer ||
@@ -1671,7 +2361,7 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
                                 ) && (
                                     !_info->jsonrpcServer ||
                                     http.getHeader().method != "POST" ||
-                                    (!http.getHeader().contentType.empty() && http.getHeader().contentType != "application/json") ||
+                                    (!http.getHeader().contentType.empty() && http.getHeader().contentType != "application/json" && http.getHeader().contentType != "application/msgpack" && http.getHeader().contentType != "application/x-msgpack") ||
                                     http.getHeader().path.compare(0, 11, "/node-blue/") == 0 ||
                                     http.getHeader().path.compare(0, 4, "/ui/") == 0 ||
                                     http.getHeader().path.compare(0, 7, "/admin/") == 0
@@ -1680,16 +2370,20 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
                                     client->rpcType = BaseLib::RpcType::webserver;
                                     http.getHeader().remoteAddress = client->address;
                                     http.getHeader().remotePort = client->port;
-                                    if(http.getHeader().method == "POST" || http.getHeader().method == "PUT") _webServer->post(client, http, client->socket);
-                                    else if(http.getHeader().method == "GET" || http.getHeader().method == "HEAD") _webServer->get(client, http, client->socket, _info->cacheAssets);
-                                    else if(http.getHeader().method == "DELETE") _webServer->delete_(client, http, client->socket);
-                                    if(http.getHeader().connection & BaseLib::Http::Connection::Enum::close) closeClientConnection(client);
-                                    client->lastReceivedPacket = BaseLib::HelperFunctions::getTime();
+                                    handler = Client::PendingRequest::Handler::webServer;
                                 }
                                 else if(http.getContentSize() > 0 && (_info->xmlrpcServer || _info->jsonrpcServer))
                                 {
-                                    if(http.getHeader().contentType == "application/json" || http.getContent().at(0) == '{') packetType = packetType == PacketType::xmlRequest ? PacketType::jsonRequest : PacketType::jsonResponse;
-                                    packetReceived(client, http.getContent(), packetType, http.getHeader().connection & BaseLib::Http::Connection::Enum::keepAlive);
+                                    if(http.getHeader().contentType == "application/msgpack" || http.getHeader().contentType == "application/x-msgpack") packetType = packetType == PacketType::xmlRequest ? PacketType::messagePackRequest : PacketType::messagePackResponse;
+                                    else if(http.getHeader().contentType == "application/json" || http.getContent().at(0) == '{' || http.getContent().at(0) == '[') packetType = packetType == PacketType::xmlRequest ? PacketType::jsonRequest : PacketType::jsonResponse;
+                                    client->http10 = http.getHeader().protocol == BaseLib::Http::Protocol::http10;
+                                    queuePacket(client, http.getContent(), packetType, http.getHeader().connection & BaseLib::Http::Connection::Enum::keepAlive);
+                                }
+                                if(handler != Client::PendingRequest::Handler::rpc)
+                                {
+                                    client->pendingRequests.emplace_back();
+                                    client->pendingRequests.back().handler = handler;
+                                    client->pendingRequests.back().http = std::make_shared<BaseLib::Http>(http);
                                 }
                                 http.reset();
                                 if(client->socketDescriptor->descriptor == -1)
@@ -1711,6 +2405,24 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
                 }
             }
         }
+        if(executeRequests && !_stopServer && !client->closed && clientValid(client))
+        {
+            std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(client);
+            if(enqueue(1, queueEntry)) return;
+            _out.printError("Error: Too many requests are queued to be executed. Closing connection to client number " + std::to_string(client->socketDescriptor->id) + ".");
+        }
+        else if(waitForData && !_stopServer && !client->closed && clientValid(client))
+        {
+            //Don't keep a large buffer for idle connections.
+            if(buffer.size() > _minReadBufferSize + 1 && client->readBufferOffset == 0 && !binaryRpc.processingStarted() && !http.headerProcessingStarted() && !webSocket.dataProcessingStarted())
+            {
+                buffer.resize(_minReadBufferSize + 1);
+                buffer.shrink_to_fit();
+                buffer.at(buffer.size() - 1) = '\0';
+            }
+            watchClient(client);
+            return;
+        }
         if(client->rpcType == BaseLib::RpcType::websocket) //Send close packet
         {
             std::vector<char> payload;
@@ -1728,6 +2440,7 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
         _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
     //This point is only reached, when stopServer is true, the socket is closed or an error occured
+    client->pendingRequests.clear();
     closeClientConnection(client);
 }
 
@@ -34,7 +34,12 @@
 #include "../../config.h"
 #include "RPCMethods.h"
 #include "Auth.h"
+#include "ChunkedResponseWriter.h"
+#include "MessagePackDecoder.h"
+#include "MessagePackEncoder.h"
+#include "RateLimiter.h"
 #include "RestServer.h"
+#include "WebSocketDeflate.h"
 #include "../WebServer/WebServer.h"
 #include <homegear-base/BaseLib.h>
 
@@ -42,6 +47,7 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <deque>
 #include <mutex>
 #include <memory>
 
@@ -53,23 +59,9 @@ namespace Homegear
 namespace Rpc
 {
 
-class RpcServer
+class RpcServer : public BaseLib::IQueue
 {
 public:
-    class Client : public BaseLib::RpcClientInfo
-    {
-    public:
-        bool webSocketClient = false;
-        bool webSocketAuthorized = false;
-        bool nodeClient = false;
-        std::thread readThread;
-        std::shared_ptr<Auth> auth;
-
-        Client();
-
-        virtual ~Client();
-    };
-
     struct PacketType
     {
         enum Enum
@@ -81,10 +73,97 @@ public:
             jsonRequest,
             jsonResponse,
             webSocketRequest,
-            webSocketResponse
+            webSocketResponse,
+            messagePackRequest,
+            messagePackResponse
         };
     };
 
+    class Client : public BaseLib::RpcClientInfo
+    {
+    public:
+        bool webSocketClient = false;
+        bool webSocketAuthorized = false;
+        bool nodeClient = false;
+        std::shared_ptr<Auth> auth;
+
+        // {{{ Parser state
+        // A packet can span several reads, which are not necessarily processed by the same worker thread.
+        std::unique_ptr<BaseLib::Rpc::BinaryRpc> binaryRpc;
+        BaseLib::Http http;
+        BaseLib::WebSocket webSocket;
+        PacketType::Enum packetType = PacketType::binaryRequest;
+
+        /**
+         * Null terminated read buffer. It grows while receiving large packets up to "readBufferMaxSize" in rpc.conf.
+         */
+        std::vector<char> readBuffer;
+
+        /**
+         * Number of bytes at the start of "readBuffer", that were received but are too few to tell the protocol.
+         */
+        size_t readBufferOffset = 0;
+        // }}}
+
+        // {{{ Request execution
+        struct PendingRequest
+        {
+            enum class Handler
+            {
+                rpc,
+                metrics,
+                restServer,
+                webServer
+            };
+
+            Handler handler = Handler::rpc;
+            std::vector<char> packet;
+            PacketType::Enum packetType = PacketType::binaryRequest;
+            bool keepAlive = true;
+            bool http10 = false;
+
+            /**
+             * The request for all handlers but "rpc".
+             */
+            std::shared_ptr<BaseLib::Http> http;
+        };
+
+        /**
+         * Requests read from the socket, that are executed in order on queue 1. The socket is not read while requests
+         * are pending, so only one thread accesses the list at a time.
+         */
+        std::deque<PendingRequest> pendingRequests;
+        // }}}
+
+        // {{{ Rate limiting and scheduling
+        TokenBucket rateLimitBucket;
+        uint64_t requestCount = 0;
+        // }}}
+
+        /**
+         * Set when the last HTTP request was sent with HTTP/1.0, which doesn't support chunked transfer encoding.
+         */
+        bool http10 = false;
+
+        // {{{ WebSocket options negotiated during the connection upgrade
+        std::shared_ptr<WebSocketDeflate> webSocketDeflate;
+
+        /**
+         * Time in milliseconds events are collected for before they are sent in one frame. 0 when disabled.
+         */
+        int32_t eventBatchWindow = 0;
+
+        /**
+         * Set when the client requested MessagePack instead of JSON ("encoding=msgpack"). Frames are sent as binary frames then.
+         */
+        bool messagePack = false;
+        // }}}
+
+        Client();
+
+        virtual ~Client();
+    };
+
     RpcServer();
 
     virtual ~RpcServer();
@@ -129,6 +208,7 @@ private:
     std::atomic_bool _stopped;
     std::thread _mainThread;
     int32_t _backlog = 100;
+    static const size_t _minReadBufferSize = 1024;
     std::mutex _garbageCollectionMutex;
     int64_t _lastGargabeCollection = 0;
     std::shared_ptr<BaseLib::FileDescriptor> _serverFileDescriptor;
@@ -142,6 +222,8 @@ private:
     std::unique_ptr<BaseLib::Rpc::XmlrpcEncoder> _xmlRpcEncoder;
     std::unique_ptr<BaseLib::Rpc::JsonDecoder> _jsonDecoder;
     std::unique_ptr<BaseLib::Rpc::JsonEncoder> _jsonEncoder;
+    std::unique_ptr<MessagePackDecoder> _messagePackDecoder;
+    std::unique_ptr<MessagePackEncoder> _messagePackEncoder;
     std::unique_ptr<WebServer::WebServer> _webServer;
     std::unique_ptr<RestServer> _restServer;
     std::mutex _lifetick1Mutex;
@@ -149,6 +231,63 @@ private:
     std::mutex _lifetick2Mutex;
     std::pair<int64_t, bool> _lifetick2;
 
+    // {{{ Event loop
+    class QueueEntry : public BaseLib::IQueueEntry
+    {
+    public:
+        explicit QueueEntry(std::shared_ptr<Client> client) : client(std::move(client)) {}
+
+        std::shared_ptr<Client> client;
+    };
+
+    /**
+     * The epoll instance all client sockets are registered with. Sockets are registered with EPOLLONESHOT, so only one
+     * worker thread processes a client at a time.
+     */
+    int32_t _epollDescriptor = -1;
+    std::thread _eventLoopThread;
+
+    /**
+     * Waits for data on the client sockets and hands readable clients to the worker threads of queue 0. Queue 0 only
+     * reads from the sockets and parses the packets. Requests are executed by the worker threads of queue 1, so
+     * long-running requests never keep the sockets of other clients from being read.
+     */
+    void eventLoop();
+
+    /**
+     * Registers the client's socket with the event loop again after all available data was processed. When TLS already
+     * buffered data, the client is queued directly, as epoll won't signal it.
+     */
+    void watchClient(std::shared_ptr<Client>& client);
+
+    /**
+     * Reads from the client's non-blocking socket.
+     *
+     * @return The number of bytes read or 0 when no data is available.
+     * @throws BaseLib::SocketClosedException when the client closed the connection.
+     * @throws BaseLib::SocketOperationException on read errors.
+     */
+    int32_t readAvailable(std::shared_ptr<Client>& client, char* buffer, size_t size);
+
+    void setBlocking(std::shared_ptr<Client>& client, bool blocking);
+
+    /**
+     * Queues requests for execution on queue 1. Responses are processed right away, because requests on queue 1 might
+     * wait for them.
+     */
+    void queuePacket(std::shared_ptr<Client>& client, const std::vector<char>& packet, PacketType::Enum packetType, bool keepAlive);
+
+    /**
+     * Executes the pending requests of the client in order and hands the socket back to the event loop afterwards.
+     * After "schedulingQuantum" requests the client is queued again, so other clients get their turn.
+     */
+    void executeRequests(std::shared_ptr<Client>& client);
+
+    void executeHttpRequest(std::shared_ptr<Client>& client, Client::PendingRequest& request);
+
+    void processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueueEntry>& entry) override;
+    // }}}
+
     void collectGarbage();
 
     void getSocketDescriptor();
@@ -175,6 +314,46 @@ private:
 
     void callMethod(std::shared_ptr<Client> client, std::string methodName, std::shared_ptr<std::vector<BaseLib::PVariable>> parameters, int32_t messageId, PacketType::Enum responseType, bool keepAlive);
 
+    /**
+     * Executes a method called by a client, including rate limiting and metrics.
+     *
+     * @return The result of the call or nullptr when the call must not be answered.
+     */
+    BaseLib::PVariable executeCall(std::shared_ptr<Client>& client, std::string& methodName, std::shared_ptr<std::vector<BaseLib::PVariable>>& parameters);
+
+    /**
+     * Charges a call to the rate limits of the client.
+     *
+     * @return The error to return to the client or nullptr when the call may be executed.
+     */
+    BaseLib::PVariable checkRateLimit(std::shared_ptr<Client>& client, std::string& methodName, std::shared_ptr<std::vector<BaseLib::PVariable>>& parameters);
+
+    /**
+     * Executes the calls of a JSON-RPC 2.0 batch one after another and sends all responses in one array. Calls without
+     * "id" are notifications and are not answered.
+     */
+    void callJsonBatch(std::shared_ptr<Client> client, BaseLib::PVariable& requests, PacketType::Enum responseType, bool keepAlive);
+
+    /**
+     * Executes "getAllValues" or "getAllConfig" page by page and writes the JSON response while the pages are
+     * collected, using HTTP chunked transfer encoding or a fragmented WebSocket message.
+     *
+     * @return false when the call can't be streamed and needs to be executed as usual.
+     */
+    bool streamResponse(std::shared_ptr<Client>& client, std::string& methodName, std::shared_ptr<std::vector<BaseLib::PVariable>>& parameters, int32_t messageId, PacketType::Enum responseType, bool keepAlive);
+
+    /**
+     * Adds a finished method call to the RPC metrics.
+     *
+     * @param startTime The start time of the call in microseconds.
+     */
+    void recordCall(const BaseLib::PRpcClientInfo& clientInfo, const std::string& methodName, int64_t startTime, const BaseLib::PVariable& result);
+
+    /**
+     * Answers a request to the metrics path with the RPC metrics in the Prometheus text format.
+     */
+    void sendMetrics(std::shared_ptr<Client>& client, BaseLib::Http& http);
+
     std::string getHttpResponseHeader(std::string contentType, uint32_t contentLength, bool closeConnection);
 
     void closeClientConnection(std::shared_ptr<Client> client);
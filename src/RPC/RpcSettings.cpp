@@ -0,0 +1,232 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "../GD/GD.h"
+#include "RpcSettings.h"
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+RpcSettings::RpcSettings()
+{
+    reset();
+}
+
+void RpcSettings::reset()
+{
+    _multicallParallel = false;
+    _multicallMaxConcurrency = 8;
+    _responseCacheSize = 1000;
+    _metrics = true;
+    _metricsPath = "";
+    _clientRateLimit = 0;
+    _clientRateLimitBurst = 100;
+    _userRateLimit = 0;
+    _userRateLimitBurst = 200;
+    _methodCosts.clear();
+    _schedulingQuantum = 10;
+    _userWeights.clear();
+    _readBufferMaxSize = 1048576;
+    _streamingPageSize = 0;
+    _webSocketDeflate = true;
+    _webSocketEventBatchMaxWindow = 1000;
+}
+
+uint32_t RpcSettings::methodCost(const std::string& methodName)
+{
+    auto costIterator = _methodCosts.find(methodName);
+    return costIterator == _methodCosts.end() ? 1 : costIterator->second;
+}
+
+uint32_t RpcSettings::userWeight(const std::string& user)
+{
+    auto weightIterator = _userWeights.find(user);
+    return weightIterator == _userWeights.end() ? 1 : weightIterator->second;
+}
+
+std::unordered_map<std::string, uint32_t> RpcSettings::parseValueList(const std::string& value)
+{
+    std::unordered_map<std::string, uint32_t> values;
+    std::vector<std::string> elements = BaseLib::HelperFunctions::splitAll(value, ',');
+    for(auto& element : elements)
+    {
+        auto pair = BaseLib::HelperFunctions::splitLast(element, ':');
+        BaseLib::HelperFunctions::trim(pair.first);
+        BaseLib::HelperFunctions::trim(pair.second);
+        if(pair.first.empty() || pair.second.empty()) continue;
+        int32_t integerValue = BaseLib::Math::getNumber(pair.second, false);
+        values[pair.first] = integerValue < 0 ? 0 : integerValue;
+    }
+    return values;
+}
+
+void RpcSettings::load(std::string filename)
+{
+    try
+    {
+        reset();
+        char input[1024];
+        FILE* fin;
+        int32_t len, ptr;
+        bool found = false;
+
+        if(!(fin = fopen(filename.c_str(), "r")))
+        {
+            GD::bl->out.printInfo("Info: Unable to open config file: " + filename + ". Using default RPC settings.");
+            return;
+        }
+
+        while(fgets(input, 1024, fin))
+        {
+            if(input[0] == '#') continue;
+            len = strlen(input);
+            if(len < 2) continue;
+            if(input[len - 1] == '\n') input[len - 1] = '\0';
+            ptr = 0;
+            found = false;
+            while(ptr < len)
+            {
+                if(input[ptr] == '=')
+                {
+                    found = true;
+                    input[ptr++] = '\0';
+                    break;
+                }
+                ptr++;
+            }
+            if(found)
+            {
+                std::string name(input);
+                BaseLib::HelperFunctions::toLower(name);
+                BaseLib::HelperFunctions::trim(name);
+                std::string value(&input[ptr]);
+                BaseLib::HelperFunctions::trim(value);
+                if(name == "multicallparallel")
+                {
+                    _multicallParallel = (BaseLib::HelperFunctions::toLower(value) == "true");
+                    GD::bl->out.printDebug("Debug (RPC settings): multicallParallel set to " + std::to_string(_multicallParallel));
+                }
+                else if(name == "multicallmaxconcurrency")
+                {
+                    _multicallMaxConcurrency = BaseLib::Math::getNumber(value, false);
+                    if(_multicallMaxConcurrency < 1) _multicallMaxConcurrency = 1;
+                    else if(_multicallMaxConcurrency > 100) _multicallMaxConcurrency = 100;
+                    GD::bl->out.printDebug("Debug (RPC settings): multicallMaxConcurrency set to " + std::to_string(_multicallMaxConcurrency));
+                }
+                else if(name == "responsecachesize")
+                {
+                    int32_t integerValue = BaseLib::Math::getNumber(value, false);
+                    _responseCacheSize = integerValue < 0 ? 0 : integerValue;
+                    GD::bl->out.printDebug("Debug (RPC settings): responseCacheSize set to " + std::to_string(_responseCacheSize));
+                }
+                else if(name == "metrics")
+                {
+                    _metrics = (BaseLib::HelperFunctions::toLower(value) == "true");
+                    GD::bl->out.printDebug("Debug (RPC settings): metrics set to " + std::to_string(_metrics));
+                }
+                else if(name == "metricspath")
+                {
+                    _metricsPath = value;
+                    if(!_metricsPath.empty() && _metricsPath.front() != '/') _metricsPath.insert(_metricsPath.begin(), '/');
+                    GD::bl->out.printDebug("Debug (RPC settings): metricsPath set to " + _metricsPath);
+                }
+                else if(name == "clientratelimit" || name == "clientratelimitburst" || name == "userratelimit" || name == "userratelimitburst" || name == "schedulingquantum")
+                {
+                    int32_t integerValue = BaseLib::Math::getNumber(value, false);
+                    if(integerValue < 0) integerValue = 0;
+                    if(name == "clientratelimit") _clientRateLimit = integerValue;
+                    else if(name == "clientratelimitburst") _clientRateLimitBurst = integerValue;
+                    else if(name == "userratelimit") _userRateLimit = integerValue;
+                    else if(name == "userratelimitburst") _userRateLimitBurst = integerValue;
+                    else if(name == "schedulingquantum") _schedulingQuantum = integerValue < 1 ? 1 : integerValue;
+                    GD::bl->out.printDebug("Debug (RPC settings): " + name + " set to " + std::to_string(integerValue));
+                }
+                else if(name == "methodcosts")
+                {
+                    _methodCosts = parseValueList(value);
+                    GD::bl->out.printDebug("Debug (RPC settings): methodCosts set to " + value);
+                }
+                else if(name == "userweights")
+                {
+                    _userWeights = parseValueList(value);
+                    for(auto& weight : _userWeights)
+                    {
+                        if(weight.second == 0) weight.second = 1;
+                    }
+                    GD::bl->out.printDebug("Debug (RPC settings): userWeights set to " + value);
+                }
+                else if(name == "readbuffermaxsize")
+                {
+                    int32_t integerValue = BaseLib::Math::getNumber(value, false);
+                    if(integerValue < 1024) integerValue = 1024;
+                    else if(integerValue > 104857600) integerValue = 104857600;
+                    _readBufferMaxSize = integerValue;
+                    GD::bl->out.printDebug("Debug (RPC settings): readBufferMaxSize set to " + std::to_string(_readBufferMaxSize));
+                }
+                else if(name == "streamingpagesize")
+                {
+                    int32_t integerValue = BaseLib::Math::getNumber(value, false);
+                    if(integerValue < 0) integerValue = 0;
+                    else if(integerValue > 100000) integerValue = 100000;
+                    _streamingPageSize = integerValue;
+                    GD::bl->out.printDebug("Debug (RPC settings): streamingPageSize set to " + std::to_string(_streamingPageSize));
+                }
+                else if(name == "websocketdeflate")
+                {
+                    _webSocketDeflate = (BaseLib::HelperFunctions::toLower(value) == "true");
+                    GD::bl->out.printDebug("Debug (RPC settings): webSocketDeflate set to " + std::to_string(_webSocketDeflate));
+                }
+                else if(name == "websocketeventbatchmaxwindow")
+                {
+                    _webSocketEventBatchMaxWindow = BaseLib::Math::getNumber(value, false);
+                    if(_webSocketEventBatchMaxWindow < 0) _webSocketEventBatchMaxWindow = 0;
+                    GD::bl->out.printDebug("Debug (RPC settings): webSocketEventBatchMaxWindow set to " + std::to_string(_webSocketEventBatchMaxWindow));
+                }
+                else
+                {
+                    GD::bl->out.printWarning("Warning: Setting not found: " + std::string(input));
+                }
+            }
+        }
+
+        fclose(fin);
+    }
+    catch(const std::exception& ex)
+    {
+        GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+}
+
+}
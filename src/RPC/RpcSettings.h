@@ -0,0 +1,161 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef RPCSETTINGS_H_
+#define RPCSETTINGS_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <string>
+#include <unordered_map>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+/**
+ * Settings of the RPC servers, which are not specific to one server in "rpcservers.conf".
+ */
+class RpcSettings
+{
+public:
+    RpcSettings();
+
+    virtual ~RpcSettings() {}
+
+    void load(std::string filename);
+
+    // {{{ system.multicall
+    bool multicallParallel() { return _multicallParallel; }
+
+    int32_t multicallMaxConcurrency() { return _multicallMaxConcurrency; }
+    // }}}
+
+    /**
+     * The maximum number of cached metadata responses. 0 disables the cache.
+     */
+    uint32_t responseCacheSize() { return _responseCacheSize; }
+
+    // {{{ Metrics
+    bool metrics() { return _metrics; }
+
+    /**
+     * The HTTP path the metrics are served on in the Prometheus text format. Empty when disabled.
+     */
+    std::string metricsPath() { return _metricsPath; }
+    // }}}
+
+    // {{{ Rate limiting and scheduling
+    /**
+     * Requests per second per connection. 0 disables the limit.
+     */
+    uint32_t clientRateLimit() { return _clientRateLimit; }
+
+    uint32_t clientRateLimitBurst() { return _clientRateLimitBurst; }
+
+    /**
+     * Requests per second per user over all connections. 0 disables the limit.
+     */
+    uint32_t userRateLimit() { return _userRateLimit; }
+
+    uint32_t userRateLimitBurst() { return _userRateLimitBurst; }
+
+    /**
+     * Returns the number of tokens a call of the method takes from the rate limit buckets.
+     */
+    uint32_t methodCost(const std::string& methodName);
+
+    /**
+     * Number of requests a connection may process before the connections of other clients get their turn.
+     */
+    uint32_t schedulingQuantum() { return _schedulingQuantum; }
+
+    /**
+     * Returns the factor the scheduling quantum of the user's connections is multiplied with.
+     */
+    uint32_t userWeight(const std::string& user);
+    // }}}
+
+    /**
+     * The maximum size in bytes the read buffer of a connection grows to while receiving large packets.
+     */
+    uint32_t readBufferMaxSize() { return _readBufferMaxSize; }
+
+    /**
+     * Number of devices per page when the JSON response of "getAllValues" or "getAllConfig" is streamed. 0 disables
+     * streaming.
+     */
+    uint32_t streamingPageSize() { return _streamingPageSize; }
+
+    // {{{ WebSockets
+    /**
+     * Accept the extension "permessage-deflate" when offered by a WebSocket client.
+     */
+    bool webSocketDeflate() { return _webSocketDeflate; }
+
+    /**
+     * The maximum time in milliseconds a WebSocket client can request events to be collected for before they are sent
+     * in one frame. 0 disables event batching.
+     */
+    int32_t webSocketEventBatchMaxWindow() { return _webSocketEventBatchMaxWindow; }
+    // }}}
+private:
+    bool _multicallParallel = false;
+    int32_t _multicallMaxConcurrency = 8;
+    uint32_t _responseCacheSize = 1000;
+    bool _metrics = true;
+    std::string _metricsPath;
+    uint32_t _clientRateLimit = 0;
+    uint32_t _clientRateLimitBurst = 100;
+    uint32_t _userRateLimit = 0;
+    uint32_t _userRateLimitBurst = 200;
+    std::unordered_map<std::string, uint32_t> _methodCosts;
+    uint32_t _schedulingQuantum = 10;
+    std::unordered_map<std::string, uint32_t> _userWeights;
+    uint32_t _readBufferMaxSize = 1048576;
+    uint32_t _streamingPageSize = 0;
+    bool _webSocketDeflate = true;
+    int32_t _webSocketEventBatchMaxWindow = 1000;
+
+    void reset();
+
+    /**
+     * Parses a comma separated list of "NAME:VALUE" pairs.
+     */
+    static std::unordered_map<std::string, uint32_t> parseValueList(const std::string& value);
+};
+
+}
+
+}
+
+#endif
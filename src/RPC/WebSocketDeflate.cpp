@@ -0,0 +1,250 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "../GD/GD.h"
+#include "WebSocketDeflate.h"
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+std::atomic<uint64_t> WebSocketDeflate::_messages{0};
+std::atomic<uint64_t> WebSocketDeflate::_uncompressedBytes{0};
+std::atomic<uint64_t> WebSocketDeflate::_compressedBytes{0};
+
+WebSocketDeflate::WebSocketDeflate(int32_t serverMaxWindowBits, bool contextTakeover) : _contextTakeover(contextTakeover)
+{
+    _deflateStream = z_stream();
+    _deflateInitialized = deflateInit2(&_deflateStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -serverMaxWindowBits, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    _inflateStream = z_stream();
+    _inflateInitialized = inflateInit2(&_inflateStream, -15) == Z_OK;
+}
+
+WebSocketDeflate::~WebSocketDeflate()
+{
+    if(_deflateInitialized) deflateEnd(&_deflateStream);
+    if(_inflateInitialized) inflateEnd(&_inflateStream);
+}
+
+std::shared_ptr<WebSocketDeflate> WebSocketDeflate::negotiate(const std::string& offers, bool orderedWrites, std::string& response)
+{
+    try
+    {
+        for(auto& offer : BaseLib::HelperFunctions::splitAll(offers, ','))
+        {
+            auto parameters = BaseLib::HelperFunctions::splitAll(offer, ';');
+            if(parameters.empty() || BaseLib::HelperFunctions::toLower(BaseLib::HelperFunctions::trim(parameters.at(0))) != "permessage-deflate") continue;
+
+            bool accept = true;
+            bool contextTakeover = orderedWrites;
+            int32_t serverMaxWindowBits = 15;
+            for(size_t i = 1; i < parameters.size(); i++)
+            {
+                auto parameter = BaseLib::HelperFunctions::splitLast(parameters.at(i), '=');
+                std::string name = BaseLib::HelperFunctions::toLower(BaseLib::HelperFunctions::trim(parameter.first));
+                std::string value = BaseLib::HelperFunctions::trim(parameter.second);
+                if(!value.empty() && value.front() == '"' && value.back() == '"' && value.size() >= 2) value = value.substr(1, value.size() - 2);
+                if(name == "server_no_context_takeover") contextTakeover = false;
+                else if(name == "client_no_context_takeover") continue;
+                else if(name == "client_max_window_bits")
+                {
+                    //The inflate stream always uses the maximum window size, so every client window size is supported.
+                    if(!value.empty() && (BaseLib::Math::getNumber(value) < 8 || BaseLib::Math::getNumber(value) > 15)) accept = false;
+                }
+                else if(name == "server_max_window_bits")
+                {
+                    serverMaxWindowBits = BaseLib::Math::getNumber(value);
+                    //zlib doesn't support a window size of 8 bits for raw deflate streams.
+                    if(serverMaxWindowBits < 9 || serverMaxWindowBits > 15) accept = false;
+                }
+                else accept = false;
+            }
+            if(!accept) continue;
+
+            auto deflate = std::make_shared<WebSocketDeflate>(serverMaxWindowBits, contextTakeover);
+            if(!deflate->_deflateInitialized || !deflate->_inflateInitialized) return std::shared_ptr<WebSocketDeflate>();
+            response = "permessage-deflate";
+            if(!contextTakeover) response.append("; server_no_context_takeover");
+            if(serverMaxWindowBits < 15) response.append("; server_max_window_bits=" + std::to_string(serverMaxWindowBits));
+            return deflate;
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return std::shared_ptr<WebSocketDeflate>();
+}
+
+void WebSocketDeflate::appendFrameHeader(std::vector<char>& frame, uint8_t firstByte, size_t payloadSize)
+{
+    //Frames sent by the server are not masked.
+    frame.push_back((char)firstByte);
+    if(payloadSize < 126) frame.push_back((char)payloadSize);
+    else if(payloadSize <= 0xFFFF)
+    {
+        frame.push_back((char)126);
+        frame.push_back((char)(payloadSize >> 8));
+        frame.push_back((char)(payloadSize & 0xFF));
+    }
+    else
+    {
+        frame.push_back((char)127);
+        for(int32_t i = 56; i >= 0; i -= 8)
+        {
+            frame.push_back((char)(((uint64_t)payloadSize >> i) & 0xFF));
+        }
+    }
+}
+
+void WebSocketDeflate::encode(std::vector<char>& payload, BaseLib::WebSocket::Header::Opcode::Enum opcode, std::vector<char>& frame)
+{
+    try
+    {
+        frame.clear();
+        if(payload.size() < _minCompressionSize)
+        {
+            BaseLib::WebSocket::encode(payload, opcode, frame);
+            return;
+        }
+
+        std::vector<char> compressed;
+        {
+            std::lock_guard<std::mutex> deflateGuard(_deflateMutex);
+            compressed.resize(deflateBound(&_deflateStream, payload.size()) + 16);
+            size_t compressedSize = 0;
+            _deflateStream.next_in = (Bytef*)payload.data();
+            _deflateStream.avail_in = payload.size();
+            int result = Z_OK;
+            while(true)
+            {
+                _deflateStream.next_out = (Bytef*)compressed.data() + compressedSize;
+                _deflateStream.avail_out = compressed.size() - compressedSize;
+                result = deflate(&_deflateStream, Z_SYNC_FLUSH);
+                compressedSize = compressed.size() - _deflateStream.avail_out;
+                if((result != Z_OK && result != Z_BUF_ERROR) || _deflateStream.avail_out > 0) break;
+                compressed.resize(compressed.size() * 2);
+            }
+            if(!_contextTakeover) deflateReset(&_deflateStream);
+            if(result != Z_OK || _deflateStream.avail_in != 0 || compressedSize < 4 || (!_contextTakeover && compressedSize - 4 >= payload.size()))
+            {
+                //The data is not sent compressed, so it must not be referenced by the following messages.
+                if(_contextTakeover) deflateReset(&_deflateStream);
+                BaseLib::WebSocket::encode(payload, opcode, frame);
+                return;
+            }
+            //Remove the empty block "00 00 FF FF" at the end, as required by RFC 7692.
+            compressed.resize(compressedSize - 4);
+        }
+
+        _messages++;
+        _uncompressedBytes += payload.size();
+        _compressedBytes += compressed.size();
+
+        frame.reserve(compressed.size() + 10);
+        appendFrameHeader(frame, 0xC0 | ((uint8_t)opcode & 0x0F), compressed.size()); //FIN and RSV1
+        frame.insert(frame.end(), compressed.begin(), compressed.end());
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+bool WebSocketDeflate::decode(std::vector<char>& payload)
+{
+    try
+    {
+        payload.push_back((char)0);
+        payload.push_back((char)0);
+        payload.push_back((char)0xFF);
+        payload.push_back((char)0xFF);
+
+        std::vector<char> decompressed;
+        decompressed.resize(payload.size() * 4);
+        size_t decompressedSize = 0;
+
+        std::lock_guard<std::mutex> inflateGuard(_inflateMutex);
+        _inflateStream.next_in = (Bytef*)payload.data();
+        _inflateStream.avail_in = payload.size();
+        while(true)
+        {
+            _inflateStream.next_out = (Bytef*)decompressed.data() + decompressedSize;
+            _inflateStream.avail_out = decompressed.size() - decompressedSize;
+            int result = inflate(&_inflateStream, Z_SYNC_FLUSH);
+            decompressedSize = decompressed.size() - _inflateStream.avail_out;
+            if(result == Z_STREAM_END)
+            {
+                //The client finished the deflate stream. The next message starts a new one.
+                inflateReset(&_inflateStream);
+                break;
+            }
+            if(result != Z_OK && result != Z_BUF_ERROR) return false;
+            if(_inflateStream.avail_in == 0 && _inflateStream.avail_out > 0) break;
+            if(result == Z_BUF_ERROR && _inflateStream.avail_out > 0) return false;
+            if(decompressed.size() >= 104857600) return false;
+            decompressed.resize(decompressed.size() * 2);
+        }
+        decompressed.resize(decompressedSize);
+        payload = std::move(decompressed);
+        return true;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return false;
+}
+
+BaseLib::PVariable WebSocketDeflate::getMetrics()
+{
+    try
+    {
+        auto metrics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        uint64_t uncompressedBytes = _uncompressedBytes;
+        uint64_t compressedBytes = _compressedBytes;
+        metrics->structValue->emplace("webSocketCompressedMessages", std::make_shared<BaseLib::Variable>((int64_t)_messages.load()));
+        metrics->structValue->emplace("webSocketUncompressedBytes", std::make_shared<BaseLib::Variable>((int64_t)uncompressedBytes));
+        metrics->structValue->emplace("webSocketCompressedBytes", std::make_shared<BaseLib::Variable>((int64_t)compressedBytes));
+        metrics->structValue->emplace("webSocketCompressionRatio", std::make_shared<BaseLib::Variable>(uncompressedBytes > 0 ? (double)compressedBytes / uncompressedBytes : 1.0));
+        return metrics;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+}
+
+}
@@ -0,0 +1,111 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef WEBSOCKETDEFLATE_H_
+#define WEBSOCKETDEFLATE_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <zlib.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+/**
+ * Implements the WebSocket extension "permessage-deflate" (RFC 7692) for connections accepted by the RPC servers.
+ * Messages received from the client can always use context takeover. Messages sent by Homegear only use it, when the
+ * caller guarantees that they are written to the socket in the order they are encoded in. Otherwise
+ * "server_no_context_takeover" is negotiated. The class is thread safe.
+ */
+class WebSocketDeflate
+{
+public:
+    WebSocketDeflate(int32_t serverMaxWindowBits, bool contextTakeover);
+
+    virtual ~WebSocketDeflate();
+
+    /**
+     * Checks the extension offers of a WebSocket upgrade request.
+     *
+     * @param offers The value of the header "Sec-WebSocket-Extensions".
+     * @param orderedWrites Set to true, when all messages are written in the order encode() is called in.
+     * @param[out] response The value of the header "Sec-WebSocket-Extensions" to return to the client.
+     * @return The compression context of the connection or nullptr when no offer was accepted.
+     */
+    static std::shared_ptr<WebSocketDeflate> negotiate(const std::string& offers, bool orderedWrites, std::string& response);
+
+    /**
+     * Encodes a data frame. The payload is compressed unless it is too small to benefit from compression. The frame has
+     * to be sent before the next call when context takeover is used.
+     */
+    void encode(std::vector<char>& payload, BaseLib::WebSocket::Header::Opcode::Enum opcode, std::vector<char>& frame);
+
+    /**
+     * Decompresses the payload of a message with "RSV1" set in place.
+     *
+     * @return Returns false when the payload is invalid or exceeds 100 MiB when decompressed.
+     */
+    bool decode(std::vector<char>& payload);
+
+    static BaseLib::PVariable getMetrics();
+private:
+    /**
+     * Smaller payloads are sent uncompressed.
+     */
+    static const size_t _minCompressionSize = 64;
+
+    bool _contextTakeover = false;
+    std::mutex _deflateMutex;
+    z_stream _deflateStream;
+    bool _deflateInitialized = false;
+    std::mutex _inflateMutex;
+    z_stream _inflateStream;
+    bool _inflateInitialized = false;
+
+    static std::atomic<uint64_t> _messages;
+    static std::atomic<uint64_t> _uncompressedBytes;
+    static std::atomic<uint64_t> _compressedBytes;
+
+    static void appendFrameHeader(std::vector<char>& frame, uint8_t firstByte, size_t payloadSize);
+};
+
+}
+
+}
+
+#endif
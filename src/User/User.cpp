@@ -210,7 +210,12 @@ bool User::update(const std::string& userName, const std::string& password, cons
         std::vector<uint8_t> salt;
         std::vector<uint8_t> passwordHash = password.empty() ? std::vector<uint8_t>() : User::generateWHIRLPOOL(password, salt);
 
-        if(GD::bl->db->updateUser(userId, passwordHash, salt, groups)) return true;
+        if(GD::bl->db->updateUser(userId, passwordHash, salt, groups))
+        {
+            //Cached responses of the user might depend on the old groups.
+            if(!groups.empty()) GD::rpcResponseCache.invalidate();
+            return true;
+        }
     }
     catch(std::exception& ex)
     {
@@ -81,6 +81,7 @@ void exitHomegear(int exitCode)
 	if(GD::eventHandler) GD::eventHandler->dispose();
 	if(GD::familyController) GD::familyController->disposeDeviceFamilies();
     if(GD::bl->hgdc) GD::bl->hgdc->stop();
+	if(GD::variableHistory) GD::variableHistory->dispose();
 	if(GD::bl->db)
 	{
 		//Finish database operations before closing modules, otherwise SEGFAULT
@@ -126,6 +127,8 @@ void startRPCServers()
 		if(!GD::rpcServers[i]) GD::rpcServers[i] = std::make_shared<Rpc::RpcServer>();
 		GD::rpcServers[i]->start(settings);
 	}
+	if(!GD::multicallPool) GD::multicallPool.reset(new Rpc::MulticallPool());
+	GD::multicallPool->start();
 	if(GD::rpcServers.empty())
 	{
 		GD::out.printCritical("Critical: No RPC servers are running. Terminating Homegear.");
@@ -142,6 +145,7 @@ void stopRPCServers(bool dispose)
 		i->second->stop();
 		if(dispose) i->second->dispose();
 	}
+	if(GD::multicallPool) GD::multicallPool->stop();
 	GD::bl->rpcPort = 0;
 	//Don't clear map!!! Server is still accessed i. e. by the event handler!
 }
@@ -201,6 +205,8 @@ void terminateHomegear(int signalNumber)
             GD::out.printMessage("(Shutdown) => Disposing Homegear Daisy Chain client...");
             GD::bl->hgdc.reset();
         }
+        GD::out.printMessage("(Shutdown) => Disposing variable history");
+        if(GD::variableHistory) GD::variableHistory->dispose();
         GD::out.printMessage("(Shutdown) => Disposing database");
         if(GD::bl->db)
         {
@@ -269,6 +275,7 @@ void reloadHomegear()
             GD::out.printMessage("Reloading settings...");
             GD::bl->settings.load(GD::configPath + "main.conf", GD::executablePath);
             GD::clientSettings.load(GD::bl->settings.clientSettingsPath());
+            GD::rpcSettings.load(GD::configPath + "rpc.conf");
             GD::serverInfo.load(GD::bl->settings.serverSettingsPath());
             startRPCServers();
             GD::mqtt->loadSettings();
@@ -670,12 +677,22 @@ void startUp()
 		if(databasePath.empty()) databasePath = GD::bl->settings.dataPath();
 		std::string databaseBackupPath = GD::bl->settings.databaseBackupPath();
 		if(databaseBackupPath.empty()) databaseBackupPath = GD::bl->settings.dataPath();
+		int64_t databaseStartTime = BaseLib::HelperFunctions::getTime();
     	GD::bl->db->open(databasePath, "db.sql", GD::bl->settings.databaseSynchronous(), GD::bl->settings.databaseMemoryJournal(), GD::bl->settings.databaseWALJournal(), databaseBackupPath, "db.sql.bak");
     	if(!GD::bl->db->isOpen()) exitHomegear(1);
+		int64_t databaseOpenTime = BaseLib::HelperFunctions::getTime() - databaseStartTime;
 
         GD::out.printInfo("Initializing database...");
+		databaseStartTime = BaseLib::HelperFunctions::getTime();
         if(GD::bl->db->convertDatabase()) exitHomegear(0);
         GD::bl->db->initializeDatabase();
+		int64_t databaseInitTime = BaseLib::HelperFunctions::getTime() - databaseStartTime;
+
+		GD::variableHistory.reset(new VariableHistory());
+		{
+			auto databaseController = dynamic_cast<DatabaseController*>(GD::bl->db.get());
+			if(databaseController) GD::variableHistory->init(databaseController->getSettings(), databasePath);
+		}
 
         {
         	bool runningAsUser = !GD::runAsUser.empty() && !GD::runAsGroup.empty();
@@ -989,7 +1006,26 @@ void startUp()
 
         GD::out.printInfo("Loading devices...");
         if(BaseLib::Io::fileExists(GD::configPath + "physicalinterfaces.conf")) GD::out.printWarning("Warning: File physicalinterfaces.conf exists in config directory. Interface configuration has been moved to " + GD::bl->settings.familyConfigPath());
+        auto databaseController = dynamic_cast<DatabaseController*>(GD::bl->db.get());
+        int64_t loadStartTime = BaseLib::HelperFunctions::getTime();
+        if(databaseController)
+        {
+            //Read the data of all peers in one pass instead of querying every peer separately.
+            uint32_t peerCount = databaseController->bulkLoadPeerData();
+            GD::out.printInfo("Info: Startup timing: Bulk loading data of " + std::to_string(peerCount) + " peers took " + std::to_string(BaseLib::HelperFunctions::getTime() - loadStartTime) + "ms.");
+        }
         GD::familyController->load(); //Don't load before database is open!
+        if(databaseController) databaseController->clearBulkLoadedPeerData();
+        {
+            int64_t loadTime = BaseLib::HelperFunctions::getTime() - loadStartTime;
+            GD::out.printInfo("Info: Startup timing: Opening database took " + std::to_string(databaseOpenTime) + "ms, initializing database " + std::to_string(databaseInitTime) + "ms, loading devices " + std::to_string(loadTime) + "ms.");
+            if(databaseController)
+            {
+                auto metrics = databaseController->getMetrics();
+                GD::out.printInfo("Info: Startup timing: " + std::to_string(metrics->structValue->at("bulkLoadHits")->integerValue64) + " peer lookups were answered from bulk loaded data.");
+                GD::out.printInfo("Info: Startup timing: Loading devices read peer variables " + std::to_string(metrics->structValue->at("peerVariableReads")->integerValue64) + " times in " + std::to_string(metrics->structValue->at("peerVariableReadTime")->integerValue64 / 1000) + "ms and peer parameters " + std::to_string(metrics->structValue->at("peerParameterReads")->integerValue64) + " times in " + std::to_string(metrics->structValue->at("peerParameterReadTime")->integerValue64 / 1000) + "ms.");
+            }
+        }
 
         GD::out.printInfo("Initializing RPC client...");
         GD::rpcClient->init();
@@ -1385,6 +1421,11 @@ int main(int argc, char* argv[])
     			{
     				if(chmod(databasePath.c_str(), S_IRUSR | S_IWUSR | S_IRGRP) == -1) std::cerr << "Could not set permissions on " << databasePath << std::endl;
     			}
+    			databasePath += ".volatile";
+    			if(BaseLib::Io::fileExists(databasePath))
+    			{
+    				if(chmod(databasePath.c_str(), S_IRUSR | S_IWUSR | S_IRGRP) == -1) std::cerr << "Could not set permissions on " << databasePath << std::endl;
+    			}
 
     			currentPath = GD::bl->settings.scriptPath();
     			if(!BaseLib::Io::directoryExists(currentPath)) BaseLib::Io::createDirectory(currentPath, S_IRWXU | S_IRWXG);
@@ -1586,6 +1627,8 @@ int main(int argc, char* argv[])
 			GD::serverInfo.load(GD::bl->settings.serverSettingsPath());
 			GD::out.printInfo("Loading RPC client settings from " + GD::bl->settings.clientSettingsPath());
 			GD::clientSettings.load(GD::bl->settings.clientSettingsPath());
+			GD::out.printInfo("Loading RPC settings from " + GD::configPath + "rpc.conf");
+			GD::rpcSettings.load(GD::configPath + "rpc.conf");
 			GD::mqtt.reset(new Mqtt());
 			GD::mqtt->loadSettings();
 		// }}}